@@ -0,0 +1,63 @@
+#ifndef GRID_RENDER_H
+#define GRID_RENDER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "ipc/shared.h"
+
+/* Terminal grid display of CC, drawn by a separate thread.
+ *
+ *  - The tick loop only takes a snapshot (grid_render_snapshot, one pass
+ *    over the grid under SEM_GLOBAL_LOCK); formatting and printf happen in
+ *    the render thread, outside the lock.
+ *  - The thread keeps the last frame it printed and emits only the cells
+ *    that changed, placed with ANSI cursor positioning. Every keyframe_every
+ *    frames (and after the display was off) it clears the screen and prints
+ *    the full grid, which resynchronizes the terminal. The rows below the
+ *    grid are set as scroll region so other console output does not move it.
+ *  - Positioned frames are written to /dev/tty, and only while CC owns the
+ *    terminal: in the foreground with no UI on the [STD] FIFO. Otherwise
+ *    stdout (the tee: log, UI or terminal) gets the keyframes as plain text.
+ *  - keyframe_every == 1, or no controlling terminal, prints every frame in
+ *    full to stdout without cursor control, the plain scrolling output.
+ *  - If the thread is busy when a new snapshot arrives, the older snapshot
+ *    is skipped; the next delta is taken against what was actually printed.
+ */
+
+/* Snapshot of the grid in display order (row = y). cell codes:
+ *   0 empty, 1 obstacle, 2 + id * 4 + faction for a unit */
+typedef struct {
+    uint16_t cell[N][M];
+} grid_snap_t;
+
+/* screen row of grid row 0 in a keyframe (blank line, column header first) */
+#define GRID_ROW0 3
+/* upper bound on the bytes one frame (key or delta) can take */
+#define GRID_FRAME_MAX ((size_t)N * ((size_t)M * 24 + 32) + 256)
+
+/* Fill g from S->grid and S->units (caller holds SEM_GLOBAL_LOCK). */
+void grid_snap_take(grid_snap_t *g, const shm_state_t *S);
+
+/* Full frame of cur into out (cap >= GRID_FRAME_MAX). positioned != 0 adds
+ * the clear/home and scroll-region sequences. Returns the length. */
+size_t grid_render_key(const grid_snap_t *cur, int positioned, char *out, size_t cap);
+
+/* Cursor-positioned update turning the screen of prev into cur. Returns the
+ * length, 0 when nothing changed. */
+size_t grid_render_delta(const grid_snap_t *prev, const grid_snap_t *cur, char *out, size_t cap);
+
+/* Start the render thread. Returns 0 on success, -1 on error. */
+int grid_render_start(int keyframe_every);
+
+/* Tick loop: snapshot S for the render thread (caller holds SEM_GLOBAL_LOCK). */
+void grid_render_snapshot(const shm_state_t *S);
+
+/* Display turned off: reset the scroll region; the next frame is a keyframe. */
+void grid_render_pause(void);
+
+/* Print the pending snapshot, stop the thread, reset the terminal. Reports
+ * frames, keyframes and bytes written. */
+void grid_render_stop(uint64_t *frames, uint64_t *keyframes, uint64_t *bytes);
+
+#endif
@@ -0,0 +1,29 @@
+#ifndef METRICS_EXPORT_H
+#define METRICS_EXPORT_H
+
+#include <stdint.h>
+
+#include "ipc/ipc_context.h"
+
+/* Prometheus text exporter of the shm metrics registry (ipc/metrics.h), run by CC.
+ *
+ *  - file: rewritten atomically (tmp + rename) on every export, the layout
+ *    node_exporter's textfile collector expects.
+ *  - socket: a Unix-domain stream socket served by a small thread; every
+ *    connection gets the last export as an HTTP/1.0 response, so
+ *    `curl --unix-socket <path> http://localhost/metrics` works.
+ *  - Either may be NULL. Rates (ticks, spawns, damage per second) are taken
+ *    over the interval since the previous export.
+ */
+
+/* Returns 0 on success, -1 if neither output could be opened (errno set). */
+int metrics_export_open(const char *file_path, const char *sock_path);
+
+/* Render the registry plus queue depths (msgctl IPC_STAT) and publish it
+ * to the file and/or socket. tick is exported as skirmish_tick. */
+void metrics_export(ipc_ctx_t *ctx, uint32_t tick);
+
+/* Stop the socket thread, remove the socket. The file is kept. */
+void metrics_export_close(void);
+
+#endif
@@ -0,0 +1,30 @@
+#ifndef RECORDER_H
+#define RECORDER_H
+
+#include <stdint.h>
+
+#include "ipc/shared.h"
+
+/* Battle recorder of CC (--record), format in ipc/recording.h.
+ *
+ *  - recorder_capture() copies the tick's state into a queue slot (caller
+ *    holds SEM_GLOBAL_LOCK); a writer thread encodes it as a keyframe or a
+ *    delta and writes it through a buffered FILE, outside the lock.
+ *  - The queue is never lossy: if the writer falls RECORDER_QUEUE ticks
+ *    behind, capture waits for a free slot (counted as stalls).
+ */
+
+#define RECORDER_QUEUE 32
+
+/* Create path and start the writer. key_every: ticks between keyframes.
+ * Returns 0 on success, -1 on error (errno set). */
+int recorder_open(const char *path, const char *scenario, uint64_t seed, int key_every);
+
+/* Queue the state of the tick that just ended plus the hits it resolved. */
+void recorder_capture(const shm_state_t *S, const combat_hit_t *hits, int n_hits);
+
+/* Drain the queue, stop the writer, close the file. Reports ticks recorded,
+ * bytes written and captures that had to wait for the writer. */
+void recorder_close(uint64_t *ticks, uint64_t *bytes, uint64_t *stalls);
+
+#endif
@@ -29,6 +29,7 @@ typedef struct {
 
 typedef struct {
     char name[MAX_SCENARIO_NAME];
+    uint64_t seed;      /* RNG seed (0 = pick one at startup) */
     
     /* Map settings */
     int map_width;
@@ -0,0 +1,62 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "ipc/shared.h"
+
+/* World snapshots: CM "snapshot <file>" writes one, CC --restore <file>
+ * starts from it.
+ *
+ *  - File = one SNAPSHOT_HEADER_SIZE header page, then the raw shm_state_t
+ *    image, page aligned: a reader mmaps the file and uses the image in place.
+ *  - The image includes each unit's private state (S->priv, saved by the
+ *    unit at the end of its tick). RNG streams are keyed by (rng_seed, unit,
+ *    tick), so the seed and tick counter in the image are the RNG state.
+ *  - CC writes it at the top of the tick loop, holding SEM_GLOBAL_LOCK while
+ *    every unit waits for its start permit, so the image is one tick boundary.
+ *  - Restore copies only the world parts (counters, grid, units, orders,
+ *    telemetry, private states) out of the mapping; profiling, traces,
+ *    metrics, the console ring and the UI frame start empty. Messages still
+ *    queued when the snapshot was taken are not part of it: a carrier whose
+ *    spawn request was pending simply asks again.
+ */
+
+#define SNAPSHOT_MAGIC "SKSNAP1"
+#define SNAPSHOT_HEADER_SIZE 4096
+
+typedef struct {
+    char magic[8];              // SNAPSHOT_MAGIC
+    uint64_t state_size;        // sizeof(shm_state_t) of the writer
+    uint32_t m, n, max_units;   // grid and unit limits of the writer
+    uint32_t tick;
+    uint64_t seed;
+    uint16_t unit_count;
+    char scenario[64];
+} snapshot_header_t;
+
+/* A mapped snapshot file */
+typedef struct {
+    void *map;
+    size_t len;
+    const snapshot_header_t *h;
+    const shm_state_t *S;       // image inside the mapping
+} snapshot_t;
+
+/* Write S to path (path.tmp, then rename). Caller holds SEM_GLOBAL_LOCK.
+ * Returns the file size, or -1 on error (errno set). */
+int64_t snapshot_write(const shm_state_t *S, const char *scenario, const char *path);
+
+/* mmap path read-only and check it was written by this build.
+ * Returns 0, or -1 (errno = EINVAL for a foreign or truncated file). */
+int snapshot_map(const char *path, snapshot_t *out);
+
+void snapshot_unmap(snapshot_t *snap);
+
+/* Copy the world parts of the image into S (fresh segment, no units
+ * running). Pids of the image are cleared; CC sets them when it respawns
+ * the alive units. */
+void snapshot_restore(shm_state_t *S, const snapshot_t *snap);
+
+#endif
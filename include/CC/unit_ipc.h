@@ -46,7 +46,8 @@ Returns the closest cell of the target unit to the attacker.
 point_t get_target_position(ipc_ctx_t *ctx, unit_id_t attacker_id, unit_id_t target_id);
 
 /*
-adds damage to damage payload of trgeted unit
+adds damage to damage payload of trgeted unit (shm, consumed by target next tick)
+Protected by SEM_GLOBAL_LOCK by caller.
     args:
         -ctx (ipc_ctx_t*) -> --//--
         -target_id (unit_id_t) -> id of unit to which demage is added
@@ -58,6 +59,7 @@ void unit_add_to_dmg_payload(ipc_ctx_t *ctx, unit_id_t target_id, st_points_t dm
 
 /*
 caculating demage recived and updating unit stats
+reads and clears net damage resolved by CC in previous tick
     args:
         -ctx (ipc_ctx_t*) -> --//--
         -unit_id (unit_id_t) -> unit_id for demage computation 
@@ -68,8 +70,114 @@ caculating demage recived and updating unit stats
 void compute_dmg_payload(ipc_ctx_t *ctx, unit_id_t unit_id, unit_stats_t *st);
 
 /*
-setting weapons targets and
-calculating amount of demage given to target
+writes order for underling into its shm order slot, only if it changed
+(order, target or commander); bumps slot seq on change.
+Protected by SEM_GLOBAL_LOCK by caller.
+    args:
+        -ctx (ipc_ctx_t*) -> --//--
+        -commander_id (unit_id_t) -> id of commanding unit
+        -underling_id (unit_id_t) -> id of unit receiving order
+        -order (unit_order_t) -> order
+        -target_id (unit_id_t) -> target of order
+    return (int):
+        1 if slot was written, 0 if order was unchanged
+*/
+int unit_publish_order(ipc_ctx_t *ctx, unit_id_t commander_id, unit_id_t underling_id,
+    unit_order_t order, unit_id_t target_id);
+
+/*
+checks unit's order slot for an order newer than seen_seq from commander_id
+Protected by SEM_GLOBAL_LOCK by caller.
+    args:
+        -ctx (ipc_ctx_t*) -> --//--
+        -unit_id (unit_id_t) -> id of unit polling
+        -commander_id (unit_id_t) -> current commander (orders of others are ignored)
+        -seen_seq (uint32_t*) -> seq of last applied order, updated on new order
+        -out (order_slot_t*) -> new order
+    return (int):
+        1 if new order is in out, 0 otherwise
+*/
+int unit_poll_order(ipc_ctx_t *ctx, unit_id_t unit_id, unit_id_t commander_id,
+    uint32_t *seen_seq, order_slot_t *out);
+
+/*
+publishes unit telemetry (hp, shields and their max, order, target, last fired tick)
+into its shm telemetry record, read by UI. Once per tick, by the unit itself.
+Own seqlock per record: no SEM_GLOBAL_LOCK needed.
+    args:
+        -ctx (ipc_ctx_t*) -> --//--
+        -unit_id (unit_id_t) -> id of publishing unit
+        -type (unit_type_t) -> type of unit (max hp/shields)
+        -tick (uint32_t) -> current tick
+        -st (unit_stats_t*) -> current statistics of unit
+        -order (unit_order_t) -> order unit is executing
+        -target (unit_id_t) -> current secondary target (0 if none)
+        -last_fired_tick (uint32_t) -> last tick unit posted fire intent (0 if never)
+    return (void):
+        None
+*/
+void unit_publish_telemetry(ipc_ctx_t *ctx, unit_id_t unit_id, unit_type_t type, uint32_t tick,
+    const unit_stats_t *st, unit_order_t order, unit_id_t target, uint32_t last_fired_tick);
+
+/*
+copies the unit's private state into its shm slot S->priv[unit_id] (end of
+the unit's tick, before SEM_TICK_DONE), so a world snapshot taken between
+ticks holds it. Only the unit writes its slot: no SEM_GLOBAL_LOCK needed.
+    args:
+        -ctx (ipc_ctx_t*) -> --//--
+        -unit_id (unit_id_t) -> id of unit
+        -tick (uint32_t) -> current tick (stored in p->tick)
+        -p (unit_private_t*) -> private state of unit
+    return (void):
+        None
+*/
+void unit_save_private(ipc_ctx_t *ctx, unit_id_t unit_id, uint32_t tick, unit_private_t *p);
+
+/*
+reads the private state restored from a snapshot (unit started with --restore)
+    args:
+        -ctx (ipc_ctx_t*) -> --//--
+        -unit_id (unit_id_t) -> id of unit
+        -out (unit_private_t*) -> private state of unit
+    return (int):
+        1 if the slot holds a saved state, 0 if the unit never saved one
+        (spawned right before the snapshot: start fresh)
+*/
+int unit_load_private(ipc_ctx_t *ctx, unit_id_t unit_id, unit_private_t *out);
+
+/*
+posts fire intent (attacker, weapon slot, target) into per-tick shm table
+Protected by SEM_GLOBAL_LOCK by caller.
+    args:
+        -ctx (ipc_ctx_t*) -> --//--
+        -unit_id (unit_id_t) -> id of unit atacking
+        -weapon (uint8_t) -> index of weapon in attacker loadout
+        -target_id (unit_id_t) -> id of targeted unit
+    return (int):
+        0 on success, -1 if table is full (shot dropped)
+*/
+int unit_post_fire_intent(ipc_ctx_t *ctx, unit_id_t unit_id, uint8_t weapon, unit_id_t target_id);
+
+/*
+CC combat phase: resolves all fire intents of the tick in one pass
+(accuracy roll, damage multiplier, accumulation into per-target dmg_payload)
+and clears the intent table.
+Hit rolls use stream (seed, attacker, tick) at counter == weapon slot,
+so the outcome does not depend on the order intents were posted in.
+Protected by SEM_GLOBAL_LOCK by caller.
+    args:
+        -ctx (ipc_ctx_t*) -> --//--
+        -out (combat_hit_t*) -> if not NULL, the first cap hits (attacker,
+                                target, damage), e.g. for the battle recording
+        -cap (int) -> size of out
+    return (int):
+        number of hits
+*/
+int resolve_fire_intents(ipc_ctx_t *ctx, combat_hit_t *out, int cap);
+
+/*
+setting weapons targets and posting fire intents for them
+(damage is resolved later by CC, see resolve_fire_intents)
     args:
         -ctx (ipc_ctx_t*) -> --//--
         -unit_id (unit_id_t) -> id of unit atacking
@@ -77,17 +185,15 @@ calculating amount of demage given to target
         -target_sec (unit_id_t) -> id of target that is attcked
         -count (int) -> number of detected units in detect_id array
         -detect_id (unit_id_t*) -> array of detected enemy ids
-        -out_dmg (st_points_t*) -> output array for dmg per weapon
-    return (st_points_t):
-        sum of calculated damage for this shot (currently always 0 in implementation)
+    return (int):
+        number of posted fire intents
 */
-st_points_t unit_weapon_shoot(ipc_ctx_t *ctx,
+int unit_weapon_shoot(ipc_ctx_t *ctx,
     unit_id_t unit_id,
     unit_stats_t *st,
     unit_id_t target_sec,
     int count,
-    unit_id_t *detect_id,
-    st_points_t *out_dmg
+    unit_id_t *detect_id
 );
 
 /*
@@ -116,7 +222,8 @@ unit_id_t unit_chose_secondary_target(ipc_ctx_t *ctx,
 int8_t unit_chose_patrol_point(ipc_ctx_t *ctx,
     unit_id_t unit_id,
     point_t *target_pri,
-    unit_stats_t st
+    unit_stats_t st,
+    rng_t *rng
 );
 
 /*
@@ -3,6 +3,7 @@
 
 #include "ipc/shared.h"
 #include "ipc/ipc_context.h"
+#include "CC/unit_rng.h"
 
 /*
 calculates damage multiplier based on attacker type and target type
@@ -24,6 +25,40 @@ calculates accuracy multiplier based on weapon type and target type
 */
 float accuracy_multiplier(weapon_type_t weapon, unit_type_t target);
 
+/*
+gathers target types of detected units into a flat array (input for batch scoring)
+    args:
+        -units (const unit_entity_t*) -> units array (shm snapshot)
+        -ids (const unit_id_t*) -> detected unit ids
+        -count (int) -> number of ids
+        -out_types (uint8_t*) -> output types (unknown types clamped to DUMMY)
+    return (int):
+        number of written types (== count)
+*/
+int unit_gather_types(const unit_entity_t *units, const unit_id_t *ids, int count, uint8_t *out_types);
+
+/*
+batch version of damage_multiplier: scores whole detected list in one pass
+    args:
+        -unit (unit_type_t) -> attacker type
+        -t_types (const uint8_t*) -> target types (from unit_gather_types)
+        -count (int) -> number of targets
+        -out (float*) -> output multipliers
+    return (void)
+*/
+void damage_multiplier_batch(unit_type_t unit, const uint8_t *t_types, int count, float *out);
+
+/*
+batch version of accuracy_multiplier: scores whole detected list in one pass
+    args:
+        -weapon (weapon_type_t) -> weapon type
+        -t_types (const uint8_t*) -> target types (from unit_gather_types)
+        -count (int) -> number of targets
+        -out (float*) -> output accuracies (0..1)
+    return (void)
+*/
+void accuracy_multiplier_batch(weapon_type_t weapon, const uint8_t *t_types, int count, float *out);
+
 /*
 calculates final damage dealt to target, including hit roll and type multipliers
     args:
@@ -31,10 +66,11 @@ calculates final damage dealt to target, including hit roll and type multipliers
         -target (unit_entity_t*) -> target unit entity
         -weapon (weapon_stats_t*) -> used weapon stats
         -accuracy (float) -> hit chance (0..1)
+        -rng (rng_t*) -> random stream used for hit roll
     return (st_points_t):
         dealt damage (0 if miss)
 */
-st_points_t damage_to_target(unit_entity_t *attacker, unit_entity_t *target, weapon_stats_t *weapon, float accuracy);
+st_points_t damage_to_target(unit_entity_t *attacker, unit_entity_t *target, weapon_stats_t *weapon, float accuracy, rng_t *rng);
 
 /* -----------------------------
  * Random radar helpers
@@ -59,6 +95,7 @@ picks random point inside a circle (disk) on the grid
         -cx, cy (int16_t) -> center of disk
         -r (int16_t) -> radius
         -grid_w, grid_h (int) -> grid bounds
+        -rng (rng_t*) -> random stream
         -out (point_t*) -> output chosen point
     return (int):
         1 if point chosen, 0 if none exists / invalid params
@@ -67,6 +104,7 @@ picks random point inside a circle (disk) on the grid
 int radar_pick_random_point_in_circle(
     int16_t cx, int16_t cy, int16_t r,
     int grid_w, int grid_h,
+    rng_t *rng,
     point_t *out
 );
 
@@ -77,6 +115,7 @@ picks random point on discrete circle border (ring) on the grid
         -pos (point_t) -> center position
         -r (int16_t) -> radius
         -grid_w, grid_h (int) -> grid bounds
+        -rng (rng_t*) -> random stream
         -out (point_t*) -> output chosen point
     return (int):
         1 if point chosen, 0 if none exists / invalid params
@@ -88,6 +127,7 @@ int radar_pick_random_point_on_circle_border(
     int8_t unit_size,
     unit_id_t moving_unit_id,
     ipc_ctx_t *ctx,
+    rng_t *rng,
     point_t *out
 );
 
@@ -124,6 +164,7 @@ chooses patrol target near position (inside dr radius)
         -pos (point_t) -> current position
         -dr (int16_t) -> patrol radius
         -grid_w, grid_h (int) -> grid bounds
+        -rng (rng_t*) -> random stream
         -out_target (point_t*) -> output patrol target
     return (int):
         1 if selected, 0 otherwise
@@ -132,6 +173,7 @@ int unit_pick_patrol_target_local(
     point_t pos,
     int16_t dr,
     int grid_w, int grid_h,
+    rng_t *rng,
     point_t *out_target
 );
 
@@ -247,6 +289,15 @@ calculates approach distance for chase/attack based on weapon loadout and target
 */
 int16_t unit_calculate_aproach(weapon_loadout_view_t ba, unit_type_t t_type);
 
+/*
+precomputes approach distance for every target type (loadout does not change at runtime)
+    args:
+        -ba (weapon_loadout_view_t) -> loadout
+        -out (int16_t[UNIT_TYPE_COUNT]) -> approach distance indexed by target type
+    return (void)
+*/
+void unit_build_aproach_table(weapon_loadout_view_t ba, int16_t out[UNIT_TYPE_COUNT]);
+
 
 /* -----------------------------
  * Targeting
@@ -0,0 +1,77 @@
+#pragma once
+#include <stdint.h>
+
+#include "ipc/shared.h"
+
+/* Counter-based RNG streams.
+ *
+ * Every draw is a pure function of (key, counter): the key is derived from
+ * (scenario seed, unit id, tick) and the counter advances per draw. Two runs
+ * with the same seed produce the same sequence in every unit, independent of
+ * process scheduling, and there is no hidden global state to contend on.
+ *
+ * The mixing function is the SplitMix64 finalizer applied to key + ctr*gamma,
+ * so a block of draws has no loop-carried dependency (see rng_fill_float01).
+ */
+
+typedef struct {
+    uint64_t key;   // stream key (seed, unit id, tick)
+    uint64_t ctr;   // next draw index
+} rng_t;
+
+#define RNG_GAMMA 0x9E3779B97F4A7C15ull
+
+/* stream domains: keep CC-side draws disjoint from unit-side draws */
+#define RNG_DOMAIN_UNIT     0x554E4954ull  /* 'UNIT' */
+#define RNG_DOMAIN_COMBAT   0x434F4D42ull  /* 'COMB' */
+#define RNG_DOMAIN_SCENARIO 0x5343454Eull  /* 'SCEN' */
+
+static inline uint64_t rng_mix64(uint64_t z) {
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+/*
+derives stream for (seed, domain, id, tick) and resets its counter
+    args:
+        -r (rng_t*) -> stream to initialize
+        -seed (uint64_t) -> scenario seed
+        -domain (uint64_t) -> RNG_DOMAIN_*
+        -id (uint32_t) -> unit id (or attacker id for combat)
+        -tick (uint32_t) -> simulation tick
+    return (void)
+*/
+static inline void rng_seed(rng_t *r, uint64_t seed, uint64_t domain, uint32_t id, uint32_t tick) {
+    uint64_t k = rng_mix64(seed ^ rng_mix64(domain));
+    k = rng_mix64(k ^ (((uint64_t)id << 32) | tick));
+    r->key = k;
+    r->ctr = 0;
+}
+
+static inline uint64_t rng_at(uint64_t key, uint64_t ctr) {
+    return rng_mix64(key + ctr * RNG_GAMMA);
+}
+
+static inline uint32_t rng_next_u32(rng_t *r) {
+    return (uint32_t)(rng_at(r->key, r->ctr++) >> 32);
+}
+
+/* uniform float in [0, 1) with 24 bits of precision */
+static inline float rng_float01(rng_t *r) {
+    return (float)(rng_next_u32(r) >> 8) * (1.0f / 16777216.0f);
+}
+
+/* uniform integer in [0, n) (multiply-shift, no modulo bias worth noting for small n) */
+static inline uint32_t rng_below(rng_t *r, uint32_t n) {
+    return (uint32_t)(((uint64_t)rng_next_u32(r) * n) >> 32);
+}
+
+/* fills out[0..n) with the next n float draws; iterations are independent */
+static inline void rng_fill_float01(rng_t *r, float *out, int n) {
+    const uint64_t key = r->key;
+    const uint64_t base = r->ctr;
+    for (int i = 0; i < n; i++)
+        out[i] = (float)((uint32_t)(rng_at(key, base + (uint64_t)i) >> 32) >> 8) * (1.0f / 16777216.0f);
+    r->ctr += (uint64_t)n;
+}
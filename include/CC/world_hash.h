@@ -0,0 +1,67 @@
+#ifndef WORLD_HASH_H
+#define WORLD_HASH_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "ipc/shared.h"
+
+/* XXH64 of a buffer (reference algorithm, little-endian reads) */
+uint64_t xxh64(const void *data, size_t len, uint64_t seed);
+
+/* Packed per-unit record that enters the hash (no padding, no pid). */
+typedef struct __attribute__((packed)) {
+    uint8_t faction;
+    uint8_t type;
+    uint8_t alive;
+    int16_t x;
+    int16_t y;
+    int32_t dmg_payload;
+    int32_t hp;
+} unit_hash_rec_t;
+
+/* Incremental world hash kept privately by CC.
+ *
+ * The world hash is the sum (mod 2^64) of independent part hashes:
+ *  - one per grid column x (XXH64 of grid[x], seeded by x), recomputed only
+ *    when shm grid_dirty[x] was raised by place/remove_unit_from_grid,
+ *  - one per unit record, recomputed only when the packed record changed,
+ *  - the tick counter.
+ * A changed part is swapped out of the sum, so cost is O(changed parts).
+ */
+typedef struct {
+    uint64_t sum;                               // sum of column + unit part hashes
+    uint64_t col_hash[M];
+    uint64_t unit_hash[MAX_UNITS + 1];
+    unit_hash_rec_t unit_rec[MAX_UNITS + 1];
+    uint32_t cols_rehashed;                     // stats of last update
+    uint32_t units_rehashed;
+} world_hash_t;
+
+/* Full recompute of all parts; clears grid_dirty. Caller holds SEM_GLOBAL_LOCK. */
+void world_hash_init(world_hash_t *wh, shm_state_t *S);
+
+/* Incremental update from dirty flags; clears grid_dirty and returns the
+ * world hash for the current tick. Caller holds SEM_GLOBAL_LOCK. */
+uint64_t world_hash_update(world_hash_t *wh, shm_state_t *S);
+
+/* Reference (non-incremental) hash; equals world_hash_update on the same state. */
+uint64_t world_hash_full(const shm_state_t *S);
+
+
+/* Binary hash log (<run_dir>/state_hash.bin):
+ *   hash_log_header_t, then one hash_log_rec_t per tick (little-endian).
+ * Compare two logs with skirmish-hashdiff. */
+#define HASH_LOG_MAGIC "SKHASH01"
+
+typedef struct __attribute__((packed)) {
+    char magic[8];
+    uint64_t seed;
+} hash_log_header_t;
+
+typedef struct __attribute__((packed)) {
+    uint32_t tick;
+    uint64_t hash;
+} hash_log_rec_t;
+
+#endif
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <signal.h>
+#include <stdint.h>
 #include <ncurses.h>
 #include <pthread.h>
 #include "ipc/ipc_context.h"
@@ -8,7 +9,8 @@
 /* UI window layout:
  * +----------------+----------------+
  * |   MAP (TL)     |   UST (TR)     |
- * |                |                |
+ * |                +----------------+
+ * |                |   PRF (R)      |
  * +----------------+----------------+
  * |        STD (Bottom - Full)      |
  * +------------------------------------+
@@ -18,10 +20,12 @@ typedef struct {
     /* ncurses windows */
     WINDOW *map_win;    // Top-left: grid map display
     WINDOW *ust_win;    // Top-right: unit stats table
+    WINDOW *prf_win;    // Right, below UST: tick phase timing
     WINDOW *std_win;    // Bottom: standard output log (full width)
     
-    /* IPC context */
+    /* IPC context (private state, not attached, when replaying) */
     ipc_ctx_t *ctx;
+    struct ui_replay *replay;       // --replay player, NULL for a live run
     
     /* Communication FIFOs */
     char run_dir[512];
@@ -33,9 +37,18 @@ typedef struct {
     pthread_mutex_t ui_lock;
     volatile sig_atomic_t stop;
     
+    /* Frame pacing (see ui_pacer_wait) */
+    int max_fps;                    // upper bound on renders per second per thread (0 = unlimited)
+    volatile uint32_t redraw_gen;   // bumped by main thread after terminal resize or view change
+    
+    /* MAP viewport (keys handled by ui_map_handle_key, clamped by MAP thread) */
+    volatile int view_level;        // 0 = 1:1, L = one char per 2^L x 2^L cells (mipmap level)
+    volatile int view_x, view_y;    // top-left corner, in grid cells
+    
     /* Thread IDs */
     pthread_t map_thread_id;
     pthread_t ust_thread_id;
+    pthread_t prf_thread_id;
     pthread_t ucm_thread_id;
     pthread_t std_thread_id;
 } ui_context_t;
@@ -49,6 +62,22 @@ void ui_cleanup(ui_context_t *ui_ctx);
 /* Refresh all windows */
 void ui_refresh_all(ui_context_t *ui_ctx);
 
+/* Per-thread render pacing state */
+typedef struct {
+    uint32_t epoch;         // tick epoch of last render
+    uint32_t redraw_gen;    // redraw generation of last render
+    uint64_t last_ns;       // CLOCK_MONOTONIC time of last render
+    uint32_t renders;       // number of renders (for shutdown log)
+} ui_pacer_t;
+
+/* Start pacing from the current tick epoch; first ui_pacer_wait renders at once. */
+void ui_pacer_init(ui_context_t *ui_ctx, ui_pacer_t *p);
+
+/* Block until the thread should render: the tick advanced (futex on
+ * S->tick_epoch), the terminal was resized or the view changed, at most max_fps times per second.
+ * Returns 1 to render, 0 when stop is set (also set when CC removed the IPC objects). */
+int ui_pacer_wait(ui_context_t *ui_ctx, ui_pacer_t *p);
+
 /* Thread entry points */
 void *ui_std_thread(void *arg);
 
@@ -4,3 +4,8 @@
 
 /* MAP thread - displays grid in top-left window */
 void* ui_map_thread(void* arg);
+
+/* Viewport keys (main thread): '+'/'-' zoom in/out one mipmap level,
+ * arrows pan by a quarter of the window, 'f' fits the whole map.
+ * Returns 1 if the key was handled (and a redraw requested), 0 otherwise. */
+int ui_map_handle_key(ui_context_t *ui_ctx, int ch);
@@ -0,0 +1,9 @@
+#ifndef UI_PRF_H
+#define UI_PRF_H
+
+#include "UI/ui.h"
+
+/* PRF thread - displays tick phase timing (S->prof_summary) below UST */
+void* ui_prf_thread(void* arg);
+
+#endif
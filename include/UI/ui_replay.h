@@ -0,0 +1,31 @@
+#ifndef UI_REPLAY_H
+#define UI_REPLAY_H
+
+#include "UI/ui.h"
+
+/* Replay of a battle recording (ui --replay file, format in ipc/recording.h).
+ *
+ *  - No IPC: the player decodes the file into a private shm_state_t and
+ *    publishes each tick with ui_frame_publish(), so the MAP/UST threads
+ *    render it exactly like a live run. Hits, spawns and deaths are written
+ *    to the OUTPUT window instead of the tee FIFO.
+ *  - Seeking jumps to the last keyframe at or before the target tick and
+ *    applies the deltas from there.
+ */
+
+typedef struct ui_replay ui_replay_t;
+
+/* mmap and index path. Returns NULL on error (message on stderr). */
+ui_replay_t *ui_replay_open(const char *path, double ticks_per_s);
+
+void ui_replay_close(ui_replay_t *rp);
+
+/* Player thread: arg is the ui_context_t (ui_ctx->replay set) */
+void *ui_replay_thread(void *arg);
+
+/* Playback keys (main thread): space pause/resume, ']' / '[' faster/slower,
+ * '.' one tick forward, '>' / '<' seek 100 ticks, '0'..'9' seek to that
+ * tenth of the recording. Returns 1 if the key was handled. */
+int ui_replay_handle_key(ui_context_t *ui_ctx, int ch);
+
+#endif
@@ -0,0 +1,43 @@
+#ifndef IPC_CONSOLE_RING_H
+#define IPC_CONSOLE_RING_H
+
+#include "ipc/shared.h"
+
+/*
+ * Lossy console path: stdout/stderr -> S->console -> forwarder -> terminal tee.
+ *
+ *  - console_ring_redirect() replaces stdout and stderr of the calling process
+ *    with streams that copy every flushed buffer into the ring (split into
+ *    CONSOLE_SLOT_BYTES slots, reserved with one fetch_add so a flush stays
+ *    contiguous). printf/fflush never block on the tee pipe.
+ *  - The forwarder (a detached process started by CC) copies complete slots
+ *    in order to the tee pipe. When it falls CONSOLE_SLOTS behind, producers
+ *    overwrite the oldest slots; the forwarder skips them and counts them in
+ *    S->console.dropped (exported as MET_CONSOLE_DROPPED).
+ *  - ipc_detach() restores the original streams.
+ */
+
+/* console_ring_redirect
+ *  - Route stdout/stderr through S->console if CC enabled it.
+ *  - Returns 0 when redirected, -1 if the ring is off or fopencookie failed.
+ */
+int console_ring_redirect(shm_state_t *S);
+
+/* console_ring_restore
+ *  - Flush and give back the original stdout/stderr (no-op if not redirected).
+ */
+void console_ring_restore(void);
+
+/* console_forwarder_start
+ *  - CC: start the forwarder as a detached process writing to out_fd (the
+ *    terminal tee pipe). Returns 0 on success, -1 on error (errno set).
+ */
+int console_forwarder_start(shm_state_t *S, int out_fd);
+
+/* console_forwarder_stop
+ *  - CC: ask the forwarder to drain the ring and exit, wait up to timeout_ms.
+ *  - Returns 0 if it finished, -1 on timeout.
+ */
+int console_forwarder_stop(shm_state_t *S, int timeout_ms);
+
+#endif
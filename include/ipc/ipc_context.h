@@ -3,6 +3,7 @@
 
 #include <sys/types.h>
 #include "ipc/shared.h"
+#include "ipc/shm_backend.h"
 
 /* SysV semctl(2) requires this union on some platforms. */
 union semun {
@@ -11,8 +12,18 @@ union semun {
     unsigned short *array;
 };
 
+/* Backend of the world segment (semaphores and queues are always SysV). */
+typedef enum {
+    IPC_SHM_SYSV = 0,   /* shmget segment keyed by ftok (default) */
+    IPC_SHM_POSIX       /* file in /dev/shm or on hugetlbfs (ipc/shm_backend.h) */
+} ipc_shm_backend_t;
+
 /* IPC runtime context carried by processes using the shared world.
- * - shm_id / sem_id: SysV ids for the shared memory and semaphore set.
+ * - shm_id / sem_id: SysV ids for the shared memory and semaphore set
+ *   (shm_id is -1 with the POSIX backend).
+ * - shm_backend / shm: which backend holds S; shm describes the POSIX mapping.
+ * - q_*: one SysV message queue per message class (mq_class_t), so a flooded
+ *   class cannot fill the byte limit of another or slow its msgrcv filters.
  * - S: pointer to the attached shm_state_t (or (void*)-1 if not attached).
  * - owner: 1 if this process created the IPC objects (Command Center), 0 otherwise.
  * - ftok_path: path used with ftok(3) to derive keys.
@@ -20,9 +31,12 @@ union semun {
 typedef struct {
     int shm_id;
     int sem_id;
-    int q_req;
-    int q_rep;
+    int q_spawn;    /* MQ_SPAWN */
+    int q_cmd;      /* MQ_CMD */
+    int q_rep;      /* MQ_REP */
     shm_state_t *S;
+    int shm_backend;    /* ipc_shm_backend_t */
+    shm_posix_t shm;    /* IPC_SHM_POSIX: mapping, page kind and file */
     int owner;      /* 1 if created by CC */
     char ftok_path[256];
 } ipc_ctx_t;
@@ -34,6 +48,11 @@ typedef struct {
  */
 int ipc_create(ipc_ctx_t *ctx, const char *ftok_path);
 
+/* Backend ipc_create uses for the world segment (call before it; default
+ * SysV). huge asks for huge pages (POSIX only, see ipc/shm_backend.h).
+ * ipc_attach finds the segment of either backend by itself. */
+void ipc_set_shm_backend(ipc_shm_backend_t backend, int huge);
+
 /* Attach to existing IPC objects created by ipc_create.
  * - Returns 0 on success; on failure errno is set.
  */
@@ -44,6 +63,9 @@ int ipc_attach(ipc_ctx_t *ctx, const char *ftok_path);
  */
 int ipc_detach(ipc_ctx_t *ctx);
 
+/* Short name of a message queue class ("spawn", "dmg", ...), for reports. */
+const char *ipc_queue_name(int cls);
+
 /* Remove IPC objects (shared memory + semaphores).
  * - Only the owner/CC should call this when cleaning up.
  */
@@ -0,0 +1,85 @@
+#ifndef IPC_LOCKSTAT_H
+#define IPC_LOCKSTAT_H
+
+#include <stdint.h>
+#include "ipc/shared.h"
+
+/*
+ * Lock contention profiler (CC --lockstat -> skirmish-lockstat).
+ *
+ *  - The semaphore wrappers (semaphores.c) time every wait on SEM_GLOBAL_LOCK
+ *    and on the tick barrier semaphores, and how long SEM_GLOBAL_LOCK is held
+ *    until sem_unlock, once the process has called lockstat_bind().
+ *  - Each process writes only its own slot of S->lockstat (unit id, 0 for CC).
+ *  - Without --lockstat lockstat_bind() is a no-op and the wrappers pay one
+ *    branch per call.
+ *  - CC writes the whole table to <run_dir>/lockstat.bin at shutdown;
+ *    skirmish-lockstat reads that file or the live segment.
+ */
+
+#define LOCKSTAT_DUMP_MAGIC "SKLOCK1"
+
+/* <run_dir>/lockstat.bin: header followed by lockstat_slot_t[slots] */
+typedef struct {
+    char magic[8];          // LOCKSTAT_DUMP_MAGIC
+    uint32_t ticks;         // S->ticks at dump time
+    uint32_t slots;         // MAX_UNITS + 1
+    uint32_t buckets;       // LOCKSTAT_BUCKETS
+    uint32_t locks;         // LOCKSTAT_LOCKS
+} lockstat_dump_header_t;
+
+/* lockstat_bind
+ *  - Record this process' semaphore waits of set semid in S->lockstat.slot[slot]
+ *    under role ("CC", "BS", "SQ"). The slot is cleared when its role changes
+ *    (unit id reused by another unit type).
+ *  - No-op unless CC enabled the profiler (S->lockstat.enabled).
+ */
+void lockstat_bind(shm_state_t *S, int semid, unit_id_t slot, const char *role);
+
+/* lockstat_unbind
+ *  - Stop recording (before the shm segment is detached).
+ */
+void lockstat_unbind(void);
+
+/* lockstat_dump
+ *  - Write S->lockstat as <path> (lockstat_dump_header_t + slots).
+ *  - Returns 0 on success, -1 on error (errno set).
+ */
+int lockstat_dump(const shm_state_t *S, const char *path);
+
+/* Histogram bucket of a duration */
+static inline int lockstat_bucket(uint64_t ns) {
+    if (ns == 0) return 0;
+    int b = 63 - __builtin_clzll(ns);
+    return b < LOCKSTAT_BUCKETS ? b : LOCKSTAT_BUCKETS - 1;
+}
+
+/* Upper bound (ns) of the bucket holding quantile q (0..1) of h, 0 if empty */
+static inline uint64_t lockstat_quantile(const lockstat_hist_t *h, double q) {
+    uint64_t n = 0;
+    for (int b = 0; b < LOCKSTAT_BUCKETS; b++) n += h->hist[b];
+    if (n == 0) return 0;
+    uint64_t rank = (uint64_t)(q * (double)n + 0.5);
+    if (rank == 0) rank = 1;
+    uint64_t seen = 0;
+    for (int b = 0; b < LOCKSTAT_BUCKETS; b++) {
+        seen += h->hist[b];
+        if (seen >= rank) {
+            uint64_t hi = 2ull << b;
+            return hi < h->max_ns ? hi : h->max_ns;
+        }
+    }
+    return h->max_ns;
+}
+
+/* Short lock name ("global", "tick_start", "tick_done") */
+static inline const char *lockstat_lock_name(int lock) {
+    switch (lock) {
+        case LOCKSTAT_GLOBAL:     return "global";
+        case LOCKSTAT_TICK_START: return "tick_start";
+        case LOCKSTAT_TICK_DONE:  return "tick_done";
+        default:                  return "?";
+    }
+}
+
+#endif
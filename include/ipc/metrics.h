@@ -0,0 +1,47 @@
+#ifndef IPC_METRICS_H
+#define IPC_METRICS_H
+
+#include <stdint.h>
+#include "ipc/shared.h"
+
+/*
+ * Metrics registry in shm (S->metrics, metric_id_t in shared.h).
+ *
+ *  - ipc_create/ipc_attach bind the registry when CC runs with --metrics
+ *    (S->metrics.enabled); unbound, every update is a single branch.
+ *  - Counters only grow (metric_add), gauges are overwritten (metric_set);
+ *    all updates are relaxed atomics, no lock.
+ *  - CC renders the registry in Prometheus text format every N ticks
+ *    (CC/metrics_export.h).
+ */
+
+extern metrics_t *g_metrics;
+
+/* metrics_bind
+ *  - Use m for this process' updates if m->enabled, else unbind (m may be NULL).
+ */
+void metrics_bind(metrics_t *m);
+
+static inline void metric_add(metric_id_t id, uint64_t v) {
+    if (g_metrics) __atomic_fetch_add(&g_metrics->v[id], v, __ATOMIC_RELAXED);
+}
+
+static inline void metric_inc(metric_id_t id) {
+    metric_add(id, 1);
+}
+
+static inline void metric_set(metric_id_t id, uint64_t v) {
+    if (g_metrics) __atomic_store_n(&g_metrics->v[id], v, __ATOMIC_RELAXED);
+}
+
+static inline uint64_t metric_get(const metrics_t *m, metric_id_t id) {
+    return __atomic_load_n(&m->v[id], __ATOMIC_RELAXED);
+}
+
+/* metrics_sync_log_drops
+ *  - Add the log lines this process dropped since the last call
+ *    (log_dropped()) to MET_LOG_DROPPED. Called once per tick.
+ */
+void metrics_sync_log_drops(void);
+
+#endif
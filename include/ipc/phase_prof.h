@@ -0,0 +1,71 @@
+#ifndef IPC_PHASE_PROF_H
+#define IPC_PHASE_PROF_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <time.h>
+#include "ipc/shared.h"
+
+/*
+ * Per-tick phase timing (units and CC -> CC -> UI / CSV).
+ *
+ *  - Every process sums the time of its phases for the current tick in a
+ *    process-local accumulator: t0 = prof_now(); ...; prof_add(PROF_RADAR, t0).
+ *  - prof_publish() stores the sums in the process' own slot S->prof[slot]
+ *    (unit_id, 0 for CC) once per tick and clears the accumulator; no lock,
+ *    one writer per slot.
+ *  - After the barrier CC calls prof_aggregate(): the slots of this tick go
+ *    into a window of the last PROF_WINDOW ticks, and min/avg/p99/max per
+ *    phase over that window are published in S->prof_summary (seqlock).
+ */
+
+/* ticks kept by prof_aggregate (p99 is taken over up to PROF_WINDOW * (MAX_UNITS+1) samples) */
+#define PROF_WINDOW 32
+
+/* CLOCK_MONOTONIC in ns (vDSO, no syscall) */
+static inline uint64_t prof_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+/* prof_add
+ *  - Add prof_now() - since to phase ph of the current tick.
+ *  - Also a trace span when the process is traced (ipc/trace.h).
+ */
+void prof_add(prof_phase_t ph, uint64_t since);
+
+/* prof_publish
+ *  - Store the accumulated phase times as S->prof[slot] for tick, then clear
+ *    the accumulator. Units call it right before posting SEM_TICK_DONE.
+ */
+void prof_publish(shm_state_t *S, unit_id_t slot, uint32_t tick);
+
+/* prof_reset
+ *  - Zero slot (CC, when a unit id is (re)registered).
+ */
+void prof_reset(shm_state_t *S, unit_id_t slot);
+
+/* prof_aggregate
+ *  - CC only, once per tick after all units are done: add the slots stamped
+ *    with tick to the window and publish S->prof_summary.
+ */
+void prof_aggregate(shm_state_t *S, uint32_t tick);
+
+/* prof_summary_read
+ *  - Copy a consistent S->prof_summary into out (no lock).
+ *  - Returns 0 on success, -1 if CC kept writing it (errno=EAGAIN).
+ */
+int prof_summary_read(const shm_state_t *S, prof_summary_t *out);
+
+/* prof_csv_header / prof_csv_rows
+ *  - CSV dump of summaries: one row per phase that ran
+ *    (tick,phase,n,min_ns,avg_ns,p99_ns,max_ns).
+ */
+void prof_csv_header(FILE *f);
+void prof_csv_rows(FILE *f, const prof_summary_t *sum);
+
+/* Short phase name ("lock_wait", "radar", ..., "cc_tick"). */
+const char *prof_phase_name(prof_phase_t ph);
+
+#endif
@@ -0,0 +1,114 @@
+#ifndef IPC_RECORDING_H
+#define IPC_RECORDING_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "ipc/shared.h"
+
+/*
+ * Battle recording format (CC --record writes it, `ui --replay` plays it).
+ *
+ *  - Header (REC_HEADER_SIZE bytes, little endian): magic "SKREC1\n\0",
+ *    M, N, MAX_UNITS, keyframe interval (u16 each), rng seed (u64),
+ *    scenario name (char[64]).
+ *  - Then one record per tick: kind (u8, REC_KEY or REC_DELTA), payload
+ *    length (varint), payload. A reader can skip records without decoding
+ *    them, so seeking = jump to the last keyframe <= tick, apply deltas.
+ *  - Payload: tick (key: absolute, delta: minus the previous tick), grid,
+ *    units, hits. Integers are LEB128 varints, signed ones zigzag encoded.
+ *      grid  key:   count, then (index gap, id) for every non-empty cell
+ *            delta: count, then (index gap, new id) for every changed cell
+ *            (cell index = x * N + y, gap = index - previous index - 1)
+ *      units key:   (id, every field) for every alive unit, id 0 ends
+ *            delta: (id, field mask, changed fields as differences), id 0
+ *            ends; mask REC_UNIT_CLEAR alone = the unit died (all fields 0)
+ *      hits  count, then (attacker, target, damage) resolved this tick
+ *  - Dead units are all zero in rec_state_t, so a keyframe and the deltas
+ *    leading to the same tick decode to identical states.
+ */
+
+#define REC_MAGIC "SKREC1\n"
+#define REC_HEADER_SIZE 88
+#define REC_KEY 'K'
+#define REC_DELTA 'D'
+
+/* per-unit fields kept in a recording (entity + telemetry) */
+typedef enum {
+    REC_U_ALIVE = 0,
+    REC_U_FACTION,
+    REC_U_TYPE,
+    REC_U_X,
+    REC_U_Y,
+    REC_U_HP,
+    REC_U_PID,
+    REC_U_HP_MAX,
+    REC_U_SH,
+    REC_U_SH_MAX,
+    REC_U_TARGET,
+    REC_U_ORDER,
+    REC_U_FIRED,        // last_fired_tick
+    REC_U_FIELDS
+} rec_unit_field_t;
+
+#define REC_UNIT_CLEAR (1u << REC_U_FIELDS)
+
+typedef struct {
+    uint16_t m, n, max_units, key_every;
+    uint64_t seed;
+    char scenario[64];
+} rec_header_t;
+
+/* State of one tick as far as the recording is concerned */
+typedef struct {
+    uint32_t tick;
+    unit_id_t grid[M][N];
+    int64_t unit[MAX_UNITS + 1][REC_U_FIELDS];
+    uint16_t hit_count;
+    combat_hit_t hits[MAX_FIRE_INTENTS];
+} rec_state_t;
+
+/* upper bound on one framed record */
+#define REC_RECORD_MAX (16 + (size_t)M * N * 6 + (size_t)(MAX_UNITS + 1) * (REC_U_FIELDS + 3) * 10 + \
+                        (size_t)MAX_FIRE_INTENTS * 12)
+
+/* rec_header_write / rec_header_read
+ *  - Serialize h into out[REC_HEADER_SIZE] / parse it back.
+ *  - read returns 0, or -1 if the magic or the M/N/MAX_UNITS of this build
+ *    do not match (errno=EINVAL).
+ */
+void rec_header_write(const rec_header_t *h, uint8_t out[REC_HEADER_SIZE]);
+int rec_header_read(rec_header_t *h, const uint8_t *buf, size_t len);
+
+/* rec_state_capture
+ *  - Fill st from S (grid, units, telemetry) plus the hits resolved this
+ *    tick. Caller holds SEM_GLOBAL_LOCK (telemetry is read via its seqlock).
+ */
+void rec_state_capture(rec_state_t *st, const shm_state_t *S, const combat_hit_t *hits, int n_hits);
+
+/* rec_encode
+ *  - Framed record for cur: a keyframe if key != 0 (prev is ignored, may be
+ *    NULL), else the delta from prev. cap >= REC_RECORD_MAX. Returns length.
+ */
+size_t rec_encode(const rec_state_t *prev, const rec_state_t *cur, int key, uint8_t *out, size_t cap);
+
+/* rec_next
+ *  - Frame at buf[*off]: sets kind, payload, plen and advances *off.
+ *  - Returns 1, 0 at the end of buf, -1 on a truncated or bad frame.
+ */
+int rec_next(const uint8_t *buf, size_t len, size_t *off, uint8_t *kind, const uint8_t **payload, size_t *plen);
+
+/* rec_apply
+ *  - Apply one record to st (a keyframe replaces it, a delta updates it).
+ *  - Returns 0, or -1 on a malformed payload (st is then undefined).
+ */
+int rec_apply(rec_state_t *st, uint8_t kind, const uint8_t *payload, size_t plen);
+
+/* rec_state_publish
+ *  - Write st into S the way the simulation would have: grid, units,
+ *    unit_count, ticks and telemetry (replay; S is private, not shared).
+ */
+void rec_state_publish(const rec_state_t *st, shm_state_t *S);
+
+#endif
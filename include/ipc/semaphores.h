@@ -13,6 +13,8 @@
  *  - `semid` is a System V semaphore set id.
  *  - `semnum` is the index of a semaphore within that set.
  *  - `delts` is the sem_op delta (positive to post/increment, negative to wait/decrement).
+ *  - Waits and SEM_GLOBAL_LOCK holds are timed when the lock profiler is bound
+ *    (ipc/lockstat.h).
  */
 
 /* sem_op_retry
@@ -13,6 +13,9 @@
 #define MAX_UNITS 64
 #define MAX_WEAPONS 4
 #define MAX_FIGHTERS_PER_BAY 6
+#define MAX_FIRE_INTENTS (MAX_UNITS * MAX_WEAPONS)
+/* runtime log level slots in shm (>= LOG_MOD_COUNT, see log.h) */
+#define SHM_LOG_MODULES 8
 
 /* unit_id stored in grid (0 = empty) */
 typedef int16_t unit_id_t;
@@ -25,6 +28,10 @@ typedef enum { DO_NOTHING= 0, PATROL = 1, ATTACK = 2, MOVE = 3, MOVE_ATTACK = 4,
 typedef enum { FACTION_NONE = 0, FACTION_REPUBLIC=1, FACTION_CIS=2 } faction_t;
 typedef enum { DUMMY = 0, TYPE_FLAGSHIP=1, TYPE_DESTROYER=2, TYPE_CARRIER=3, TYPE_FIGHTER=4, TYPE_BOMBER=5, TYPE_ELITE=6 } unit_type_t;
 
+/* number of values in weapon_type_t / unit_type_t (size of lookup tables) */
+#define WEAPON_TYPE_COUNT 7
+#define UNIT_TYPE_COUNT 7
+
 
 /* point on a grid */
 typedef struct {
@@ -41,10 +48,200 @@ typedef struct {
     uint8_t alive;          // 1 == alive, 0 == dead
     point_t position;       // position on grid (M x N)
     uint32_t flags;         // reserved for status / orders
-    st_points_t dmg_payload;    // demage recived by unit
+    st_points_t dmg_payload;    // net demage resolved by CC, consumed by unit next tick
+    st_points_t hp;             // current hit points (published by unit each tick)
 } unit_entity_t;
 
 
+/* Fire intent posted by a unit during its tick; resolved by CC after the barrier.
+ * Weapon stats are looked up from the attacker type, so only the slot is stored. */
+typedef struct {
+    unit_id_t attacker;     // shooting unit
+    unit_id_t target;       // targeted unit
+    uint8_t weapon;         // index into attacker's loadout (st.ba.arr)
+} fire_intent_t;
+
+/* Hit resolved by CC from a fire intent (reported to the battle recording) */
+typedef struct {
+    unit_id_t attacker;
+    unit_id_t target;
+    st_points_t dmg;
+} combat_hit_t;
+
+
+/* Order slot of a unit, written by its commander only when the order changes.
+ * The unit compares seq with the last one it applied (no message, no syscall). */
+typedef struct {
+    uint32_t seq;           // bumped on every change (0 == never written)
+    unit_id_t commander;    // unit that wrote the order
+    unit_id_t target;       // target unit of the order
+    uint8_t order;          // unit_order_t
+} order_slot_t;
+
+
+/* Per-unit telemetry record, written by the unit itself once per tick without
+ * SEM_GLOBAL_LOCK. Seqlock: seq is odd while the unit writes (see ipc/telemetry.h).
+ * One cache line per record, so units writing their own records never share a line. */
+typedef struct {
+    uint32_t seq;
+    uint32_t tick;              // tick the record was written in
+    st_points_t hp;             // current hit points
+    st_points_t hp_max;         // hit points of a fresh unit of this type
+    st_points_t sh;             // current shields
+    st_points_t sh_max;
+    uint32_t last_fired_tick;   // last tick a fire intent was posted (0 == never)
+    unit_id_t target;           // current secondary (combat) target, 0 == none
+    uint8_t order;              // unit_order_t currently executed
+} __attribute__((aligned(64))) unit_telemetry_t;
+
+
+/* Tick phases timed by units (PROF_LOCK_WAIT..PROF_UNIT_TICK) and by CC
+ * (PROF_CC_*), see ipc/phase_prof.h. */
+typedef enum {
+    PROF_LOCK_WAIT = 0,     // waiting for SEM_GLOBAL_LOCK
+    PROF_RADAR,             // unit_radar scans
+    PROF_PATHFIND,          // order logic + unit_move
+    PROF_SHOOT,             // unit_weapon_shoot
+    PROF_MSG,               // queue traffic and order slots
+    PROF_UNIT_TICK,         // start permit -> SEM_TICK_DONE
+    PROF_CC_LOCK_WAIT,
+    PROF_CC_SPAWN,          // spawn requests
+    PROF_CC_BARRIER,        // start permits -> all units done
+    PROF_CC_COMBAT,         // resolve_fire_intents
+    PROF_CC_PRINT_GRID,
+    PROF_CC_CLEANUP,        // cleanup_dead_units
+    PROF_CC_FRAME,          // ui_frame_publish + world hash
+    PROF_CC_TICK,           // whole CC tick (sleep excluded)
+    PROF_PHASES
+} prof_phase_t;
+
+/* Phase times of one tick, written by a unit (slot unit_id) or CC (slot 0)
+ * when its tick is done. tick is stored last (release): a record with
+ * tick == current tick is complete once the barrier is passed. */
+typedef struct {
+    uint32_t tick;
+    uint32_t ns[PROF_PHASES];   // nanoseconds per phase (saturated at UINT32_MAX)
+} __attribute__((aligned(64))) phase_prof_t;
+
+/* Aggregate of one phase over the recent ticks of all slots (0 == not run). */
+typedef struct {
+    uint32_t n;                 // samples (slot-ticks that ran the phase)
+    uint32_t min_ns;
+    uint32_t avg_ns;
+    uint32_t p99_ns;
+    uint32_t max_ns;
+} prof_stat_t;
+
+/* Phase statistics published by CC every tick. Seqlock like ui_frame_t. */
+typedef struct {
+    uint32_t seq;
+    uint32_t tick;
+    uint32_t window;            // ticks aggregated (PROF_WINDOW once warmed up)
+    prof_stat_t ph[PROF_PHASES];
+} prof_summary_t;
+
+/* Lock contention statistics (instrumentation mode, CC --lockstat; see
+ * ipc/lockstat.h). Log-scale histograms: bucket b counts times in
+ * [2^b, 2^(b+1)) ns, 0 ns in bucket 0, >= 2^31 ns in the last bucket. */
+#define LOCKSTAT_BUCKETS 32
+
+typedef enum {
+    LOCKSTAT_GLOBAL = 0,    // SEM_GLOBAL_LOCK: wait to acquire (hold kept separately)
+    LOCKSTAT_TICK_START,    // unit waiting for its start permit (SEM_TICK_START / SEM_UNIT_TURN)
+    LOCKSTAT_TICK_DONE,     // CC collecting SEM_TICK_DONE (tick barrier)
+    LOCKSTAT_LOCKS
+} lockstat_lock_t;
+
+typedef struct {
+    uint64_t count;
+    uint64_t total_ns;
+    uint64_t max_ns;
+    uint32_t hist[LOCKSTAT_BUCKETS];
+} lockstat_hist_t;
+
+/* One process' numbers, written only by that process (relaxed atomics). */
+typedef struct {
+    char role[8];                           // "CC", "BS", "SQ" ("" == never bound)
+    int32_t pid;                            // last process bound to the slot
+    lockstat_hist_t wait[LOCKSTAT_LOCKS];
+    lockstat_hist_t hold;                   // SEM_GLOBAL_LOCK acquire -> sem_unlock
+} lockstat_slot_t;
+
+typedef struct lockstat {
+    uint8_t enabled;                        // set by CC before any unit is spawned
+    lockstat_slot_t slot[MAX_UNITS+1];      // by unit id, [0] == CC
+} lockstat_t;
+
+/* Trace events (CC --trace, see ipc/trace.h): one span per probed phase. */
+#define TRACE_RING_CAP 256
+
+typedef struct {
+    uint64_t ts_ns;         // CLOCK_MONOTONIC at phase begin
+    uint32_t dur_ns;
+    int32_t pid;
+    uint8_t phase;          // prof_phase_t
+    uint8_t pad[7];
+} trace_event_t;
+
+/* Single-producer ring of one process (slot by unit id, [0] == CC), drained
+ * by CC after every tick. head and tail live in separate cache lines. */
+typedef struct {
+    uint32_t head __attribute__((aligned(64)));    // next write, producer only
+    uint32_t dropped;                               // events lost to a full ring
+    char role[8];                                   // "CC", "BS", "SQ"
+    uint32_t tail __attribute__((aligned(64)));    // next read, CC only
+    trace_event_t ev[TRACE_RING_CAP] __attribute__((aligned(64)));
+} trace_ring_t;
+
+typedef struct {
+    uint32_t enabled;                       // set by CC before any unit is spawned
+    trace_ring_t ring[MAX_UNITS+1];
+} trace_rings_t;
+
+/* Console output ring (see ipc/console_ring.h): stdout/stderr of CC and the
+ * units, forwarded to the terminal tee by a separate process. Producers never
+ * wait; when the forwarder falls behind the oldest slots are overwritten. */
+#define CONSOLE_SLOTS 2048                  // power of two
+#define CONSOLE_SLOT_BYTES 240
+
+typedef struct {
+    uint64_t seq;           // 2*ticket+1 while written, 2*ticket+2 when complete
+    uint16_t len;
+    char data[CONSOLE_SLOT_BYTES];
+} __attribute__((aligned(64))) console_slot_t;
+
+typedef struct {
+    uint32_t enabled;       // set by CC before any unit is spawned
+    int32_t cc_pid;         // forwarder exits if CC is gone
+    uint32_t closing;       // CC: drain what is left and exit
+    uint32_t done;          // forwarder: exited
+    uint64_t dropped;       // slots lost before being forwarded
+    uint64_t head __attribute__((aligned(64)));    // next ticket, fetch_add by producers
+    console_slot_t slot[CONSOLE_SLOTS];
+} console_ring_t;
+
+/* Metrics registry (CC --metrics, see ipc/metrics.h): counters and gauges any
+ * process updates with relaxed atomics, exported by CC in Prometheus format. */
+typedef enum {
+    MET_TICKS = 0,          // counter: ticks completed (CC)
+    MET_SPAWNS,             // counter: unit processes spawned (CC)
+    MET_DAMAGE_EVENTS,      // counter: hits resolved in combat (CC)
+    MET_DAMAGE_POINTS,      // counter: damage dealt by those hits (CC)
+    MET_LOCK_WAITS,         // counter: SEM_GLOBAL_LOCK acquisitions (all processes)
+    MET_LOCK_WAIT_NS,       // counter: ns waited for SEM_GLOBAL_LOCK (all processes)
+    MET_LOG_DROPPED,        // counter: log lines dropped by the log rings (all processes)
+    MET_CONSOLE_DROPPED,    // counter: console ring slots overwritten before forwarding
+    MET_ALIVE_REPUBLIC,     // gauge: alive Republic units (CC)
+    MET_ALIVE_CIS,          // gauge: alive CIS units (CC)
+    MET_COUNT
+} metric_id_t;
+
+typedef struct {
+    uint32_t enabled;       // set by CC before any unit is spawned
+    uint64_t v[MET_COUNT];
+} metrics_t;
+
+
 /* statistics of weapons*/
 typedef struct {
     st_points_t dmg;            // demage per shoot
@@ -87,6 +284,96 @@ typedef struct {
 } unit_stats_t;
 
 
+/* Private state of a unit process (locals of battleship.c / squadron.c),
+ * copied into shm by the unit at the end of each of its ticks so that a world
+ * snapshot can restart it where it was (CM "snapshot", CC --restore, see
+ * CC/snapshot.h). Only the unit writes its slot; CC reads it between ticks. */
+typedef struct {
+    uint32_t tick;                      // tick of the copy (0 == never written)
+    uint8_t order;                      // unit_order_t being executed
+    int8_t have_target_pri;
+    int8_t have_target_sec;
+    int8_t have_target_ter;             // SQ only
+    point_t target_pri;                 // primary (movement) target
+    unit_id_t target_sec;               // secondary (combat) target
+    unit_id_t target_ter;               // SQ only
+    unit_id_t commander;                // SQ: commanding unit, 0 == none
+    uint32_t order_seq;                 // SQ: seq of the last order slot applied
+    uint32_t last_fired_tick;
+    uint32_t req_id;                    // BS: spawn request counter
+    unit_stats_t st;                    // hp, shields, weapon targets, fighter bay
+    unit_id_t underlings[MAX_UNITS];    // BS: squadrons under its command
+} unit_private_t;
+
+
+/* Message queue classes: one SysV queue per class (see ipc_context.h). */
+typedef enum {
+    MQ_SPAWN = 0,   // spawn requests (BS/CM -> CC)
+    MQ_CMD,         // commander requests (SQ -> BS), CM commands (CM -> CC)
+    MQ_REP,         // pid-addressed replies (spawn, commander, CM)
+    MQ_COUNT
+} mq_class_t;
+
+/* Per-queue counters kept in shm (updated atomically by ipc_mesq.c).
+ * Current depth == sent - received. */
+typedef struct {
+    uint32_t sent;
+    uint32_t received;
+    uint32_t send_fail;     // msgsnd failures (EAGAIN == queue full)
+    uint32_t depth_max;     // high watermark of sent - received
+} mq_stats_t;
+
+
+/* Per-unit summary published to the UI with each frame. */
+typedef struct {
+    pid_t pid;
+    st_points_t hp;
+    point_t position;
+    uint8_t alive;
+    uint8_t faction;
+    uint8_t type;
+} ui_unit_summary_t;
+
+/* UI frame tiles: UI_TILE x UI_TILE cells, stamped with the epoch they last changed in */
+#define UI_TILE 8
+#define UI_TILES_X ((M + UI_TILE - 1) / UI_TILE)
+#define UI_TILES_Y ((N + UI_TILE - 1) / UI_TILE)
+
+/* UI map mipmap: level L (1..UI_MIP_LEVELS) has one tile per 2^L x 2^L cells,
+ * holding counts of occupied cells by faction and unit class. */
+#define UI_MIP_LEVELS 3
+#define UI_MIP_W(l) ((M + (1 << (l)) - 1) >> (l))
+#define UI_MIP_H(l) ((N + (1 << (l)) - 1) >> (l))
+#define UI_MIP_TILES (UI_MIP_W(1) * UI_MIP_H(1) + UI_MIP_W(2) * UI_MIP_H(2) + UI_MIP_W(3) * UI_MIP_H(3))
+
+typedef enum {
+    UI_MIP_REP_CAPITAL = 0,     // Republic flagship/destroyer/carrier
+    UI_MIP_REP_CRAFT,           // Republic fighter/bomber/elite
+    UI_MIP_CIS_CAPITAL,
+    UI_MIP_CIS_CRAFT,
+    UI_MIP_OBSTACLE,
+    UI_MIP_CLASSES
+} ui_mip_class_t;
+
+typedef struct {
+    uint8_t n[UI_MIP_CLASSES];  // occupied cells per class (max 64 at level 3)
+} ui_mip_tile_t;
+
+/* UI frame published by CC at the end of each tick (see ipc/ui_frame.h).
+ * Seqlock: seq is odd while CC writes; readers copy without any lock. */
+typedef struct {
+    uint32_t seq;
+    uint32_t epoch;         // tick_epoch value this frame was published with
+    uint32_t tick;
+    uint16_t unit_count;
+    unit_id_t grid[M][N];
+    uint32_t tile_epoch[UI_TILES_X][UI_TILES_Y];    // epoch of last change per tile
+    uint8_t cell_class[M][N];                       // 1 + ui_mip_class_t per cell, 0 = empty
+    ui_mip_tile_t mip[UI_MIP_TILES];                // levels 1..UI_MIP_LEVELS, see ui_mip_index
+    ui_unit_summary_t units[MAX_UNITS+1];
+} ui_frame_t;
+
+
 /* Global shared state placed in SysV shared memory segment.
  * Indexing: units[0] is unused; valid unit IDs range 1..MAX_UNITS.
  */
@@ -95,6 +382,9 @@ typedef struct {
     uint32_t ticks;         // global tick counter incremented by CC
     uint16_t next_unit_id;  // allocator for new unit IDs (starts at 1)
     uint16_t unit_count;    // number of active units
+    uint64_t rng_seed;      // scenario seed keying all per-unit RNG streams
+    uint8_t deterministic;  // 1 == lockstep mode: units run one at a time in id order
+    uint8_t log_levels[SHM_LOG_MODULES];    // log_level_t per log_module_t, 0 == DEBUG (CM "loglevel")
 
     /* Tick barrier synchronization bookkeeping */
     uint16_t tick_expected;                     // how many units are expected this tick
@@ -102,7 +392,28 @@ typedef struct {
     uint32_t last_step_tick[MAX_UNITS+1];       // per-unit last-tick performed
 
     unit_id_t grid[M][N];                       // grid of unit IDs (0 == empty)
+    uint8_t grid_dirty[M];                      // column x changed since last world hash update
     unit_entity_t units[MAX_UNITS+1];           // units indexed by unit_id (0 unused)
+    order_slot_t orders[MAX_UNITS+1];           // commander -> underling orders, by underling id
+    unit_telemetry_t telemetry[MAX_UNITS+1];    // per-unit telemetry, written by each unit (own seqlock)
+    unit_private_t priv[MAX_UNITS+1];           // unit process state for snapshots, written by each unit
+    phase_prof_t prof[MAX_UNITS+1];             // per-tick phase times, [0] == CC (ipc/phase_prof.h)
+    prof_summary_t prof_summary;                // phase min/avg/p99, aggregated by CC every tick
+    lockstat_t lockstat;                        // lock wait/hold histograms (ipc/lockstat.h)
+    trace_rings_t trace;                        // trace event rings (ipc/trace.h)
+    metrics_t metrics;                          // exported counters/gauges (ipc/metrics.h)
+    console_ring_t console;                     // stdout/stderr ring (ipc/console_ring.h)
+
+    /* Message queue depth counters, indexed by mq_class_t */
+    mq_stats_t mq_stats[MQ_COUNT];
+
+    /* UI frame + tick epoch (futex word, bumped after each published frame) */
+    uint32_t tick_epoch;
+    ui_frame_t frame;
+
+    /* Combat: fire intents of the current tick (cleared by CC on resolution) */
+    uint16_t fire_count;
+    fire_intent_t fire[MAX_FIRE_INTENTS];
 } shm_state_t;
 
 
@@ -112,12 +423,16 @@ typedef struct {
  *  - SEM_GLOBAL_LOCK: mutex protecting the entire shm_state_t (grid + units + ticks).
  *  - SEM_TICK_START: CC posts N permits (one per alive unit) to allow units to run a tick.
  *  - SEM_TICK_DONE: each unit posts when finished; CC waits N times to collect them.
+ *  - SEM_UNIT_TURN(id): deterministic mode only; CC posts one unit's turn at a time
+ *    (ascending id) instead of SEM_TICK_START, and waits for its SEM_TICK_DONE.
  */
 enum {
     SEM_GLOBAL_LOCK = 0,
     SEM_TICK_START,
     SEM_TICK_DONE,
-    SEM_COUNT
+    SEM_UNIT_TURN_BASE,
+    SEM_COUNT = SEM_UNIT_TURN_BASE + MAX_UNITS + 1
 };
+#define SEM_UNIT_TURN(id) ((unsigned short)(SEM_UNIT_TURN_BASE + (id)))
 
 #endif
\ No newline at end of file
@@ -0,0 +1,63 @@
+#ifndef IPC_SHM_BACKEND_H
+#define IPC_SHM_BACKEND_H
+
+#include <stddef.h>
+#include <sys/ipc.h>
+
+/*
+ * POSIX world segment (command_center --shm posix), the alternative to the
+ * SysV shmget segment. Semaphores and message queues stay SysV.
+ *
+ *  - The segment is a file named after the ftok key ("skirmish-<key>"):
+ *    shm_open(3), i.e. /dev/shm/skirmish-<key>, or with huge pages a file of
+ *    the same name on a hugetlbfs mount. Any process can map it read-only
+ *    (skirmish-lockstat does), and after a crash it stays there with the
+ *    last state until the next CC run removes it.
+ *  - huge: hugetlbfs when a mount with enough free pages exists, else
+ *    /dev/shm with madvise(MADV_HUGEPAGE), which takes effect when the
+ *    /dev/shm mount has huge=advise (or shmem_enabled is [force]).
+ *  - shm_posix_open finds either file, so attaching processes need no flag.
+ *  - All functions return 0 on success, -1 on failure with errno set.
+ */
+
+typedef enum {
+    SHM_PAGES_NORMAL = 0,   // base pages
+    SHM_PAGES_THP,          // /dev/shm, MADV_HUGEPAGE given and shmem THP enabled
+    SHM_PAGES_HUGETLB       // hugetlbfs file
+} shm_pages_t;
+
+typedef struct {
+    void *addr;             // mapping, NULL if not mapped
+    size_t len;             // mapping length (size rounded to the page size)
+    shm_pages_t pages;
+    char path[128];         // file backing the mapping
+} shm_posix_t;
+
+/* shm_posix_create
+ *  - Remove any old file for key, create a new one of at least size bytes
+ *    (zero filled) and map it read/write.
+ */
+int shm_posix_create(shm_posix_t *seg, key_t key, size_t size, int huge);
+
+/* shm_posix_open
+ *  - Map the existing file for key (hugetlbfs first, then /dev/shm).
+ *  - errno = ENOENT if there is none (the run uses SysV), EINVAL if it is
+ *    smaller than min_size.
+ */
+int shm_posix_open(shm_posix_t *seg, key_t key, size_t min_size, int readonly);
+
+/* shm_posix_close
+ *  - Unmap the segment; the file stays.
+ */
+int shm_posix_close(shm_posix_t *seg);
+
+/* shm_posix_unlink
+ *  - Remove the files for key in both locations. Missing files are not an
+ *    error.
+ */
+int shm_posix_unlink(key_t key);
+
+/* "4k", "thp" or "hugetlb" */
+const char *shm_pages_name(shm_pages_t pages);
+
+#endif
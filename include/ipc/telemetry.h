@@ -0,0 +1,36 @@
+#ifndef IPC_TELEMETRY_H
+#define IPC_TELEMETRY_H
+
+#include <stdint.h>
+#include "ipc/shared.h"
+
+/*
+ * Per-unit telemetry (unit -> UI) without locks or messages.
+ *
+ *  - Each unit is the single writer of S->telemetry[unit_id] and calls
+ *    telemetry_write() once per tick, outside SEM_GLOBAL_LOCK.
+ *  - Every record has its own seqlock (seq odd while written), so a reader
+ *    never waits for other units and units never contend with each other.
+ *  - CC resets the record when it registers a new unit in the slot.
+ */
+
+/* telemetry_write
+ *  - Publish rec as the telemetry of unit_id (rec->seq is ignored).
+ *    Single writer per record: the unit itself.
+ */
+void telemetry_write(shm_state_t *S, unit_id_t unit_id, const unit_telemetry_t *rec);
+
+/* telemetry_read
+ *  - Copy a consistent telemetry record of unit_id into out.
+ *  - Returns 0 on success, -1 if the record kept changing or its writer died
+ *    mid-write (errno=EAGAIN).
+ */
+int telemetry_read(const shm_state_t *S, unit_id_t unit_id, unit_telemetry_t *out);
+
+/* telemetry_reset
+ *  - Zero the record of unit_id (CC, when a slot is (re)registered). Leaves
+ *    seq even, so a record left odd by a killed writer is readable again.
+ */
+void telemetry_reset(shm_state_t *S, unit_id_t unit_id);
+
+#endif
@@ -0,0 +1,45 @@
+#ifndef IPC_TRACE_H
+#define IPC_TRACE_H
+
+#include <stdint.h>
+#include "ipc/shared.h"
+
+/*
+ * Tick timeline tracer (CC --trace -> <run_dir>/trace.json).
+ *
+ *  - Every phase probe (prof_add, ipc/phase_prof.h) also becomes a span in the
+ *    process' ring S->trace.ring[slot] once the process called trace_bind().
+ *    A full ring drops the span and counts it; nothing blocks.
+ *  - After each tick CC drains all rings into a Chrome trace_event JSON file
+ *    (complete "X" events, one lane per process named "BS u3", "CC", ...),
+ *    readable by chrome://tracing, Perfetto or speedscope.
+ *  - Without --trace trace_bind() is a no-op and probes pay one branch.
+ */
+
+/* trace_bind
+ *  - Write this process' spans to S->trace.ring[slot] (unit id, 0 for CC)
+ *    under role. No-op unless CC enabled tracing (S->trace.enabled).
+ */
+void trace_bind(shm_state_t *S, unit_id_t slot, const char *role);
+
+/* trace_span
+ *  - Record phase ph from t0 to t1 (prof_now() values) if bound.
+ */
+void trace_span(int ph, uint64_t t0, uint64_t t1);
+
+/* trace_export_open
+ *  - CC: start the JSON file at path. Returns 0 on success, -1 (errno set).
+ */
+int trace_export_open(const char *path);
+
+/* trace_export_tick
+ *  - CC: move the spans of all rings to the file, tagged with tick.
+ */
+void trace_export_tick(shm_state_t *S, uint32_t tick);
+
+/* trace_export_close
+ *  - CC: drain once more, finish the JSON and report spans written/dropped.
+ */
+void trace_export_close(shm_state_t *S, uint32_t tick, uint64_t *written, uint64_t *dropped);
+
+#endif
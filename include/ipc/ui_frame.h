@@ -0,0 +1,66 @@
+#ifndef IPC_UI_FRAME_H
+#define IPC_UI_FRAME_H
+
+#include <stdint.h>
+#include "ipc/shared.h"
+
+/*
+ * UI frame publication (CC -> UI) without locks or messages.
+ *
+ *  - CC calls ui_frame_publish() at the end of each tick (it already holds
+ *    SEM_GLOBAL_LOCK, so the source state is stable). The frame is guarded by
+ *    a seqlock: S->frame.seq is odd while it is being written.
+ *  - After the frame is written, S->tick_epoch is bumped and every futex
+ *    waiter on it is woken.
+ *  - Readers call tick_epoch_wait() and then ui_frame_read(); neither takes
+ *    SEM_GLOBAL_LOCK nor sends a message.
+ */
+
+/* ui_mip_index
+ *  - Index into frame->mip of tile (tx, ty) at level (1..UI_MIP_LEVELS).
+ *    Tiles of a level are stored x-major, like the grid.
+ */
+static inline int ui_mip_index(int level, int tx, int ty) {
+    int off = 0;
+    for (int l = 1; l < level; l++) off += UI_MIP_W(l) * UI_MIP_H(l);
+    return off + tx * UI_MIP_H(level) + ty;
+}
+
+/* ui_frame_publish
+ *  - Copy tick, per-unit summaries and the changed parts of the grid from S
+ *    into S->frame, then bump S->tick_epoch and wake waiters. Single writer (CC).
+ *  - Only grid columns flagged in S->grid_dirty are compared (all of them on
+ *    the first publish); tiles that changed get tile_epoch = the new epoch.
+ *    Call it before world_hash_update(), which clears grid_dirty.
+ */
+void ui_frame_publish(shm_state_t *S);
+
+/* ui_frame_read
+ *  - Copy a consistent frame into out (retries while CC is writing).
+ *  - Returns 0 on success, -1 if no consistent copy was obtained (errno=EAGAIN).
+ */
+int ui_frame_read(const shm_state_t *S, ui_frame_t *out);
+
+/* ui_frame_read_region
+ *  - Like ui_frame_read, but copies only the header (epoch, tick, unit_count),
+ *    the unit summaries and one w x h window at one level of detail:
+ *    level 0 -> grid cells [x0, x0+w) x [y0, y0+h) plus tile_epoch,
+ *    level L -> mip tiles of level L in that window (tile coordinates).
+ *    Other parts of out are left as they were. Window is clamped to the level size.
+ *  - w == 0 or h == 0 copies header and units only.
+ *  - Returns 0 on success, -1 if no consistent copy was obtained (errno=EAGAIN).
+ */
+int ui_frame_read_region(const shm_state_t *S, ui_frame_t *out, int level, int x0, int y0, int w, int h);
+
+/* tick_epoch_load
+ *  - Current value of S->tick_epoch.
+ */
+uint32_t tick_epoch_load(const shm_state_t *S);
+
+/* tick_epoch_wait
+ *  - Block until S->tick_epoch != seen or timeout_ms elapses (timeout_ms < 0: no timeout).
+ *  - Returns 1 if the epoch advanced, 0 on timeout or signal, -1 on error (errno set).
+ */
+int tick_epoch_wait(shm_state_t *S, uint32_t seen, int timeout_ms);
+
+#endif
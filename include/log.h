@@ -8,11 +8,21 @@
  * - log_init(role, unit_id): open per-process log file and global ALL.log in
  *   the run directory. role is a short string ("CC","BS",...). unit_id is 0 for CC.
  * - log_close(): flush/close logs.
- * - log_set_level(): adjust verbosity (default INFO).
- * - log_msg(): printf-like logging; writes to per-process log and global ALL.log.
+ * - log_set_level() / log_set_module_level(): runtime verbosity per module
+ *   (default DEBUG). Once ipc_create/ipc_attach bound the levels to shm, a
+ *   change (CM "loglevel") applies to every process at its next log call.
+ * - log_msg(): printf-like logging; formats into a lock-free in-process ring,
+ *   a writer thread writes batches to the per-process log and global ALL.log.
+ * - log_dropped(): lines dropped because the ring was full.
  * - log_printf(): write a line to both stdout and the logs.
  *
- * Convenience macros LOGD/LOGI/LOGW/LOGE map to log_msg with levels.
+ * Convenience macros LOGD/LOGI/LOGW/LOGE map to log_msg with levels. They test
+ * the level before any argument is evaluated:
+ * - compile time: calls below SKIRMISH_LOG_MIN_LEVEL (make LOG_MIN_LEVEL=n)
+ *   are removed entirely.
+ * - run time: one compare against the level of the calling module. The module
+ *   is the process role (CC/BS/SQ/UI/CM) unless the source file defines
+ *   LOG_MODULE before including this header (e.g. LOG_MOD_IPC).
  */
 
 typedef enum {
@@ -22,6 +32,35 @@ typedef enum {
     LOG_LVL_ERROR = 3
 } log_level_t;
 
+/* Modules with their own runtime level. */
+typedef enum {
+    LOG_MOD_CC = 0,
+    LOG_MOD_BS,
+    LOG_MOD_SQ,
+    LOG_MOD_UI,
+    LOG_MOD_CM,
+    LOG_MOD_IPC,
+    LOG_MOD_COUNT
+} log_module_t;
+
+#ifndef SKIRMISH_LOG_MIN_LEVEL
+#define SKIRMISH_LOG_MIN_LEVEL LOG_LVL_DEBUG
+#endif
+
+/* Runtime levels, indexed by log_module_t (process-local array or shm), and
+ * the entry of this process' own module. Read by the macros below. */
+extern volatile uint8_t *g_log_levels;
+extern volatile uint8_t *g_log_self_level;
+
+#ifdef LOG_MODULE
+#define LOG_RUNTIME_MIN (g_log_levels[LOG_MODULE])
+#else
+#define LOG_RUNTIME_MIN (*g_log_self_level)
+#endif
+
+/* 1 if a line of level lvl from this call site would be logged. */
+#define LOG_ENABLED(lvl) ((lvl) >= SKIRMISH_LOG_MIN_LEVEL && (lvl) >= LOG_RUNTIME_MIN)
+
 /* Initialize logger for this process.
  * - role: short string identifying process role ("CC", "BS", ...).
  * - unit_id: 0 for CC, otherwise the unit id.
@@ -29,22 +68,39 @@ typedef enum {
  */
 int log_init(const char *role, int16_t unit_id);
 
-/* Close logger (idempotent). */
+/* Close logger (idempotent): flushes pending lines and stops the writer. */
 void log_close(void);
 
-/* Set minimum log level; messages below this level are dropped. */
+/* Set the runtime minimum level of every module / of one module. */
 void log_set_level(log_level_t lvl);
+void log_set_module_level(log_module_t mod, log_level_t lvl);
+log_level_t log_get_module_level(log_module_t mod);
+
+/* Use levels (n entries, at least LOG_MOD_COUNT) shared with other processes,
+ * NULL to go back to the process-local copy. Called by ipc_create/ipc_attach
+ * and ipc_detach; zeroed memory means DEBUG for every module. */
+void log_bind_levels(uint8_t *levels, int n);
 
-/* Log line (printf-like). */
+/* Names for CM / reports: "CC".."IPC", "debug".."error" (parse: -1 if unknown). */
+const char *log_module_name(log_module_t mod);
+const char *log_level_name(log_level_t lvl);
+int log_module_from_name(const char *name);
+int log_level_from_name(const char *name);
+
+/* Log line (printf-like). Not filtered by level; use the macros. */
 void log_msg(log_level_t lvl, const char *fmt, ...);
 
+/* Number of lines dropped so far because the ring was full. */
+uint64_t log_dropped(void);
+
 /* Write same line to stdout and logs. */
 void log_printf(const char *fmt, ...);
 
 /* Convenience macros */
-#define LOGD(...) log_msg(LOG_LVL_DEBUG, __VA_ARGS__)
-#define LOGI(...) log_msg(LOG_LVL_INFO,  __VA_ARGS__)
-#define LOGW(...) log_msg(LOG_LVL_WARN,  __VA_ARGS__)
-#define LOGE(...) log_msg(LOG_LVL_ERROR, __VA_ARGS__)
+#define LOG_AT(lvl, ...) do { if (LOG_ENABLED(lvl)) log_msg((lvl), __VA_ARGS__); } while (0)
+#define LOGD(...) LOG_AT(LOG_LVL_DEBUG, __VA_ARGS__)
+#define LOGI(...) LOG_AT(LOG_LVL_INFO,  __VA_ARGS__)
+#define LOGW(...) LOG_AT(LOG_LVL_WARN,  __VA_ARGS__)
+#define LOGE(...) LOG_AT(LOG_LVL_ERROR, __VA_ARGS__)
 
 #endif
\ No newline at end of file
@@ -0,0 +1,104 @@
+#ifndef LOG_BIN_H
+#define LOG_BIN_H
+
+#include <stdint.h>
+
+/* Binary log format (SKIRMISH_LOG_FORMAT=binary, see log.h).
+ *
+ * One file per process (<role>[_u<id>]_pid_<pid>.blog) starting with
+ * log_bin_header_t, followed by records. Every record starts with a kind byte:
+ *
+ *  - LOG_BIN_FMT: format string definition, written the first time a call
+ *    site logs (may appear after the first records using it).
+ *        u8 kind, u8 nargs, u16 fmt_id, u16 len, u8 argtype[nargs], char fmt[len]
+ *  - LOG_BIN_MSG: one log call, raw arguments instead of text.
+ *        u8 kind, u8 level, u16 fmt_id, u16 payload_len, u64 mono_ns, payload
+ *
+ * Payload holds the arguments in order, little endian, by argtype:
+ *   LOG_ARG_I32 / LOG_ARG_I64: int32/int64, LOG_ARG_F64: double,
+ *   LOG_ARG_PTR: uint64, LOG_ARG_STR: u16 len + bytes (truncated, no '\0').
+ * '*' widths/precisions are LOG_ARG_I32 arguments of their own.
+ *
+ * Timestamps are CLOCK_MONOTONIC; the header pairs one with CLOCK_REALTIME so
+ * skirmish-logcat can print wall time and merge files of several processes.
+ */
+
+#define LOG_BIN_MAGIC "SKLOGB1"
+#define LOG_BIN_MAX_ARGS 24
+
+enum { LOG_BIN_FMT = 1, LOG_BIN_MSG = 2 };
+enum { LOG_ARG_I32 = 1, LOG_ARG_I64, LOG_ARG_F64, LOG_ARG_PTR, LOG_ARG_STR };
+
+typedef struct {
+    char magic[8];          // LOG_BIN_MAGIC
+    char role[8];
+    int32_t pid;
+    int32_t unit_id;
+    uint64_t mono_ns;       // CLOCK_MONOTONIC at log_init ...
+    uint64_t real_ns;       // ... and CLOCK_REALTIME at the same moment
+} log_bin_header_t;
+
+typedef struct __attribute__((packed)) {
+    uint8_t kind;           // LOG_BIN_FMT
+    uint8_t nargs;
+    uint16_t fmt_id;
+    uint16_t len;           // bytes of format string
+} log_bin_fmt_t;
+
+typedef struct __attribute__((packed)) {
+    uint8_t kind;           // LOG_BIN_MSG
+    uint8_t level;          // log_level_t
+    uint16_t fmt_id;
+    uint16_t payload_len;
+    uint64_t mono_ns;
+} log_bin_msg_t;
+
+/* log_bin_parse_format
+ *  - Argument types (LOG_ARG_*) consumed by printf format fmt, in order.
+ *  - Returns number of arguments (<= max), -1 for conversions that cannot be
+ *    logged in binary form (%n, wide strings, too many arguments).
+ */
+static inline int log_bin_parse_format(const char *fmt, uint8_t *types, int max) {
+    int n = 0;
+    for (const char *p = fmt; *p; p++) {
+        if (*p != '%') continue;
+        p++;
+        if (*p == '%') continue;
+        while (*p && (*p == '-' || *p == '+' || *p == ' ' || *p == '#' || *p == '0' || *p == '\'')) p++;
+        if (*p == '*') { if (n >= max) return -1; types[n++] = LOG_ARG_I32; p++; }
+        while (*p >= '0' && *p <= '9') p++;
+        if (*p == '.') {
+            p++;
+            if (*p == '*') { if (n >= max) return -1; types[n++] = LOG_ARG_I32; p++; }
+            while (*p >= '0' && *p <= '9') p++;
+        }
+        int wide = 0;
+        while (*p == 'h' || *p == 'l' || *p == 'L' || *p == 'z' || *p == 'j' || *p == 't' || *p == 'q') {
+            if (*p == 'l' || *p == 'z' || *p == 'j' || *p == 't' || *p == 'q' || *p == 'L') wide = 1;
+            p++;
+        }
+        if (n >= max) return -1;
+        switch (*p) {
+            case 'd': case 'i': case 'u': case 'x': case 'X': case 'o': case 'c':
+                types[n++] = wide ? LOG_ARG_I64 : LOG_ARG_I32;
+                break;
+            case 'f': case 'F': case 'e': case 'E': case 'g': case 'G': case 'a': case 'A':
+                if (wide && p[-1] == 'L') return -1;    // long double
+                types[n++] = LOG_ARG_F64;
+                break;
+            case 's':
+                if (wide) return -1;
+                types[n++] = LOG_ARG_STR;
+                break;
+            case 'p':
+                types[n++] = LOG_ARG_PTR;
+                break;
+            default:
+                return -1;
+        }
+        if (!*p) break;
+    }
+    return n;
+}
+
+#endif
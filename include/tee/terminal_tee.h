@@ -1,4 +1,5 @@
 #pragma once
+#include <stdint.h>
 #include <sys/types.h>
 
 /* Start terminal tee as a detached background process.
@@ -10,3 +11,20 @@
  * Returns pipe write fd for CC to redirect stdout/stderr to, or -1 on error.
  */
 int start_terminal_tee(const char *run_dir);
+
+/* UI [STD] panel FIFO: while a UI reads it, it gets the output instead of
+ * the terminal. */
+#define TEE_UI_FIFO "/tmp/skirmish_std.fifo"
+
+/* tee_pump flags */
+#define TEE_RW_ONLY 1   /* never use tee(2)/splice(2), always readv/writev */
+
+/* The worker's copy loop: everything from in_fd goes to log_fd and to the UI
+ * FIFO at ui_pipe_path while a UI reads it, else to term_fd (-1: none).
+ *  - Linux, screen is a pipe/FIFO: tee(2) into the screen + splice(2) into
+ *    the log, no copy through user space (log_fd must not be O_APPEND).
+ *  - Otherwise (e.g. /dev/tty): readv of up to 64 KB, one writev per output.
+ * Returns at EOF on in_fd with the number of bytes moved. Does not close
+ * log_fd or term_fd.
+ */
+uint64_t tee_pump(int in_fd, int log_fd, int term_fd, const char *ui_pipe_path, int flags);
@@ -12,6 +12,11 @@
 #include "ipc/semaphores.h"
 #include "ipc/shared.h"
 #include "ipc/ipc_mesq.h"
+#include "ipc/phase_prof.h"
+#include "ipc/lockstat.h"
+#include "ipc/trace.h"
+#include "ipc/metrics.h"
+#include "ipc/console_ring.h"
 
 #include "CC/weapon_stats.h"
 #include "CC/unit_stats.h"
@@ -24,10 +29,17 @@ static volatile unit_order_t order = PATROL;
 
 static volatile sig_atomic_t g_stop = 0;
 
-static volatile sig_atomic_t g_damage_pending = 0;
-
 static volatile unit_id_t underlings[MAX_UNITS];
 
+/* last tick a fire intent was posted (telemetry) */
+static uint32_t g_last_fired_tick = 0;
+
+/* approach distance per target type, precomputed from loadout at startup */
+static int16_t g_aproach[UNIT_TYPE_COUNT];
+
+/* per-tick RNG stream keyed by (scenario seed, unit id, tick) */
+static rng_t g_rng;
+
 static ipc_ctx_t *g_ctx = NULL;
 static unit_id_t g_unit_id = 0;
 
@@ -43,12 +55,6 @@ static void cleanup_and_exit(int exit_code) {
     exit(exit_code);
 }
 
-static void on_damage(int sig) {
-    (void)sig;
-    LOGD("g_damage_pending flag raised. (g_damage_pending = 1)");
-    g_damage_pending = 1;
-}
-
 static void on_term(int sig) {
     (void)sig;
     LOGD("g_stop flag raised. (g_stop = 1)");
@@ -100,13 +106,13 @@ static void patrol_action(ipc_ctx_t *ctx,
     // Determine approach distance FIRST (before checking if we've reached target)
     if (*have_target_sec) {
         unit_type_t target_type = (unit_type_t)ctx->S->units[*target_sec].type;
-        *aproach = (int)unit_calculate_aproach(st->ba, target_type);
+        *aproach = (int)g_aproach[target_type < UNIT_TYPE_COUNT ? target_type : DUMMY];
     }
 
     // Chosing patrol point
     if (*have_target_pri && in_disk_i(from.x, from.y, target_pri->x, target_pri->y, *aproach)) *have_target_pri = 0;
     if (!*have_target_pri) {
-        *have_target_pri = unit_chose_patrol_point(ctx, unit_id, target_pri, *st); 
+        *have_target_pri = unit_chose_patrol_point(ctx, unit_id, target_pri, *st, &g_rng); 
     }
     LOGD("[BS %u] target (%d,%d)", unit_id, target_pri->x, target_pri->y);
 
@@ -124,8 +130,9 @@ static void battleship_action(ipc_ctx_t *ctx,
 )
 {
     // process squadron commander requests
+    uint64_t p0 = prof_now();
     mq_commander_req_t cmd_req;
-    while (mq_try_recv_commander_req(ctx->q_req, &cmd_req) == 1) {
+    while (mq_try_recv_commander_req(ctx->q_cmd, &cmd_req) == 1) {
         mq_commander_rep_t reply;
         reply.mtype = cmd_req.sender;  // send to squadron's pid
         reply.req_id = cmd_req.req_id;
@@ -156,13 +163,14 @@ static void battleship_action(ipc_ctx_t *ctx,
         
         mq_send_commander_reply(ctx->q_rep, &reply);
     }
+    prof_add(PROF_MSG, p0);
 
     // Detect units
+    p0 = prof_now();
     unit_id_t detect_id[MAX_UNITS];
     (void)memset(detect_id, 0, sizeof(detect_id));
-    st_points_t out_dmg[st->ba.count];
-    (void)memset(out_dmg, 0, sizeof(out_dmg));
     int count = unit_radar(unit_id, *st, ctx->S->units, detect_id, ctx->S->units[unit_id].faction);
+    prof_add(PROF_RADAR, p0);
 
     //DEBUG: Print detected units
     printf("[BS %d] ", unit_id);
@@ -177,6 +185,7 @@ static void battleship_action(ipc_ctx_t *ctx,
     int aproach = st->si;
     point_t from = ctx->S->units[unit_id].position;
 
+    p0 = prof_now();
     switch (order)
         {
         case PATROL:
@@ -198,12 +207,15 @@ static void battleship_action(ipc_ctx_t *ctx,
 
         // Moving
     unit_move(ctx, unit_id, from, target_pri, st, aproach);
+    prof_add(PROF_PATHFIND, p0);
 
 
 
     // Second scan
+    p0 = prof_now();
     (void)memset(detect_id, 0, sizeof(detect_id));
     count = unit_radar(unit_id, *st, ctx->S->units, detect_id, ctx->S->units[unit_id].faction);
+    prof_add(PROF_RADAR, p0);
 
     // Checking if secondary target is within DR
     if (*have_target_sec){
@@ -218,7 +230,10 @@ static void battleship_action(ipc_ctx_t *ctx,
     }
 
     if (*have_target_sec) {
-        (void)unit_weapon_shoot(ctx, unit_id, st, *target_sec, count, detect_id, out_dmg);
+        p0 = prof_now();
+        if (unit_weapon_shoot(ctx, unit_id, st, *target_sec, count, detect_id) > 0)
+            g_last_fired_tick = ctx->S->ticks;
+        prof_add(PROF_SHOOT, p0);
         LOGD("[BS %d] ap=%d Sec target %d", unit_id, aproach, *target_sec);
         printf("[BS %d] ap=%d Sec target %d\n", unit_id, aproach, *target_sec);
     }
@@ -226,6 +241,7 @@ static void battleship_action(ipc_ctx_t *ctx,
     // Send orders to fighter squadrons based on target type
     unit_type_t target_type = *have_target_sec ? ctx->S->units[*target_sec].type : DUMMY;
     
+    p0 = prof_now();
     for (int i = 0; i < MAX_UNITS; i++) {
         if (underlings[i] == 0) continue;
         if (!ctx->S->units[underlings[i]].alive) {
@@ -233,34 +249,33 @@ static void battleship_action(ipc_ctx_t *ctx,
             continue;
         }
         
-        pid_t sq_pid = ctx->S->units[underlings[i]].pid;
-        if (sq_pid <= 0) continue;
+        if (ctx->S->units[underlings[i]].pid <= 0) continue;
         
         unit_type_t sq_type = ctx->S->units[underlings[i]].type;
-        mq_order_t order_msg = {0};
-        order_msg.mtype = sq_pid;
+        unit_order_t order = DO_NOTHING;
+        unit_id_t order_target = 0;
         
         if (!*have_target_sec) {
             // No secondary target: all squadrons GUARD the battleship
-            order_msg.order = GUARD;
-            order_msg.target_id = unit_id;
+            order = GUARD;
+            order_target = unit_id;
         } else if (target_type == TYPE_FIGHTER || target_type == TYPE_ELITE) {
             // Target is FIGHTER or ELITE
             if (sq_type == TYPE_FIGHTER || sq_type == TYPE_ELITE) {
                 // Fighters and Elites ATTACK the target
-                order_msg.order = ATTACK;
-                order_msg.target_id = *target_sec;
+                order = ATTACK;
+                order_target = *target_sec;
             } else {
                 // Bombers GUARD the battleship
-                order_msg.order = GUARD;
-                order_msg.target_id = unit_id;
+                order = GUARD;
+                order_target = unit_id;
             }
         } else if (TYPE_FLAGSHIP <= target_type && target_type <= TYPE_CARRIER) {
             // Target is BS or FS
             if (sq_type == TYPE_BOMBER) {
                 // Bombers ATTACK the target
-                order_msg.order = ATTACK;
-                order_msg.target_id = *target_sec;
+                order = ATTACK;
+                order_target = *target_sec;
             } else {
                 // Fighters and Elites GUARD a bomber (find first bomber)
                 unit_id_t bomber_id = 0;
@@ -272,18 +287,20 @@ static void battleship_action(ipc_ctx_t *ctx,
                         break;
                     }
                 }
-                order_msg.order = GUARD;
-                order_msg.target_id = bomber_id ? bomber_id : unit_id;
+                order = GUARD;
+                order_target = bomber_id ? bomber_id : unit_id;
             }
         } else {
             // Default: GUARD the battleship
-            order_msg.order = GUARD;
-            order_msg.target_id = unit_id;
+            order = GUARD;
+            order_target = unit_id;
         }
         
-        mq_send_order(ctx->q_req, &order_msg);
-        LOGD("[BS %u] sent order %d with target %u to SQ %u", unit_id, order_msg.order, order_msg.target_id, underlings[i]);
+        // written only when changed; squadron picks it up by comparing seq
+        if (unit_publish_order(ctx, unit_id, underlings[i], order, order_target))
+            LOGD("[BS %u] sent order %d with target %u to SQ %u", unit_id, order, order_target, underlings[i]);
     }
+    prof_add(PROF_MSG, p0);
 
         
 }
@@ -292,6 +309,7 @@ int main(int argc, char **argv) {
     setpgid(getpid(), 0);
     const char *ftok_path = "./ipc.key";
     int faction = 0, type_i = 0, x = -1, y = -1;
+    int restore = 0;
     
     uint32_t req_id_counter = 0;
     
@@ -316,6 +334,7 @@ int main(int argc, char **argv) {
         else if (!strcmp(argv[i], "--x") && i + 1 < argc) x = atoi(argv[++i]);
         else if (!strcmp(argv[i], "--y") && i + 1 < argc) y = atoi(argv[++i]);
         else if (!strcmp(argv[i], "--commander") && i + 1 < argc) ++i; // ignore for battleships
+        else if (!strcmp(argv[i], "--restore")) restore = 1;   // continue from S->priv (CC --restore)
     }
 
     if (validate_int_range(unit_id, 1, MAX_UNITS, "battleship:validate_unit_id") != 0) {
@@ -329,25 +348,17 @@ int main(int argc, char **argv) {
     sa1.sa_handler = on_term;
     CHECK_SYS_CALL_NONFATAL(sigaction(SIGTERM, &sa1, NULL), "battleship:sigaction_SIGTERM");
 
-    // damage payload
-    struct sigaction sa2;
-    memset(&sa2, 0, sizeof(sa2));
-    sa2.sa_handler = on_damage;
-    sigemptyset(&sa2.sa_mask);
-    sa2.sa_flags = 0;
-    CHECK_SYS_CALL_NONFATAL(sigaction(SIGRTMAX, &sa2, NULL), "battleship:sigaction_SIGRTMAX");
-
     // units ignore SIGINT; only CC handles Ctrl+C and sends SIGTERM
     signal(SIGINT, SIG_IGN);
 
-    // RNG per process
-    srand((unsigned)(time(NULL) ^ (getpid() << 16)));
-
     if (CHECK_SYS_CALL_NONFATAL(ipc_attach(&ctx, ftok_path), "battleship:ipc_attach") == -1) {
         return 1;
     }
     g_ctx = &ctx;
     g_unit_id = unit_id;
+    lockstat_bind(ctx.S, ctx.sem_id, unit_id, "BS");
+    trace_bind(ctx.S, unit_id, "BS");
+    console_ring_redirect(ctx.S);
 
 
     // ensure registry entry is correct
@@ -369,6 +380,22 @@ int main(int argc, char **argv) {
 
     type = (unit_type_t)type_i;
     st = unit_stats_for_type(type);
+    unit_build_aproach_table(st.ba, g_aproach);
+
+    unit_private_t priv;
+    if (restore && unit_load_private(&ctx, unit_id, &priv)) {
+        st = priv.st;
+        order = (unit_order_t)priv.order;
+        have_target_pri = priv.have_target_pri;
+        have_target_sec = priv.have_target_sec;
+        primary_target = priv.target_pri;
+        secondary_target = priv.target_sec;
+        g_last_fired_tick = priv.last_fired_tick;
+        req_id_counter = priv.req_id;
+        for (int i = 0; i < MAX_UNITS; i++) underlings[i] = priv.underlings[i];
+        LOGI("[BS %u] restored state of tick %u: hp=%d order=%d bay=%d/%d",
+             unit_id, priv.tick, st.hp, order, st.fb.current, st.fb.capacity);
+    }
 
     // print_stats(unit_id, st);
 
@@ -381,16 +408,20 @@ int main(int argc, char **argv) {
 
         while (!g_stop) {
                 // wait for tick start
-        if (sem_wait_intr(ctx.sem_id, SEM_TICK_START, -1, &g_stop) == -1) {
+        // deterministic mode: wait for our own turn (CC runs units in id order)
+        unsigned short start_sem = ctx.S->deterministic ? SEM_UNIT_TURN(unit_id) : SEM_TICK_START;
+        if (sem_wait_intr(ctx.sem_id, start_sem, -1, &g_stop) == -1) {
             if (g_stop) break;
             continue;
         }
+        uint64_t tick_t0 = prof_now();
         
         if (sem_lock_intr(ctx.sem_id, SEM_GLOBAL_LOCK, &g_stop) == -1) {
             if (g_stop) break;
             HANDLE_SYS_ERROR_NONFATAL("battleship:sem_lock_intr", "Failed to acquire global lock");
             continue;
         }
+        prof_add(PROF_LOCK_WAIT, tick_t0);
         
         uint32_t t;
         uint8_t alive;
@@ -406,13 +437,14 @@ int main(int argc, char **argv) {
             break;
         }
 
-        if (g_damage_pending) {
-            g_damage_pending = 0;
+        if (ctx.S->units[unit_id].dmg_payload) {
             st_points_t old_hp = st.hp;
             compute_dmg_payload(&ctx, unit_id, &st);
             LOGD("[BS %d] damage received: hp %ld -> %ld", unit_id, old_hp, st.hp);
         }
 
+        ctx.S->units[unit_id].hp = st.hp;
+
         if (st.hp <= 0) {
             LOGD("[BS %d] mark as dead", unit_id);
             mark_dead(&ctx, unit_id);
@@ -429,7 +461,9 @@ int main(int argc, char **argv) {
             continue;
         }
         ctx.S->last_step_tick[unit_id] = t;
+        rng_seed(&g_rng, ctx.S->rng_seed, RNG_DOMAIN_UNIT, (uint32_t)unit_id, t);
 
+        uint64_t p0 = prof_now();
         mq_spawn_rep_t rep;
         while (mq_try_recv_reply(ctx.q_rep, &rep) == 1) {
             if (rep.status == 0) {
@@ -445,6 +479,7 @@ int main(int argc, char **argv) {
             }
         }
 
+        prof_add(PROF_MSG, p0);
         CHECK_SYS_CALL_NONFATAL(sem_unlock(ctx.sem_id, SEM_GLOBAL_LOCK), "battleship:sem_unlock_spawn");
         
         if (!alive) {
@@ -455,7 +490,9 @@ int main(int argc, char **argv) {
         // perform action based on current order
         LOGD("[BS %u] taking order | tick=%u pos=(%d,%d) order=%d",
              unit_id, t, cp.x, cp.y, order);
+        p0 = prof_now();
         if (sem_lock_intr(ctx.sem_id, SEM_GLOBAL_LOCK, &g_stop) == -1) break;
+        prof_add(PROF_LOCK_WAIT, p0);
         
         // perform action based on current order
         battleship_action(&ctx, unit_id, &st, &primary_target, &have_target_pri, &secondary_target, &have_target_sec);
@@ -471,7 +508,7 @@ int main(int argc, char **argv) {
             int16_t spawn_range = st.si + sq_stats.si + 1;
             
             point_t out;
-            radar_pick_random_point_in_circle(pos.x, pos.y, spawn_range, M, N, &out);
+            radar_pick_random_point_in_circle(pos.x, pos.y, spawn_range, M, N, &g_rng, &out);
             mq_spawn_req_t req = {
             .mtype = MSG_SPAWN,
             .sender = getpid(),
@@ -483,7 +520,9 @@ int main(int argc, char **argv) {
             .utype = st.fb.sq_types[st.fb.current],
             .req_id = ++req_id_counter
         };
-        mq_send_spawn(ctx.q_req, &req);
+        p0 = prof_now();
+        mq_send_spawn(ctx.q_spawn, &req);
+        prof_add(PROF_MSG, p0);
         LOGD("[BS %u] request to spawn squadron at (%d,%d)",
             unit_id, out.x, out.y);
         }
@@ -508,6 +547,27 @@ int main(int argc, char **argv) {
         // printf("[BS %d]pos x=%d y=%d\n",unit_id,nx,ny);
         // fflush(stdout);
 
+        // publish telemetry for UI (own seqlock, no global lock)
+        unit_publish_telemetry(&ctx, unit_id, type, t, &st, order,
+                               have_target_sec ? secondary_target : 0, g_last_fired_tick);
+
+        // private state for world snapshots (taken by CC between ticks)
+        priv = (unit_private_t){
+            .order = (uint8_t)order,
+            .have_target_pri = have_target_pri,
+            .have_target_sec = have_target_sec,
+            .target_pri = primary_target,
+            .target_sec = secondary_target,
+            .last_fired_tick = g_last_fired_tick,
+            .req_id = req_id_counter,
+            .st = st,
+        };
+        for (int i = 0; i < MAX_UNITS; i++) priv.underlings[i] = underlings[i];
+        unit_save_private(&ctx, unit_id, t, &priv);
+        prof_add(PROF_UNIT_TICK, tick_t0);
+        prof_publish(ctx.S, unit_id, t);
+        metrics_sync_log_drops();
+
                 // notify CC done
         if (CHECK_SYS_CALL_NONFATAL(sem_post_retry(ctx.sem_id, SEM_TICK_DONE, +1), 
                                      "battleship:sem_post_retry") == -1) {
@@ -12,15 +12,30 @@
 #include <fcntl.h>
 #include <errno.h>
 #include <pthread.h>
+#include <dirent.h>
+#include <sys/resource.h>
 
 #include "error_handler.h"
 #include "ipc/ipc_context.h"
 #include "ipc/semaphores.h"
 #include "ipc/shared.h"
 #include "ipc/ipc_mesq.h"
+#include "ipc/ui_frame.h"
+#include "ipc/telemetry.h"
+#include "ipc/phase_prof.h"
+#include "ipc/lockstat.h"
+#include "ipc/trace.h"
+#include "ipc/metrics.h"
+#include "ipc/console_ring.h"
+#include "CC/metrics_export.h"
+#include "CC/recorder.h"
+#include "CC/snapshot.h"
+#include "CC/grid_render.h"
 #include "CC/unit_ipc.h"
 #include "CC/unit_logic.h"
 #include "CC/unit_stats.h"
+#include "CC/unit_rng.h"
+#include "CC/world_hash.h"
 #include "CC/unit_size.h"
 #include "tee/terminal_tee.h"
 #include "CM/console_manager.h"
@@ -36,6 +51,18 @@
  *  - Spawn battleship worker processes and register them in shared state.
  *  - Drive a periodic "tick" barrier: on each tick CC posts SEM_TICK_START
  *    once per alive unit, then waits for SEM_TICK_DONE from each unit.
+ *  - Resolve combat after the barrier: fire intents posted by units are
+ *    turned into per-target damage in a single pass.
+ *  - --deterministic: run units one at a time in ascending id order so that
+ *    runs with the same seed produce identical per-tick state hashes
+ *    (<run_dir>/state_hash.bin, compare with skirmish-hashdiff).
+ *  - --record: write every tick to <run_dir>/battle.skrec as keyframes and
+ *    deltas (see ipc/recording.h), played back with `ui --replay`.
+ *  - CM "snapshot <file>" writes the world at the next tick boundary;
+ *    --restore <file> starts from such a file instead of the scenario
+ *    (see CC/snapshot.h).
+ *  - --shm posix [--shm-huge]: world segment in /dev/shm (or hugetlbfs)
+ *    instead of SysV shm (see ipc/shm_backend.h).
  *  - Handle shutdown: notify alive units with SIGTERM, reap children, and
  *    cleanup IPC objects and logs.
  */
@@ -46,6 +73,16 @@ static volatile int g_tick_speed_ms = 1000;  /* tick speed in milliseconds */
 static volatile int g_grid_enabled = 1;      /* grid display: 1 = ON, 0 = OFF */
 static pthread_mutex_t g_cm_mutex = PTHREAD_MUTEX_INITIALIZER;  /* protects g_frozen, g_tick_speed_ms, and g_grid_enabled */
 
+/* CM "snapshot": posted by the CM thread, written by the tick loop at the
+ * next tick boundary (protected by g_cm_mutex, completion on g_snap_cv) */
+static struct {
+    int pending;
+    char path[128];
+    int status;
+    char message[128];
+} g_snap;
+static pthread_cond_t g_snap_cv = PTHREAD_COND_INITIALIZER;
+
 /* Global paths for CM thread to access */
 static const char *g_battleship_path = "./battleship";
 static const char *g_squadron_path = "./squadron";
@@ -162,6 +199,46 @@ static uint16_t alloc_unit_id(ipc_ctx_t *ctx) {
     return id;   // 0 means "no free slot"
 }
 
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+/* Bytes written to process logs of the run (text .log / binary .blog, not the tee capture) */
+static uint64_t run_log_bytes(const char *run_dir) {
+    uint64_t total = 0;
+    DIR *d = opendir(run_dir);
+    if (!d) return 0;
+    struct dirent *de;
+    while ((de = readdir(d)) != NULL) {
+        size_t len = strlen(de->d_name);
+        int is_log = (len > 4 && !strcmp(de->d_name + len - 4, ".log")) ||
+                     (len > 5 && !strcmp(de->d_name + len - 5, ".blog"));
+        if (!is_log || !strcmp(de->d_name, "ALL.term.log")) continue;
+        char path[1024];
+        struct stat st;
+        snprintf(path, sizeof(path), "%s/%s", run_dir, de->d_name);
+        if (stat(path, &st) == 0) total += (uint64_t)st.st_size;
+    }
+    closedir(d);
+    return total;
+}
+
+/* CPU time (user + sys) of CC and all reaped children, in microseconds */
+static uint64_t cpu_us_self_and_children(void) {
+    struct rusage self, kids;
+    getrusage(RUSAGE_SELF, &self);
+    getrusage(RUSAGE_CHILDREN, &kids);
+    uint64_t us = 0;
+    const struct rusage *r[2] = { &self, &kids };
+    for (int i = 0; i < 2; i++) {
+        us += (uint64_t)r[i]->ru_utime.tv_sec * 1000000ull + (uint64_t)r[i]->ru_utime.tv_usec;
+        us += (uint64_t)r[i]->ru_stime.tv_sec * 1000000ull + (uint64_t)r[i]->ru_stime.tv_usec;
+    }
+    return us;
+}
+
 /* Register a unit in shared memory:
  *  - sets PID, faction, type, alive flag and position
  *  - attempts to place unit in grid if cell empty (warns if occupied)
@@ -177,6 +254,12 @@ static void register_unit(ipc_ctx_t *ctx, unit_id_t unit_id, pid_t pid,
     ctx->S->units[unit_id].type = (uint8_t)type;
     ctx->S->units[unit_id].alive = 1;
     ctx->S->units[unit_id].position = pos;
+    ctx->S->units[unit_id].dmg_payload = 0;
+    ctx->S->orders[unit_id] = (order_slot_t){0};
+    ctx->S->priv[unit_id] = (unit_private_t){0};    // a restore starts this unit fresh
+    telemetry_reset(ctx->S, unit_id);
+    prof_reset(ctx->S, unit_id);
+    ctx->S->units[unit_id].hp = unit_stats_for_type(type).hp;
 
     // Place unit on grid using size mechanic
     unit_stats_t stats = unit_stats_for_type(type);
@@ -187,14 +270,12 @@ static void register_unit(ipc_ctx_t *ctx, unit_id_t unit_id, pid_t pid,
     // sem_unlock(ctx->sem_id, SEM_GLOBAL_LOCK);
 }
 
-/* Spawn a battleship process:
- *  - fork + execl; child execs the battleship binary with args.
- *  - parent registers the unit and returns child pid (or -1 on error).
- */
-static pid_t spawn_unit(ipc_ctx_t *ctx, const char *exe_path,
-                              unit_id_t unit_id, faction_t faction,
-                              unit_type_t type, point_t pos,
-                              const char *ftok_path, unit_id_t commander_id)
+/* fork + execl of a unit binary with its args; restore != 0 adds
+ * --restore (the unit continues from its S->priv slot). Returns the child
+ * pid or -1. */
+static pid_t fork_unit(const char *exe_path, unit_id_t unit_id, faction_t faction,
+                       unit_type_t type, point_t pos, const char *ftok_path,
+                       unit_id_t commander_id, int restore)
 {
     pid_t pid = CHECK_SYS_CALL_NONFATAL(fork(), "spawn_unit:fork");
     if (pid == -1) {
@@ -219,12 +300,28 @@ static pid_t spawn_unit(ipc_ctx_t *ctx, const char *exe_path,
               "--x", x_s,
               "--y", y_s,
               "--commander", commander_s,
+              restore ? "--restore" : NULL,
             NULL);
         /* execl only returns on error */
         HANDLE_SYS_ERROR("spawn_unit:execl", "Failed to exec unit binary");
         _exit(1);
     }
+    return pid;
+}
+
+/* Spawn a battleship process:
+ *  - fork + execl; child execs the battleship binary with args.
+ *  - parent registers the unit and returns child pid (or -1 on error).
+ */
+static pid_t spawn_unit(ipc_ctx_t *ctx, const char *exe_path,
+                              unit_id_t unit_id, faction_t faction,
+                              unit_type_t type, point_t pos,
+                              const char *ftok_path, unit_id_t commander_id)
+{
+    pid_t pid = fork_unit(exe_path, unit_id, faction, type, pos, ftok_path, commander_id, 0);
+    if (pid == -1) return -1;
     register_unit(ctx, unit_id, pid, faction, type, pos);
+    metric_inc(MET_SPAWNS);
     LOGD("[CC] spawned unit_id=%u pid=%d type=%u faction=%u at (%d,%d)",
             unit_id, (int)pid, (unsigned)type, (unsigned)faction, pos.x, pos.y);
     return pid;
@@ -328,43 +425,13 @@ static void cleanup_dead_units(ipc_ctx_t *ctx) {
     }
 }
 
-void print_grid(ipc_ctx_t *ctx) {
-    // Print grid
-        sem_lock(ctx->sem_id, SEM_GLOBAL_LOCK);
-        printf("\n\t");
-        for (int i = 0; i < M; i++) printf("%d", i % 10);
-        printf("\n");
-        for (int i = 0; i < N; i++) {
-            printf("%d\t", i);
-            for (int j = 0; j < M; j++) {
-                int16_t t = ctx->S->grid[j][i];
-                if (t == OBSTACLE_MARKER) {
-                    printf("\x1b[90m#\x1b[0m");  // Gray obstacle
-                } else if (t == 0) {
-                    printf(".");
-                } else if (0 < t && t < MAX_UNITS)  {
-                    uint8_t faction = ctx->S->units[t].faction;
-                    const char *color = "\x1b[0m"; // default
-                    if (faction == FACTION_REPUBLIC) color = "\x1b[34m"; // blue
-                    else if (faction == FACTION_CIS) color = "\x1b[31m"; // red
-                    printf("%s%d\x1b[0m", color, t);
-                } else {
-                    printf(".");
-                }
-            }
-            printf("\n");
-        }
-        fflush(stdout);
-        sem_unlock(ctx->sem_id, SEM_GLOBAL_LOCK);
-}
-
 /* Handle CM (Console Manager) commands */
 static void handle_cm_command(ipc_ctx_t *ctx) {
     mq_cm_cmd_t cmd;
     mq_cm_rep_t response;
     
     /* Try to receive CM command (non-blocking) */
-    int ret = mq_try_recv_cm_cmd(ctx->q_req, &cmd);
+    int ret = mq_try_recv_cm_cmd(ctx->q_cmd, &cmd);
     
     if (ret <= 0) {
         return;  // No message or error
@@ -449,6 +516,60 @@ static void handle_cm_command(ipc_ctx_t *ctx) {
             pthread_mutex_unlock(&g_cm_mutex);
             break;
             
+        case CM_CMD_LOGLEVEL: {
+            /* levels live in shm: every process sees the change at its next log call */
+            if (cmd.log_level > LOG_LVL_ERROR || cmd.log_module >= LOG_MOD_COUNT) {
+                snprintf(response.message, sizeof(response.message),
+                         "Invalid log level %d / module %d", cmd.log_level, cmd.log_module);
+                response.status = -1;
+                break;
+            }
+            if (cmd.log_level >= 0) {
+                if (cmd.log_module < 0) log_set_level((log_level_t)cmd.log_level);
+                else log_set_module_level((log_module_t)cmd.log_module, (log_level_t)cmd.log_level);
+                LOGI("[CC] Log level of %s set to %s",
+                     cmd.log_module < 0 ? "all modules" : log_module_name((log_module_t)cmd.log_module),
+                     log_level_name((log_level_t)cmd.log_level));
+            }
+            int off = snprintf(response.message, sizeof(response.message), "Log levels:");
+            for (int m = 0; m < LOG_MOD_COUNT && off < (int)sizeof(response.message); m++) {
+                off += snprintf(response.message + off, sizeof(response.message) - off, " %s=%s",
+                                log_module_name((log_module_t)m),
+                                log_level_name(log_get_module_level((log_module_t)m)));
+            }
+            break;
+        }
+
+        case CM_CMD_SNAPSHOT:
+            /* written by the tick loop at the next tick boundary (all units idle) */
+            pthread_mutex_lock(&g_cm_mutex);
+            if (g_snap.pending) {
+                pthread_mutex_unlock(&g_cm_mutex);
+                snprintf(response.message, sizeof(response.message), "Snapshot already in progress");
+                response.status = -1;
+                break;
+            }
+            cmd.path[sizeof(cmd.path) - 1] = '\0';
+            memcpy(g_snap.path, cmd.path, sizeof(g_snap.path));
+            g_snap.pending = 1;
+            while (g_snap.pending && !g_stop) {
+                struct timespec dl;
+                clock_gettime(CLOCK_REALTIME, &dl);
+                dl.tv_nsec += 200 * 1000000L;
+                if (dl.tv_nsec >= 1000000000L) { dl.tv_sec++; dl.tv_nsec -= 1000000000L; }
+                pthread_cond_timedwait(&g_snap_cv, &g_cm_mutex, &dl);
+            }
+            if (g_snap.pending) {
+                g_snap.pending = 0;
+                snprintf(response.message, sizeof(response.message), "Snapshot cancelled (shutdown)");
+                response.status = -1;
+            } else {
+                response.status = g_snap.status;
+                memcpy(response.message, g_snap.message, sizeof(response.message));
+            }
+            pthread_mutex_unlock(&g_cm_mutex);
+            break;
+
         case CM_CMD_END:
             snprintf(response.message, sizeof(response.message),
                      "Shutdown initiated");
@@ -470,6 +591,35 @@ static void handle_cm_command(ipc_ctx_t *ctx) {
     }
 }
 
+/* Write a snapshot requested by the CM thread, if any. Called by the tick
+ * loop right after taking SEM_GLOBAL_LOCK, when every unit is idle. */
+static void snapshot_service(ipc_ctx_t *ctx, const char *scenario) {
+    pthread_mutex_lock(&g_cm_mutex);
+    int pending = g_snap.pending;
+    pthread_mutex_unlock(&g_cm_mutex);
+    if (!pending) return;
+
+    uint64_t t0 = now_ns();
+    int64_t bytes = snapshot_write(ctx->S, scenario, g_snap.path);
+    double ms = (double)(now_ns() - t0) / 1e6;
+
+    pthread_mutex_lock(&g_cm_mutex);
+    if (bytes < 0) {
+        g_snap.status = -1;
+        snprintf(g_snap.message, sizeof(g_snap.message), "Snapshot failed: %s", strerror(errno));
+        LOGE("[CC] %s: %s", g_snap.message, g_snap.path);
+    } else {
+        g_snap.status = 0;
+        snprintf(g_snap.message, sizeof(g_snap.message), "Snapshot of tick %u (%u units, %lld bytes) in %.1f ms",
+                 ctx->S->ticks, (unsigned)ctx->S->unit_count, (long long)bytes, ms);
+        LOGI("[CC] %s: %s", g_snap.message, g_snap.path);
+        printf("[CC] %s: %s\n", g_snap.message, g_snap.path);
+    }
+    g_snap.pending = 0;
+    pthread_cond_broadcast(&g_snap_cv);
+    pthread_mutex_unlock(&g_cm_mutex);
+}
+
 /* CM thread function - runs independently to handle console manager commands */
 static void* cm_thread_func(void* arg) {
     ipc_ctx_t *ctx = (ipc_ctx_t*)arg;
@@ -479,17 +629,7 @@ static void* cm_thread_func(void* arg) {
     while (!g_stop) {
         handle_cm_command(ctx);
         
-        /* Handle UI map requests */
-        mq_ui_map_req_t ui_req;
-        while (mq_try_recv_ui_map_req(ctx->q_req, &ui_req) == 1) {
-            /* Send current grid snapshot to UI - UI will read from shared memory */
-            mq_ui_map_rep_t ui_rep;
-            ui_rep.mtype = ui_req.sender;  // Reply to UI's pid
-            ui_rep.tick = ctx->S->ticks;
-            ui_rep.ready = 1;
-            
-            mq_send_ui_map_rep(ctx->q_rep, &ui_rep);
-        }
+        /* UI reads frames published at the end of each tick (ui_frame_publish) */
         
         /* Small sleep to avoid busy-waiting */
         //usleep(10000);  /* 10ms */
@@ -507,12 +647,44 @@ int main(int argc, char **argv) {
     const char *battleship = "./battleship";
     const char *squadron = "./squadron";
     const char *scenario_name = NULL;
+    const char *seed_arg = NULL;
+    int deterministic = 0;
+    int log_binary = 0;
+    int phase_csv = 0;
+    int lockstat = 0;
+    int trace = 0;
+    int metrics_file = 0;
+    const char *metrics_sock = NULL;
+    int metrics_every = 10;
+    int console_direct = 0;
+    int grid_keyframe = 20;
+    int record = 0;
+    int record_keyframe = 50;
+    const char *restore_path = NULL;
+    const char *shm_arg = "sysv";
+    int shm_huge = 0;
 
     for (int i=1; i<argc;i++) {
         if (!strcmp(argv[i], "--ftok") && i+1<argc) ftok_path = argv[++i];
         else if (!strcmp(argv[i], "--battleship") && i+1<argc) battleship = argv[++i];
         else if (!strcmp(argv[i], "--squadron") && i+1<argc) squadron = argv[++i];
         else if (!strcmp(argv[i], "--scenario") && i+1<argc) scenario_name = argv[++i];
+        else if (!strcmp(argv[i], "--seed") && i+1<argc) seed_arg = argv[++i];
+        else if (!strcmp(argv[i], "--deterministic")) deterministic = 1;
+        else if (!strcmp(argv[i], "--log-binary")) log_binary = 1;
+        else if (!strcmp(argv[i], "--phase-csv")) phase_csv = 1;
+        else if (!strcmp(argv[i], "--lockstat")) lockstat = 1;
+        else if (!strcmp(argv[i], "--trace")) trace = 1;
+        else if (!strcmp(argv[i], "--metrics")) metrics_file = 1;
+        else if (!strcmp(argv[i], "--metrics-socket") && i+1<argc) metrics_sock = argv[++i];
+        else if (!strcmp(argv[i], "--metrics-every") && i+1<argc) metrics_every = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--console-direct")) console_direct = 1;
+        else if (!strcmp(argv[i], "--grid-keyframe") && i+1<argc) grid_keyframe = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--record")) record = 1;
+        else if (!strcmp(argv[i], "--record-keyframe") && i+1<argc) record_keyframe = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--restore") && i+1<argc) restore_path = argv[++i];
+        else if (!strcmp(argv[i], "--shm") && i+1<argc) shm_arg = argv[++i];
+        else if (!strcmp(argv[i], "--shm-huge")) shm_huge = 1;
     }
     
     /* Check that only one CC instance is running */
@@ -534,16 +706,32 @@ int main(int argc, char **argv) {
     sigaction(SIGINT, &sa, NULL);
     sigaction(SIGTERM, &sa, NULL);
 
+    /* world segment backend; units, UI and CM find it on attach */
+    if (strcmp(shm_arg, "sysv") != 0 && strcmp(shm_arg, "posix") != 0) {
+        fprintf(stderr, "[CC] --shm must be sysv or posix\n");
+        return 1;
+    }
+    if (shm_huge && strcmp(shm_arg, "posix") != 0) {
+        fprintf(stderr, "[CC] --shm-huge needs --shm posix\n");
+        return 1;
+    }
+    ipc_set_shm_backend(strcmp(shm_arg, "posix") == 0 ? IPC_SHM_POSIX : IPC_SHM_SYSV, shm_huge);
+
     ipc_ctx_t ctx;
     if (ipc_create(&ctx, ftok_path) == -1) {
         HANDLE_SYS_ERROR("main:ipc_create", "Failed to create IPC objects");
         return 1;
     }
+    /* lock contention profiler: units bind their slots when they attach */
+    if (lockstat) ctx.S->lockstat.enabled = 1;
+    lockstat_bind(ctx.S, ctx.sem_id, 0, "CC");
 
     /* Prepare run directory and tee to capture terminal output into run logs */
     char run_dir[512];
     make_run_dir(run_dir, sizeof(run_dir));
     setenv("SKIRMISH_RUN_DIR", run_dir, 1);
+    /* binary logs for CC and every unit it spawns (expand with skirmish-logcat) */
+    if (log_binary) setenv("SKIRMISH_LOG_FORMAT", "binary", 1);
 
 
     
@@ -559,15 +747,42 @@ int main(int argc, char **argv) {
         close(tee_pipe);  // Close original fd after dup2
     }
 
+    /* console output of CC and units goes through the shm ring; the forwarder
+     * writes it to the tee, so a slow tee/UI drops lines instead of stalling ticks */
+    if (!console_direct) {
+        if (console_forwarder_start(ctx.S, STDOUT_FILENO) == -1) {
+            perror("[CC] console forwarder");
+        } else {
+            console_ring_redirect(ctx.S);
+        }
+    }
+
     if (log_init("CC", 0) == -1) {
         fprintf(stderr, "[CC] log_init failed, continuing without logs\n");
     }
     atexit(log_close);
 
     
-    /* Load scenario */
+    /* Load scenario (--restore: only its name and seed, the world comes from the snapshot) */
     scenario_t scenario;
-    if (scenario_name) {
+    snapshot_t snap;
+    uint64_t restore_t0 = now_ns();
+    if (restore_path) {
+        if (snapshot_map(restore_path, &snap) == -1) {
+            fprintf(stderr, "[CC] Cannot restore from %s: %s\n", restore_path,
+                    errno == EINVAL ? "not a snapshot of this build" : strerror(errno));
+            ipc_detach(&ctx);
+            ipc_destroy(&ctx);
+            return 1;
+        }
+        scenario_default(&scenario);
+        strncpy(scenario.name, snap.h->scenario, sizeof(scenario.name) - 1);
+        scenario.name[sizeof(scenario.name) - 1] = '\0';
+        scenario.seed = snap.h->seed;
+        scenario.obstacle_count = 0;
+        scenario.unit_count = 0;
+        seed_arg = NULL;    // the seed is part of the snapshot's RNG state
+    } else if (scenario_name) {
         char scenario_path[256];
         snprintf(scenario_path, sizeof(scenario_path), "scenarios/%s.conf", scenario_name);
         if (scenario_load(scenario_path, &scenario) != 0) {
@@ -580,8 +795,21 @@ int main(int argc, char **argv) {
         scenario_default(&scenario);
     }
     
+    /* RNG seed: --seed overrides scenario; 0 means pick one (printed so the run can be replayed) */
+    if (seed_arg) scenario.seed = strtoull(seed_arg, NULL, 0);
+    if (scenario.seed == 0 && deterministic) {
+        scenario.seed = 1;  // deterministic runs must not depend on wall clock
+    }
+    if (scenario.seed == 0) {
+        struct timespec ts;
+        clock_gettime(CLOCK_REALTIME, &ts);
+        scenario.seed = rng_mix64(((uint64_t)ts.tv_sec << 32) ^ (uint64_t)ts.tv_nsec ^ (uint64_t)getpid());
+    }
+    LOGI("[CC] rng seed=%llu", (unsigned long long)scenario.seed);
+    printf("[CC] rng seed=%llu\n", (unsigned long long)scenario.seed);
+
     /* Generate placements if needed */
-    if (scenario.unit_count == 0) {
+    if (scenario.unit_count == 0 && !restore_path) {
         scenario_generate_placements(&scenario);
     }
     
@@ -592,6 +820,75 @@ int main(int argc, char **argv) {
         return 1;
     }
     
+    ctx.S->rng_seed = scenario.seed;
+    ctx.S->deterministic = (uint8_t)deterministic;
+    if (deterministic) {
+        LOGI("[CC] deterministic mode: units run in ascending id order");
+        printf("[CC] deterministic mode: units run in ascending id order\n");
+    }
+
+    /* per-tick state hash log (binary, see world_hash.h) */
+    char hash_path[600];
+    snprintf(hash_path, sizeof(hash_path), "%s/state_hash.bin", run_dir);
+    FILE *hash_log = fopen(hash_path, "wb");
+    if (!hash_log) {
+        HANDLE_SYS_ERROR_NONFATAL("main:fopen_state_hash", "Failed to open state hash log");
+    } else {
+        hash_log_header_t hh;
+        memcpy(hh.magic, HASH_LOG_MAGIC, sizeof(hh.magic));
+        hh.seed = scenario.seed;
+        fwrite(&hh, sizeof(hh), 1, hash_log);
+    }
+
+    /* optional per-tick phase statistics (see ipc/phase_prof.h) */
+    FILE *prof_csv = NULL;
+    if (phase_csv) {
+        char csv_path[600];
+        snprintf(csv_path, sizeof(csv_path), "%s/phases.csv", run_dir);
+        prof_csv = fopen(csv_path, "w");
+        if (!prof_csv) HANDLE_SYS_ERROR_NONFATAL("main:fopen_phases_csv", "Failed to open phase CSV");
+        else prof_csv_header(prof_csv);
+    }
+
+    /* optional tick timeline of all processes (see ipc/trace.h) */
+    char trace_path[600];
+    snprintf(trace_path, sizeof(trace_path), "%s/trace.json", run_dir);
+    if (trace) {
+        if (trace_export_open(trace_path) == -1) {
+            HANDLE_SYS_ERROR_NONFATAL("main:fopen_trace_json", "Failed to open trace JSON");
+        } else {
+            ctx.S->trace.enabled = 1;
+            trace_bind(ctx.S, 0, "CC");
+        }
+    }
+
+    /* optional Prometheus metrics: <run_dir>/metrics.prom and/or a Unix socket */
+    int metrics = 0;
+    if (metrics_file || metrics_sock) {
+        char prom_path[600];
+        snprintf(prom_path, sizeof(prom_path), "%s/metrics.prom", run_dir);
+        if (metrics_every < 1) metrics_every = 1;
+        if (metrics_export_open(metrics_file ? prom_path : NULL, metrics_sock) == -1) {
+            HANDLE_SYS_ERROR_NONFATAL("main:metrics_export_open", "Failed to open metrics output");
+        } else {
+            ctx.S->metrics.enabled = 1;
+            metrics_bind(&ctx.S->metrics);
+            metrics = 1;
+            metrics_export(&ctx, 0);
+        }
+    }
+
+    /* optional battle recording, written by its own thread */
+    char rec_path[600];
+    snprintf(rec_path, sizeof(rec_path), "%s/battle.skrec", run_dir);
+    if (record) {
+        if (record_keyframe < 1) record_keyframe = 1;
+        if (recorder_open(rec_path, scenario.name, scenario.seed, record_keyframe) == -1) {
+            HANDLE_SYS_ERROR_NONFATAL("main:recorder_open", "Failed to open battle recording");
+            record = 0;
+        }
+    }
+
     /* Place obstacles on grid */
     for (int i = 0; i < scenario.obstacle_count; i++) {
         int x = scenario.obstacles[i].x;
@@ -639,13 +936,54 @@ int main(int argc, char **argv) {
         }
     }
 
+    /* Restore: world from the snapshot, then every alive unit in one pass;
+     * each continues from its S->priv slot (--restore) */
+    if (restore_path) {
+        snapshot_restore(ctx.S, &snap);
+        for (int id = 1; id <= MAX_UNITS; id++) {
+            unit_entity_t *e = &ctx.S->units[id];
+            if (!e->alive) continue;
+            const char *exe_path = (e->type == TYPE_FIGHTER || e->type == TYPE_BOMBER || e->type == TYPE_ELITE)
+                                   ? squadron : battleship;
+            pid_t pid = fork_unit(exe_path, (unit_id_t)id, e->faction, e->type, e->position,
+                                  ftok_path, ctx.S->priv[id].commander, 1);
+            if (pid > 0) {
+                e->pid = pid;
+                spawned_count++;
+            } else {
+                LOGE("[CC] Failed to respawn unit %d", id);
+            }
+        }
+        double ms = (double)(now_ns() - restore_t0) / 1e6;
+        LOGI("[CC] restored tick %u from %s: %d units, %zu bytes mapped in %.1f ms",
+             ctx.S->ticks, restore_path, spawned_count, snap.len, ms);
+        printf("[CC] restored tick %u from %s: %d units, %zu bytes mapped in %.1f ms\n",
+               ctx.S->ticks, restore_path, spawned_count, snap.len, ms);
+        snapshot_unmap(&snap);
+    }
+
+    /* initial full hash; afterwards only dirty columns / changed units are rehashed */
+    static world_hash_t world_hash;
+    world_hash_init(&world_hash, ctx.S);
+    uint64_t tick_work_ns = 0, hash_ns = 0;
+    static combat_hit_t hit_log[MAX_FIRE_INTENTS];  // hits of the tick, for the recording
+
     sem_unlock(ctx.sem_id, SEM_GLOBAL_LOCK);
 
+    if (ctx.shm_backend == IPC_SHM_POSIX) {
+        LOGI("[CC] world segment %s: %zu bytes, %s pages", ctx.shm.path, ctx.shm.len, shm_pages_name(ctx.shm.pages));
+        printf("[CC] world segment %s: %zu bytes, %s pages\n", ctx.shm.path, ctx.shm.len, shm_pages_name(ctx.shm.pages));
+    }
     LOGI("[CC] shm_id=%d sem_id=%d spawned %d units from scenario '%s'. Ctrl+C to stop.",
          ctx.shm_id, ctx.sem_id, spawned_count, scenario.name);
     printf("[CC] shm_id=%d sem_id=%d spawned %d units from scenario '%s'. Ctrl+C to stop.\n",
            ctx.shm_id, ctx.sem_id, spawned_count, scenario.name);
 
+    /* grid display: snapshots from the tick loop, printed by the render thread */
+    if (grid_render_start(grid_keyframe) == -1)
+        HANDLE_SYS_ERROR_NONFATAL("main:grid_render_start", "Failed to start grid renderer");
+    int grid_shown = 0;
+
     /* Start CM handler thread */
     pthread_t cm_thread;
     int thread_ret = pthread_create(&cm_thread, NULL, cm_thread_func, &ctx);
@@ -681,11 +1019,15 @@ int main(int argc, char **argv) {
         }
         
         if (g_stop) break;  // Check immediately after sleep
+        uint64_t tick_t0 = now_ns();
 
         if (sem_lock_intr(ctx.sem_id, SEM_GLOBAL_LOCK, &g_stop) == -1) break;
+        prof_add(PROF_CC_LOCK_WAIT, tick_t0);
+        snapshot_service(&ctx, scenario.name);
 
+        uint64_t p0 = prof_now();
         mq_spawn_req_t r;
-        while (mq_try_recv_spawn(ctx.q_req, &r) == 1) {
+        while (mq_try_recv_spawn(ctx.q_spawn, &r) == 1) {
             
             /* Determine if this is from BS (has sender_id) or CM (sender_id == 0) */
             int is_from_cm = (r.sender_id == 0);
@@ -770,6 +1112,7 @@ send_spawn_reply:
             mq_send_reply(ctx.q_rep, &rep);
 
         }
+        prof_add(PROF_CC_SPAWN, p0);
 
         /* Skip tick processing if frozen */
         pthread_mutex_lock(&g_cm_mutex);
@@ -796,9 +1139,31 @@ send_spawn_reply:
         ctx.S->tick_expected = alive;
         ctx.S->tick_done = 0;
 
+        /* deterministic mode: fixed execution order = ascending unit id */
+        unit_id_t turn_order[MAX_UNITS];
+        int turn_n = 0;
+        if (deterministic) {
+            for (int id=1; id<=MAX_UNITS; id++) if (ctx.S->units[id].alive) turn_order[turn_n++] = (unit_id_t)id;
+        }
+
         sem_unlock(ctx.sem_id, SEM_GLOBAL_LOCK);
+
+        uint64_t barrier_t0 = prof_now();
+        if (deterministic) {
+            /* one unit at a time: post its turn, wait for its DONE */
+            for (int i=0; i<turn_n && !g_stop; i++) {
+                if (sem_post_retry(ctx.sem_id, SEM_UNIT_TURN(turn_order[i]), +1) == -1) {
+                    LOGE("[CC] sem_post_retry(UNIT_TURN %d) failed: %s", turn_order[i], strerror(errno));
+                    g_stop = 1;
+                    break;
+                }
+                if (sem_wait_intr(ctx.sem_id, SEM_TICK_DONE, -1, &g_stop) == -1) break;
+            }
+        }
+        unsigned barrier_n = deterministic ? 0 : alive;  // deterministic: already collected
+
                 /* release exactly one start permit per alive unit */
-        for (unsigned i=0; i<alive; i++) {
+        for (unsigned i=0; i<barrier_n; i++) {
             if (sem_post_retry(ctx.sem_id, SEM_TICK_START, +1) == -1) {
                 LOGE("[CC] sem_post_retry(TICK_START) failed: %s", strerror(errno));
                 perror("sem_post_retry(TICK_START)");
@@ -807,7 +1172,7 @@ send_spawn_reply:
             }
         }
         /* wait for all alive units to report done (cooperative interrupt via g_stop) */
-        for (unsigned i=0; i<alive; i++) {
+        for (unsigned i=0; i<barrier_n; i++) {
             if (sem_wait_intr(ctx.sem_id, SEM_TICK_DONE, -1, &g_stop) == -1) {
                 if (g_stop) {
                     LOGW("[CC] sem_wait_intr interrupted by stop signal");
@@ -821,13 +1186,67 @@ send_spawn_reply:
         }
         // printf("[CC] got all\n");
         //             fflush(stdout);
+        prof_add(PROF_CC_BARRIER, barrier_t0);
+
+        /* Combat phase: resolve all fire intents posted this tick in one pass;
+         * victims consume their dmg_payload at the start of next tick. */
+        int hits = 0;
+        p0 = prof_now();
+        if (sem_lock_intr(ctx.sem_id, SEM_GLOBAL_LOCK, &g_stop) == 0) {
+            prof_add(PROF_CC_LOCK_WAIT, p0);
+            p0 = prof_now();
+            hits = resolve_fire_intents(&ctx, record ? hit_log : NULL, MAX_FIRE_INTENTS);
+            sem_unlock(ctx.sem_id, SEM_GLOBAL_LOCK);
+            metric_add(MET_DAMAGE_EVENTS, (uint64_t)hits);
+            prof_add(PROF_CC_COMBAT, p0);
+            LOGD("[CC] combat resolved: %d hits", hits);
+        }
 
-        if (g_grid_enabled)
-            print_grid(&ctx);
+        if (g_grid_enabled) {
+            p0 = prof_now();
+            if (sem_lock_intr(ctx.sem_id, SEM_GLOBAL_LOCK, &g_stop) == 0) {
+                grid_render_snapshot(ctx.S);
+                sem_unlock(ctx.sem_id, SEM_GLOBAL_LOCK);
+                grid_shown = 1;
+            }
+            prof_add(PROF_CC_PRINT_GRID, p0);
+        } else if (grid_shown) {
+            grid_render_pause();
+            grid_shown = 0;
+        }
 
+        p0 = prof_now();
         cleanup_dead_units(&ctx);
+        prof_add(PROF_CC_CLEANUP, p0);
+
+        p0 = prof_now();
+        if (sem_lock_intr(ctx.sem_id, SEM_GLOBAL_LOCK, &g_stop) == 0) {
+            prof_add(PROF_CC_LOCK_WAIT, p0);
+            p0 = prof_now();
+            ui_frame_publish(ctx.S);   // before the hash update clears grid_dirty
+            if (record) recorder_capture(ctx.S, hit_log, hits);
+            uint64_t hash_t0 = now_ns();
+            uint64_t h = world_hash_update(&world_hash, ctx.S);
+            hash_ns += now_ns() - hash_t0;
+            sem_unlock(ctx.sem_id, SEM_GLOBAL_LOCK);
+            prof_add(PROF_CC_FRAME, p0);
+            LOGD("[CC] tick=%u state_hash=%016llx cols=%u units=%u", t, (unsigned long long)h,
+                 world_hash.cols_rehashed, world_hash.units_rehashed);
+            if (hash_log) {
+                hash_log_rec_t rec = { .tick = t, .hash = h };
+                fwrite(&rec, sizeof(rec), 1, hash_log);
+            }
+        }
+        tick_work_ns += now_ns() - tick_t0;
 
-        /* UI requests are handled by CM thread, no need to push snapshots */
+        /* phase statistics: CC's own slot, then all slots of this tick */
+        prof_add(PROF_CC_TICK, tick_t0);
+        prof_publish(ctx.S, 0, t);
+        prof_aggregate(ctx.S, t);
+        if (prof_csv) prof_csv_rows(prof_csv, &ctx.S->prof_summary);
+        trace_export_tick(ctx.S, t);
+
+        /* UI frame was published above, together with the world hash */
         
         if ((t % 1) == 0) {
             LOGI("ticks=%u alive_units=%u", t, alive);
@@ -845,6 +1264,15 @@ send_spawn_reply:
             if (ctx.S->units[id].faction == FACTION_REPUBLIC) c_r++;
             else if (ctx.S->units[id].faction == FACTION_CIS) c_s++;
         }
+
+        /* metrics registry: CC's own counters, export every metrics_every ticks */
+        if (metrics) {
+            metric_inc(MET_TICKS);
+            metric_set(MET_ALIVE_REPUBLIC, (uint64_t)c_r);
+            metric_set(MET_ALIVE_CIS, (uint64_t)c_s);
+            metrics_sync_log_drops();
+            if (t % (uint32_t)metrics_every == 0) metrics_export(&ctx, t);
+        }
         if ((c_r == 0 || c_s == 0) && 0) {
             LOGI("Faction elimination detected: Republic=%d CIS=%d", c_r, c_s);
             printf("[CC] Faction elimination detected: Republic=%d CIS=%d\n", c_r, c_s);
@@ -853,6 +1281,47 @@ send_spawn_reply:
 
     }
 
+    uint64_t grid_frames, grid_keys, grid_bytes;
+    grid_render_stop(&grid_frames, &grid_keys, &grid_bytes);
+    if (grid_frames > 0) {
+        LOGI("[CC] grid: %llu frames (%llu keyframes), %.0f bytes/frame",
+             (unsigned long long)grid_frames, (unsigned long long)grid_keys,
+             (double)grid_bytes / (double)grid_frames);
+        printf("[CC] grid: %llu frames (%llu keyframes), %.0f bytes/frame\n",
+               (unsigned long long)grid_frames, (unsigned long long)grid_keys,
+               (double)grid_bytes / (double)grid_frames);
+    }
+
+    if (record) {
+        uint64_t rec_ticks, rec_bytes, rec_stalls;
+        recorder_close(&rec_ticks, &rec_bytes, &rec_stalls);
+        LOGI("[CC] record: %s (%llu ticks, %llu bytes, %llu writer stalls)", rec_path,
+             (unsigned long long)rec_ticks, (unsigned long long)rec_bytes, (unsigned long long)rec_stalls);
+        printf("[CC] record: %s (%llu ticks, %llu bytes)\n", rec_path,
+               (unsigned long long)rec_ticks, (unsigned long long)rec_bytes);
+    }
+
+    if (hash_log) fclose(hash_log);
+    if (prof_csv) fclose(prof_csv);
+    if (tick_work_ns > 0) {
+        LOGI("[CC] world hash cost: %.3f ms total, %.3f%% of tick work",
+             (double)hash_ns / 1e6, 100.0 * (double)hash_ns / (double)tick_work_ns);
+        printf("[CC] world hash cost: %.3f ms total, %.3f%% of tick work\n",
+               (double)hash_ns / 1e6, 100.0 * (double)hash_ns / (double)tick_work_ns);
+    }
+    if (ctx.S->ticks > 0) {
+        uint32_t total = 0;
+        printf("[CC] msgsnd per tick:");
+        for (int c = 0; c < MQ_COUNT; c++) {
+            const mq_stats_t *q = &ctx.S->mq_stats[c];
+            total += q->sent;
+            printf(" %s=%.2f", ipc_queue_name(c), (double)q->sent / ctx.S->ticks);
+            LOGI("[CC] queue %s: sent=%u received=%u send_fail=%u depth_max=%u",
+                 ipc_queue_name(c), q->sent, q->received, q->send_fail, q->depth_max);
+        }
+        printf(" total=%.2f\n", (double)total / ctx.S->ticks);
+    }
+
     /* Wait for CM thread to finish */
     if (thread_ret == 0) {
         LOGI("[CC] Waiting for CM thread to finish...");
@@ -935,6 +1404,46 @@ send_spawn_reply:
 
     LOGI("[CC] reaped %d children total", waited);
     printf("[CC] reaped %d children total\n", waited);
+
+    if (metrics) {
+        metrics_export(&ctx, ctx.S->ticks);
+        metrics_export_close();
+    }
+    if (trace) {
+        uint64_t spans = 0, dropped = 0;
+        trace_export_close(ctx.S, ctx.S->ticks, &spans, &dropped);
+        printf("[CC] trace: %s (%llu spans, %llu dropped)\n", trace_path,
+               (unsigned long long)spans, (unsigned long long)dropped);
+    }
+
+    /* lock contention profile: every unit has released the lock for good */
+    if (lockstat) {
+        char ls_path[600];
+        snprintf(ls_path, sizeof(ls_path), "%s/lockstat.bin", run_dir);
+        if (lockstat_dump(ctx.S, ls_path) == -1) {
+            LOGE("[CC] lockstat dump to %s failed: %s", ls_path, strerror(errno));
+        } else {
+            printf("[CC] lock profile: %s (skirmish-lockstat %s)\n", ls_path, run_dir);
+        }
+    }
+
+    /* logging cost of the run: units have flushed their logs by now */
+    if (ctx.S->ticks > 0) {
+        double ticks = (double)ctx.S->ticks;
+        LOGI("[CC] log: %s, %.0f bytes/tick, CPU %.0f us/tick (CC + units)",
+             log_binary ? "binary" : "text", (double)run_log_bytes(run_dir) / ticks,
+             (double)cpu_us_self_and_children() / ticks);
+        printf("[CC] log: %s, %.0f bytes/tick, CPU %.0f us/tick (CC + units)\n",
+               log_binary ? "binary" : "text", (double)run_log_bytes(run_dir) / ticks,
+               (double)cpu_us_self_and_children() / ticks);
+    }
+    if (ctx.S->console.enabled) {
+        printf("[CC] console: %llu chunks dropped\n",
+               (unsigned long long)__atomic_load_n(&ctx.S->console.dropped, __ATOMIC_RELAXED));
+        if (console_forwarder_stop(ctx.S, 2000) == -1)
+            LOGW("[CC] console forwarder did not finish in time");
+        console_ring_restore();
+    }
     fflush(stdout);    fflush(stderr);
     
     // Close stdout/stderr to send EOF to tee worker
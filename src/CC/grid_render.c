@@ -0,0 +1,279 @@
+#define _GNU_SOURCE
+#include "CC/grid_render.h"
+#include "tee/terminal_tee.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/* first screen column of grid cell 0: "%d\t" row label, tab stops every 8 */
+#define GRID_COL0 9
+
+#define CELL_EMPTY 0
+#define CELL_OBSTACLE 1
+
+void grid_snap_take(grid_snap_t *g, const shm_state_t *S) {
+    for (int y = 0; y < N; y++) {
+        for (int x = 0; x < M; x++) {
+            int16_t t = S->grid[x][y];
+            uint16_t c = CELL_EMPTY;
+            if (t == OBSTACLE_MARKER) c = CELL_OBSTACLE;
+            else if (0 < t && t < MAX_UNITS) c = (uint16_t)(2 + t * 4 + (S->units[t].faction & 3));
+            g->cell[y][x] = c;
+        }
+    }
+}
+
+/* Text of one cell (same colors as the old print_grid). Returns the byte
+ * count, *width gets the screen columns it takes. */
+static size_t cell_text(uint16_t c, char *out, int *width) {
+    if (c == CELL_EMPTY) {
+        out[0] = '.';
+        *width = 1;
+        return 1;
+    }
+    if (c == CELL_OBSTACLE) {
+        memcpy(out, "\x1b[90m#\x1b[0m", 10);  // Gray obstacle
+        *width = 1;
+        return 10;
+    }
+    int id = (c - 2) / 4;
+    int faction = (c - 2) % 4;
+    const char *color = "\x1b[0m"; // default
+    if (faction == FACTION_REPUBLIC) color = "\x1b[34m"; // blue
+    else if (faction == FACTION_CIS) color = "\x1b[31m"; // red
+    int n = sprintf(out, "%s%d\x1b[0m", color, id);
+    *width = id >= 10 ? 2 : 1;
+    return (size_t)n;
+}
+
+static int cell_width(uint16_t c) {
+    return (c >= 2 && (c - 2) / 4 >= 10) ? 2 : 1;
+}
+
+size_t grid_render_key(const grid_snap_t *cur, int positioned, char *out, size_t cap) {
+    if (cap < GRID_FRAME_MAX) return 0;
+    char *p = out;
+    int w;
+    if (positioned) p += sprintf(p, "\x1b[r\x1b[H\x1b[2J");
+    p += sprintf(p, "\n\t");
+    for (int i = 0; i < M; i++) *p++ = (char)('0' + i % 10);
+    *p++ = '\n';
+    for (int y = 0; y < N; y++) {
+        p += sprintf(p, "%d\t", y);
+        for (int x = 0; x < M; x++) p += cell_text(cur->cell[y][x], p, &w);
+        *p++ = '\n';
+    }
+    /* keep the grid in place: everything else scrolls below it */
+    if (positioned) p += sprintf(p, "\x1b[%dr\x1b[%d;1H", GRID_ROW0 + N, GRID_ROW0 + N);
+    return (size_t)(p - out);
+}
+
+size_t grid_render_delta(const grid_snap_t *prev, const grid_snap_t *cur, char *out, size_t cap) {
+    if (cap < GRID_FRAME_MAX) return 0;
+    char *p = out;
+    int w;
+    p += sprintf(p, "\x1b" "7");    // save cursor: the log output continues there
+    char *body = p;
+    for (int y = 0; y < N; y++) {
+        int row = GRID_ROW0 + y;
+        int col = GRID_COL0;        // screen column of cell x, old and new layout alike
+        int cursor = -1;            // screen column of the cursor in this row, -1 unknown
+        for (int x = 0; x < M; x++) {
+            uint16_t a = prev->cell[y][x], b = cur->cell[y][x];
+            int wb = cell_width(b);
+            if (a != b) {
+                if (cursor != col) p += sprintf(p, "\x1b[%d;%dH", row, col);
+                /* an id of different width: shift the rest of the row with
+                 * insert/delete character instead of reprinting it */
+                int wa = cell_width(a);
+                if (wb > wa) p += sprintf(p, "\x1b[%d@", wb - wa);
+                else if (wb < wa) p += sprintf(p, "\x1b[%dP", wa - wb);
+                p += cell_text(b, p, &w);
+                cursor = col + w;
+            }
+            col += wb;
+        }
+    }
+    if (p == body) return 0;
+    p += sprintf(p, "\x1b" "8");
+    return (size_t)(p - out);
+}
+
+/* ---- render thread ---- */
+
+static struct {
+    pthread_t th;
+    pthread_mutex_t mu;
+    pthread_cond_t cv;
+    int started;
+    int stop;
+    int pause_req;
+    int has_pending;
+    grid_snap_t *pending;       // written by the tick loop under mu
+    grid_snap_t *cur;           // being rendered
+    grid_snap_t *last;          // what the terminal shows
+    int last_valid;
+    int every;
+    int since_key;
+    int tty_fd;                 // positioned frames, -1 without a terminal
+    int on_tty;                 // last frame went to the terminal
+    char *out;
+    uint64_t frames, keyframes, bytes;
+} g_gr = { .mu = PTHREAD_MUTEX_INITIALIZER, .cv = PTHREAD_COND_INITIALIZER, .tty_fd = -1 };
+
+/* plain text for stdout: the tee copies it to the log and the screen */
+static void emit(const char *buf, size_t len) {
+    if (!len) return;
+    fwrite(buf, 1, len, stdout);
+    fflush(stdout);
+    g_gr.bytes += len;
+}
+
+/* cursor control goes to the terminal only */
+static void emit_tty(const char *buf, size_t len) {
+    while (len > 0) {
+        ssize_t w = write(g_gr.tty_fd, buf, len);
+        if (w < 0 && errno == EINTR) continue;
+        if (w <= 0) return;
+        buf += w;
+        len -= (size_t)w;
+        g_gr.bytes += (uint64_t)w;
+    }
+}
+
+/* Whether CC owns the terminal: in its foreground process group (a
+ * background write would stop CC with SIGTTOU under tostop), and no UI on
+ * the [STD] FIFO (the tee then leaves the terminal alone, and the UI may be
+ * drawing on this same terminal). */
+static int tty_owned(void) {
+    if (g_gr.tty_fd == -1) return 0;
+    if (tcgetpgrp(g_gr.tty_fd) != getpgrp()) return 0;
+    return access(TEE_UI_FIFO, F_OK) != 0;
+}
+
+static void render_one(void) {
+    int tty = tty_owned();
+    if (tty != g_gr.on_tty) {
+        /* terminal taken over or given back: restart from a keyframe */
+        g_gr.on_tty = tty;
+        g_gr.last_valid = 0;
+    }
+    if (!g_gr.last_valid || g_gr.every <= 1 || ++g_gr.since_key >= g_gr.every) {
+        /* one copy only: the tee also shows stdout on the terminal */
+        if (tty) emit_tty(g_gr.out, grid_render_key(g_gr.cur, 1, g_gr.out, GRID_FRAME_MAX));
+        else emit(g_gr.out, grid_render_key(g_gr.cur, 0, g_gr.out, GRID_FRAME_MAX));
+        g_gr.since_key = 0;
+        g_gr.keyframes++;
+    } else if (tty) {
+        emit_tty(g_gr.out, grid_render_delta(g_gr.last, g_gr.cur, g_gr.out, GRID_FRAME_MAX));
+    }
+    g_gr.frames++;
+    grid_snap_t *t = g_gr.last;
+    g_gr.last = g_gr.cur;
+    g_gr.cur = t;
+    g_gr.last_valid = 1;
+}
+
+static void *render_thread(void *arg) {
+    (void)arg;
+    for (;;) {
+        pthread_mutex_lock(&g_gr.mu);
+        while (!g_gr.has_pending && !g_gr.pause_req && !g_gr.stop)
+            pthread_cond_wait(&g_gr.cv, &g_gr.mu);
+        int got = g_gr.has_pending;
+        int pause = g_gr.pause_req;
+        int stop = g_gr.stop;
+        if (got) {
+            grid_snap_t *t = g_gr.pending;
+            g_gr.pending = g_gr.cur;
+            g_gr.cur = t;
+            g_gr.has_pending = 0;
+        }
+        g_gr.pause_req = 0;
+        pthread_mutex_unlock(&g_gr.mu);
+
+        if (got) render_one();
+        if ((pause || stop) && g_gr.on_tty && g_gr.last_valid && tty_owned()) {
+            /* give the whole screen back to scrolling output */
+            static const char reset[] = "\x1b" "7" "\x1b[r" "\x1b" "8";
+            emit_tty(reset, sizeof(reset) - 1);
+        }
+        if (pause) g_gr.last_valid = 0;
+        if (stop) break;
+    }
+    return NULL;
+}
+
+int grid_render_start(int keyframe_every) {
+    if (g_gr.started) return 0;
+    g_gr.pending = calloc(1, sizeof(grid_snap_t));
+    g_gr.cur = calloc(1, sizeof(grid_snap_t));
+    g_gr.last = calloc(1, sizeof(grid_snap_t));
+    g_gr.out = malloc(GRID_FRAME_MAX);
+    if (!g_gr.pending || !g_gr.cur || !g_gr.last || !g_gr.out) goto fail;
+    g_gr.every = keyframe_every > 0 ? keyframe_every : 1;
+    /* stdout ends in the tee (log, UI [STD] FIFO), so deltas need a terminal
+     * of their own; without one every frame is a plain keyframe */
+    g_gr.tty_fd = -1;
+    if (g_gr.every > 1) g_gr.tty_fd = open("/dev/tty", O_WRONLY | O_NOCTTY | O_CLOEXEC);
+    if (g_gr.tty_fd == -1) g_gr.every = 1;
+    g_gr.on_tty = 0;
+    g_gr.stop = g_gr.pause_req = g_gr.has_pending = g_gr.last_valid = 0;
+    if (pthread_create(&g_gr.th, NULL, render_thread, NULL) != 0) goto fail;
+    g_gr.started = 1;
+    return 0;
+fail:
+    if (g_gr.tty_fd != -1) close(g_gr.tty_fd);
+    g_gr.tty_fd = -1;
+    free(g_gr.pending);
+    free(g_gr.cur);
+    free(g_gr.last);
+    free(g_gr.out);
+    g_gr.pending = g_gr.cur = g_gr.last = NULL;
+    g_gr.out = NULL;
+    return -1;
+}
+
+void grid_render_snapshot(const shm_state_t *S) {
+    if (!g_gr.started) return;
+    pthread_mutex_lock(&g_gr.mu);
+    grid_snap_take(g_gr.pending, S);    // overwrites a snapshot not rendered yet
+    g_gr.has_pending = 1;
+    pthread_cond_signal(&g_gr.cv);
+    pthread_mutex_unlock(&g_gr.mu);
+}
+
+void grid_render_pause(void) {
+    if (!g_gr.started) return;
+    pthread_mutex_lock(&g_gr.mu);
+    g_gr.pause_req = 1;
+    pthread_cond_signal(&g_gr.cv);
+    pthread_mutex_unlock(&g_gr.mu);
+}
+
+void grid_render_stop(uint64_t *frames, uint64_t *keyframes, uint64_t *bytes) {
+    if (g_gr.started) {
+        pthread_mutex_lock(&g_gr.mu);
+        g_gr.stop = 1;
+        pthread_cond_signal(&g_gr.cv);
+        pthread_mutex_unlock(&g_gr.mu);
+        pthread_join(g_gr.th, NULL);
+        g_gr.started = 0;
+        if (g_gr.tty_fd != -1) close(g_gr.tty_fd);
+        g_gr.tty_fd = -1;
+        free(g_gr.pending);
+        free(g_gr.cur);
+        free(g_gr.last);
+        free(g_gr.out);
+        g_gr.pending = g_gr.cur = g_gr.last = NULL;
+        g_gr.out = NULL;
+    }
+    if (frames) *frames = g_gr.frames;
+    if (keyframes) *keyframes = g_gr.keyframes;
+    if (bytes) *bytes = g_gr.bytes;
+}
@@ -0,0 +1,245 @@
+#define _GNU_SOURCE
+#include "CC/metrics_export.h"
+#include "ipc/metrics.h"
+#include "log.h"
+
+#include <errno.h>
+#include <poll.h>
+#include <stdarg.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/msg.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#define EXPORT_BUF 8192
+
+typedef struct {
+    const char *name;
+    const char *labels;     // NULL or 'key="value"'
+    const char *type;
+    const char *help;
+    double scale;           // raw value -> exported unit
+} metric_def_t;
+
+static const metric_def_t k_metrics[MET_COUNT] = {
+    [MET_TICKS]          = { "skirmish_ticks_total", NULL, "counter", "Ticks completed.", 1.0 },
+    [MET_SPAWNS]         = { "skirmish_spawns_total", NULL, "counter", "Unit processes spawned.", 1.0 },
+    [MET_DAMAGE_EVENTS]  = { "skirmish_damage_events_total", NULL, "counter", "Hits resolved in combat.", 1.0 },
+    [MET_DAMAGE_POINTS]  = { "skirmish_damage_points_total", NULL, "counter", "Damage dealt by resolved hits.", 1.0 },
+    [MET_LOCK_WAITS]     = { "skirmish_lock_acquisitions_total", NULL, "counter", "SEM_GLOBAL_LOCK acquisitions, all processes.", 1.0 },
+    [MET_LOCK_WAIT_NS]   = { "skirmish_lock_wait_seconds_total", NULL, "counter", "Time spent waiting for SEM_GLOBAL_LOCK, all processes.", 1e-9 },
+    [MET_LOG_DROPPED]    = { "skirmish_log_dropped_total", NULL, "counter", "Log lines dropped by full log rings, all processes.", 1.0 },
+    [MET_CONSOLE_DROPPED] = { "skirmish_console_dropped_total", NULL, "counter", "Console output chunks overwritten before reaching the tee.", 1.0 },
+    [MET_ALIVE_REPUBLIC] = { "skirmish_alive_units", "faction=\"republic\"", "gauge", "Alive units per faction.", 1.0 },
+    [MET_ALIVE_CIS]      = { "skirmish_alive_units", "faction=\"cis\"", "gauge", "Alive units per faction.", 1.0 },
+};
+
+/* counters also exported as per-second rates over the export interval */
+static const struct { metric_id_t id; const char *name; const char *help; } k_rates[] = {
+    { MET_TICKS,         "skirmish_ticks_per_second",         "Tick rate over the last export interval." },
+    { MET_SPAWNS,        "skirmish_spawns_per_second",        "Spawn rate over the last export interval." },
+    { MET_DAMAGE_EVENTS, "skirmish_damage_events_per_second", "Hit rate over the last export interval." },
+};
+
+static char g_file[600];
+static char g_sock[108];
+static int g_listen_fd = -1;
+static pthread_t g_srv_thread;
+static volatile int g_srv_stop = 0;
+
+/* last rendered export, served by the socket thread */
+static pthread_mutex_t g_text_mx = PTHREAD_MUTEX_INITIALIZER;
+static char g_text[EXPORT_BUF];
+static size_t g_text_len = 0;
+
+/* previous export, for the rates */
+static uint64_t g_prev_ns = 0;
+static uint64_t g_prev[MET_COUNT];
+
+static uint64_t mono_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static void serve_one(int fd) {
+    /* the request itself is ignored; read what arrived so close() does not RST */
+    char req[512];
+    struct pollfd p = { .fd = fd, .events = POLLIN };
+    if (poll(&p, 1, 100) > 0) (void)read(fd, req, sizeof(req));
+
+    char hdr[128];
+    pthread_mutex_lock(&g_text_mx);
+    int n = snprintf(hdr, sizeof(hdr),
+                     "HTTP/1.0 200 OK\r\nContent-Type: text/plain; version=0.0.4\r\n"
+                     "Content-Length: %zu\r\n\r\n", g_text_len);
+    ssize_t w = write(fd, hdr, (size_t)n);
+    if (w == n) w = write(fd, g_text, g_text_len);
+    pthread_mutex_unlock(&g_text_mx);
+    (void)w;
+}
+
+static void *server_thread(void *arg) {
+    (void)arg;
+    while (!g_srv_stop) {
+        struct pollfd p = { .fd = g_listen_fd, .events = POLLIN };
+        int r = poll(&p, 1, 250);
+        if (r <= 0) continue;
+        int fd = accept(g_listen_fd, NULL, NULL);
+        if (fd == -1) continue;
+        serve_one(fd);
+        close(fd);
+    }
+    return NULL;
+}
+
+static int open_socket(const char *path) {
+    struct sockaddr_un addr;
+    if (strlen(path) >= sizeof(addr.sun_path)) {
+        errno = ENAMETOOLONG;
+        return -1;
+    }
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd == -1) return -1;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strcpy(addr.sun_path, path);
+    unlink(path);   // stale socket of a previous run
+    if (bind(fd, (struct sockaddr *)&addr, sizeof(addr)) == -1 || listen(fd, 8) == -1) {
+        int e = errno;
+        close(fd);
+        errno = e;
+        return -1;
+    }
+    return fd;
+}
+
+int metrics_export_open(const char *file_path, const char *sock_path) {
+    g_file[0] = '\0';
+    g_sock[0] = '\0';
+    if (file_path) snprintf(g_file, sizeof(g_file), "%s", file_path);
+    if (sock_path) {
+        g_listen_fd = open_socket(sock_path);
+        if (g_listen_fd == -1) {
+            LOGE("[CC] metrics socket %s: %s", sock_path, strerror(errno));
+        } else {
+            g_srv_stop = 0;
+            if (pthread_create(&g_srv_thread, NULL, server_thread, NULL) != 0) {
+                close(g_listen_fd);
+                g_listen_fd = -1;
+                unlink(sock_path);
+            } else {
+                snprintf(g_sock, sizeof(g_sock), "%s", sock_path);
+            }
+        }
+    }
+    g_prev_ns = mono_ns();
+    memset(g_prev, 0, sizeof(g_prev));
+    return (g_file[0] || g_listen_fd != -1) ? 0 : -1;
+}
+
+/* append to buf[*len], dropping what does not fit */
+static void out(char *buf, size_t *len, const char *fmt, ...) __attribute__((format(printf, 3, 4)));
+static void out(char *buf, size_t *len, const char *fmt, ...) {
+    if (*len >= EXPORT_BUF) return;
+    va_list ap;
+    va_start(ap, fmt);
+    int n = vsnprintf(buf + *len, EXPORT_BUF - *len, fmt, ap);
+    va_end(ap);
+    if (n > 0) *len += (size_t)n < EXPORT_BUF - *len ? (size_t)n : EXPORT_BUF - *len - 1;
+}
+
+static size_t render(ipc_ctx_t *ctx, uint32_t tick, char *buf) {
+    const metrics_t *m = &ctx->S->metrics;
+    size_t len = 0;
+    uint64_t now = mono_ns();
+    double dt = (double)(now - g_prev_ns) / 1e9;
+    uint64_t v[MET_COUNT];
+    for (int i = 0; i < MET_COUNT; i++) v[i] = metric_get(m, (metric_id_t)i);
+    /* the forwarder is forked before the registry is bound: read its count from the ring */
+    v[MET_CONSOLE_DROPPED] = __atomic_load_n(&ctx->S->console.dropped, __ATOMIC_RELAXED);
+
+    out(buf, &len, "# HELP skirmish_tick Current tick.\n# TYPE skirmish_tick gauge\nskirmish_tick %u\n", tick);
+
+    const char *prev_name = NULL;
+    for (int i = 0; i < MET_COUNT; i++) {
+        const metric_def_t *d = &k_metrics[i];
+        if (!prev_name || strcmp(prev_name, d->name) != 0)
+            out(buf, &len, "# HELP %s %s\n# TYPE %s %s\n", d->name, d->help, d->name, d->type);
+        prev_name = d->name;
+        if (d->scale != 1.0) out(buf, &len, "%s %.9f\n", d->name, (double)v[i] * d->scale);
+        else if (d->labels) out(buf, &len, "%s{%s} %llu\n", d->name, d->labels, (unsigned long long)v[i]);
+        else out(buf, &len, "%s %llu\n", d->name, (unsigned long long)v[i]);
+    }
+
+    for (size_t i = 0; i < sizeof(k_rates) / sizeof(k_rates[0]); i++) {
+        metric_id_t id = k_rates[i].id;
+        double rate = dt > 0 ? (double)(v[id] - g_prev[id]) / dt : 0.0;
+        out(buf, &len, "# HELP %s %s\n# TYPE %s gauge\n%s %.3f\n",
+            k_rates[i].name, k_rates[i].help, k_rates[i].name, k_rates[i].name, rate);
+    }
+
+    /* queue depth straight from the kernel */
+    out(buf, &len, "# HELP skirmish_mq_messages Messages waiting per queue (msgctl IPC_STAT).\n"
+                   "# TYPE skirmish_mq_messages gauge\n");
+    struct msqid_ds ds[MQ_COUNT];
+    int ok[MQ_COUNT];
+    const int qids[MQ_COUNT] = { ctx->q_spawn, ctx->q_cmd, ctx->q_rep };
+    for (int c = 0; c < MQ_COUNT; c++) {
+        ok[c] = qids[c] != -1 && msgctl(qids[c], IPC_STAT, &ds[c]) == 0;
+        if (ok[c]) out(buf, &len, "skirmish_mq_messages{queue=\"%s\"} %lu\n", ipc_queue_name(c),
+                       (unsigned long)ds[c].msg_qnum);
+    }
+    out(buf, &len, "# HELP skirmish_mq_bytes Bytes waiting per queue (msgctl IPC_STAT).\n"
+                   "# TYPE skirmish_mq_bytes gauge\n");
+    for (int c = 0; c < MQ_COUNT; c++)
+        if (ok[c]) out(buf, &len, "skirmish_mq_bytes{queue=\"%s\"} %lu\n", ipc_queue_name(c),
+                       (unsigned long)ds[c].__msg_cbytes);
+    out(buf, &len, "# HELP skirmish_mq_capacity_bytes Queue capacity (msg_qbytes).\n"
+                   "# TYPE skirmish_mq_capacity_bytes gauge\n");
+    for (int c = 0; c < MQ_COUNT; c++)
+        if (ok[c]) out(buf, &len, "skirmish_mq_capacity_bytes{queue=\"%s\"} %lu\n", ipc_queue_name(c),
+                       (unsigned long)ds[c].msg_qbytes);
+
+    g_prev_ns = now;
+    memcpy(g_prev, v, sizeof(g_prev));
+    return len;
+}
+
+static void write_file(const char *text, size_t len) {
+    char tmp[sizeof(g_file) + 8];
+    snprintf(tmp, sizeof(tmp), "%s.tmp", g_file);
+    FILE *f = fopen(tmp, "w");
+    if (!f) {
+        LOGW("[CC] metrics file %s: %s", tmp, strerror(errno));
+        return;
+    }
+    int ok = fwrite(text, 1, len, f) == len;
+    if (fclose(f) != 0) ok = 0;
+    if (!ok || rename(tmp, g_file) == -1) LOGW("[CC] metrics file %s: %s", g_file, strerror(errno));
+}
+
+void metrics_export(ipc_ctx_t *ctx, uint32_t tick) {
+    static char text[EXPORT_BUF];
+    size_t len = render(ctx, tick, text);
+    if (g_file[0]) write_file(text, len);
+    if (g_listen_fd != -1) {
+        pthread_mutex_lock(&g_text_mx);
+        memcpy(g_text, text, len);
+        g_text_len = len;
+        pthread_mutex_unlock(&g_text_mx);
+    }
+}
+
+void metrics_export_close(void) {
+    if (g_listen_fd == -1) return;
+    g_srv_stop = 1;
+    pthread_join(g_srv_thread, NULL);
+    close(g_listen_fd);
+    g_listen_fd = -1;
+    unlink(g_sock);
+}
@@ -0,0 +1,149 @@
+#define _GNU_SOURCE
+#include "CC/recorder.h"
+#include "ipc/recording.h"
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* stdio buffer of the recording file */
+#define RECORDER_BUF (1 << 20)
+
+static struct {
+    pthread_t th;
+    pthread_mutex_t mu;
+    pthread_cond_t not_empty, not_full;
+    int open;
+    int stop;
+    FILE *f;
+    char *fbuf;
+    rec_state_t *slot;              // RECORDER_QUEUE states
+    unsigned head, tail;            // captured / written (monotonic)
+    rec_state_t *prev;              // last state written, base of the next delta
+    uint8_t *out;
+    int key_every;
+    uint64_t ticks, bytes, stalls;
+} g_rec = {
+    .mu = PTHREAD_MUTEX_INITIALIZER,
+    .not_empty = PTHREAD_COND_INITIALIZER,
+    .not_full = PTHREAD_COND_INITIALIZER,
+};
+
+static void *writer_thread(void *arg) {
+    (void)arg;
+    for (;;) {
+        pthread_mutex_lock(&g_rec.mu);
+        while (g_rec.head == g_rec.tail && !g_rec.stop)
+            pthread_cond_wait(&g_rec.not_empty, &g_rec.mu);
+        if (g_rec.head == g_rec.tail) {     // stop and drained
+            pthread_mutex_unlock(&g_rec.mu);
+            break;
+        }
+        rec_state_t *cur = &g_rec.slot[g_rec.tail % RECORDER_QUEUE];
+        pthread_mutex_unlock(&g_rec.mu);
+
+        int key = (g_rec.ticks % (uint64_t)g_rec.key_every) == 0;
+        size_t len = rec_encode(g_rec.prev, cur, key, g_rec.out, REC_RECORD_MAX);
+        if (fwrite(g_rec.out, 1, len, g_rec.f) == len) g_rec.bytes += len;
+        memcpy(g_rec.prev, cur, sizeof(*cur));
+        g_rec.ticks++;
+
+        pthread_mutex_lock(&g_rec.mu);
+        g_rec.tail++;
+        pthread_cond_signal(&g_rec.not_full);
+        pthread_mutex_unlock(&g_rec.mu);
+    }
+    return NULL;
+}
+
+int recorder_open(const char *path, const char *scenario, uint64_t seed, int key_every) {
+    if (g_rec.open) return 0;
+    g_rec.f = fopen(path, "wb");
+    if (!g_rec.f) return -1;
+    g_rec.fbuf = malloc(RECORDER_BUF);
+    g_rec.slot = calloc(RECORDER_QUEUE, sizeof(rec_state_t));
+    g_rec.prev = calloc(1, sizeof(rec_state_t));
+    g_rec.out = malloc(REC_RECORD_MAX);
+    if (!g_rec.fbuf || !g_rec.slot || !g_rec.prev || !g_rec.out) {
+        errno = ENOMEM;
+        goto fail;
+    }
+    setvbuf(g_rec.f, g_rec.fbuf, _IOFBF, RECORDER_BUF);
+
+    rec_header_t h = { .m = M, .n = N, .max_units = MAX_UNITS, .seed = seed };
+    h.key_every = (uint16_t)(key_every > 0 && key_every < 65536 ? key_every : 1);
+    if (scenario) strncpy(h.scenario, scenario, sizeof(h.scenario) - 1);
+    uint8_t hdr[REC_HEADER_SIZE];
+    rec_header_write(&h, hdr);
+    if (fwrite(hdr, 1, sizeof(hdr), g_rec.f) != sizeof(hdr)) goto fail;
+
+    g_rec.key_every = h.key_every;
+    g_rec.head = g_rec.tail = 0;
+    g_rec.stop = 0;
+    g_rec.ticks = 0;
+    g_rec.bytes = sizeof(hdr);
+    g_rec.stalls = 0;
+    int err = pthread_create(&g_rec.th, NULL, writer_thread, NULL);
+    if (err != 0) {
+        errno = err;
+        goto fail;
+    }
+    g_rec.open = 1;
+    return 0;
+fail:
+    fclose(g_rec.f);    // before freeing the buffer it uses
+    free(g_rec.fbuf);
+    free(g_rec.slot);
+    free(g_rec.prev);
+    free(g_rec.out);
+    g_rec.f = NULL;
+    g_rec.fbuf = NULL;
+    g_rec.slot = g_rec.prev = NULL;
+    g_rec.out = NULL;
+    return -1;
+}
+
+void recorder_capture(const shm_state_t *S, const combat_hit_t *hits, int n_hits) {
+    if (!g_rec.open) return;
+    pthread_mutex_lock(&g_rec.mu);
+    if (g_rec.head - g_rec.tail == RECORDER_QUEUE) {
+        g_rec.stalls++;
+        while (g_rec.head - g_rec.tail == RECORDER_QUEUE)
+            pthread_cond_wait(&g_rec.not_full, &g_rec.mu);
+    }
+    rec_state_t *st = &g_rec.slot[g_rec.head % RECORDER_QUEUE];
+    pthread_mutex_unlock(&g_rec.mu);
+
+    /* the slot is ours until head moves: the writer only reads up to head */
+    rec_state_capture(st, S, hits, n_hits);
+
+    pthread_mutex_lock(&g_rec.mu);
+    g_rec.head++;
+    pthread_cond_signal(&g_rec.not_empty);
+    pthread_mutex_unlock(&g_rec.mu);
+}
+
+void recorder_close(uint64_t *ticks, uint64_t *bytes, uint64_t *stalls) {
+    if (g_rec.open) {
+        pthread_mutex_lock(&g_rec.mu);
+        g_rec.stop = 1;
+        pthread_cond_signal(&g_rec.not_empty);
+        pthread_mutex_unlock(&g_rec.mu);
+        pthread_join(g_rec.th, NULL);
+        fclose(g_rec.f);
+        free(g_rec.fbuf);
+        free(g_rec.slot);
+        free(g_rec.prev);
+        free(g_rec.out);
+        g_rec.f = NULL;
+        g_rec.fbuf = NULL;
+        g_rec.slot = g_rec.prev = NULL;
+        g_rec.out = NULL;
+        g_rec.open = 0;
+    }
+    if (ticks) *ticks = g_rec.ticks;
+    if (bytes) *bytes = g_rec.bytes;
+    if (stalls) *stalls = g_rec.stalls;
+}
@@ -1,4 +1,5 @@
 #include "CC/scenario.h"
+#include "CC/unit_rng.h"
 #include "error_handler.h"
 #include <stdio.h>
 #include <stdlib.h>
@@ -82,6 +83,8 @@ int scenario_load(const char *filename, scenario_t *out) {
         if (strcmp(section, "scenario") == 0) {
             if (strcmp(key, "name") == 0) {
                 strncpy(out->name, value, MAX_SCENARIO_NAME - 1);
+            } else if (strcmp(key, "seed") == 0) {
+                out->seed = strtoull(value, NULL, 0);
             }
         } else if (strcmp(section, "map") == 0) {
             if (strcmp(key, "width") == 0) {
@@ -157,7 +160,9 @@ int scenario_load(const char *filename, scenario_t *out) {
 void scenario_generate_placements(scenario_t *scenario) {
     if (scenario->unit_count > 0) return;  // Already has manual placements
     
-    srand(time(NULL));
+    /* placements are drawn from the scenario seed so a seed reproduces the layout */
+    rng_t rng;
+    rng_seed(&rng, scenario->seed, RNG_DOMAIN_SCENARIO, 0, 0);
     int count = 0;
     
     /* Helper to add a unit with bounds checking */
@@ -211,42 +216,42 @@ void scenario_generate_placements(scenario_t *scenario) {
         
         case PLACEMENT_RANDOM: {
             for (int i = 0; i < scenario->republic_flagships; i++)
-                ADD_UNIT(TYPE_FLAGSHIP, FACTION_REPUBLIC, rand() % (scenario->map_width / 2),
-                         rand() % scenario->map_height);
+                ADD_UNIT(TYPE_FLAGSHIP, FACTION_REPUBLIC, (int)rng_below(&rng, scenario->map_width / 2),
+                         (int)rng_below(&rng, scenario->map_height));
             for (int i = 0; i < scenario->republic_carriers; i++)
-                ADD_UNIT(TYPE_CARRIER, FACTION_REPUBLIC, rand() % (scenario->map_width / 2),
-                         rand() % scenario->map_height);
+                ADD_UNIT(TYPE_CARRIER, FACTION_REPUBLIC, (int)rng_below(&rng, scenario->map_width / 2),
+                         (int)rng_below(&rng, scenario->map_height));
             for (int i = 0; i < scenario->republic_destroyers; i++)
-                ADD_UNIT(TYPE_DESTROYER, FACTION_REPUBLIC, rand() % (scenario->map_width / 2),
-                         rand() % scenario->map_height);
+                ADD_UNIT(TYPE_DESTROYER, FACTION_REPUBLIC, (int)rng_below(&rng, scenario->map_width / 2),
+                         (int)rng_below(&rng, scenario->map_height));
             for (int i = 0; i < scenario->republic_fighters; i++)
-                ADD_UNIT(TYPE_FIGHTER, FACTION_REPUBLIC, rand() % (scenario->map_width / 2),
-                         rand() % scenario->map_height);
+                ADD_UNIT(TYPE_FIGHTER, FACTION_REPUBLIC, (int)rng_below(&rng, scenario->map_width / 2),
+                         (int)rng_below(&rng, scenario->map_height));
             for (int i = 0; i < scenario->republic_bombers; i++)
-                ADD_UNIT(TYPE_BOMBER, FACTION_REPUBLIC, rand() % (scenario->map_width / 2),
-                         rand() % scenario->map_height);
+                ADD_UNIT(TYPE_BOMBER, FACTION_REPUBLIC, (int)rng_below(&rng, scenario->map_width / 2),
+                         (int)rng_below(&rng, scenario->map_height));
             for (int i = 0; i < scenario->republic_elites; i++)
-                ADD_UNIT(TYPE_ELITE, FACTION_REPUBLIC, rand() % (scenario->map_width / 2),
-                         rand() % scenario->map_height);
+                ADD_UNIT(TYPE_ELITE, FACTION_REPUBLIC, (int)rng_below(&rng, scenario->map_width / 2),
+                         (int)rng_below(&rng, scenario->map_height));
             
             for (int i = 0; i < scenario->cis_flagships; i++)
-                ADD_UNIT(TYPE_FLAGSHIP, FACTION_CIS, scenario->map_width / 2 + rand() % (scenario->map_width / 2),
-                         rand() % scenario->map_height);
+                ADD_UNIT(TYPE_FLAGSHIP, FACTION_CIS, scenario->map_width / 2 + (int)rng_below(&rng, scenario->map_width / 2),
+                         (int)rng_below(&rng, scenario->map_height));
             for (int i = 0; i < scenario->cis_carriers; i++)
-                ADD_UNIT(TYPE_CARRIER, FACTION_CIS, scenario->map_width / 2 + rand() % (scenario->map_width / 2),
-                         rand() % scenario->map_height);
+                ADD_UNIT(TYPE_CARRIER, FACTION_CIS, scenario->map_width / 2 + (int)rng_below(&rng, scenario->map_width / 2),
+                         (int)rng_below(&rng, scenario->map_height));
             for (int i = 0; i < scenario->cis_destroyers; i++)
-                ADD_UNIT(TYPE_DESTROYER, FACTION_CIS, scenario->map_width / 2 + rand() % (scenario->map_width / 2),
-                         rand() % scenario->map_height);
+                ADD_UNIT(TYPE_DESTROYER, FACTION_CIS, scenario->map_width / 2 + (int)rng_below(&rng, scenario->map_width / 2),
+                         (int)rng_below(&rng, scenario->map_height));
             for (int i = 0; i < scenario->cis_fighters; i++)
-                ADD_UNIT(TYPE_FIGHTER, FACTION_CIS, scenario->map_width / 2 + rand() % (scenario->map_width / 2),
-                         rand() % scenario->map_height);
+                ADD_UNIT(TYPE_FIGHTER, FACTION_CIS, scenario->map_width / 2 + (int)rng_below(&rng, scenario->map_width / 2),
+                         (int)rng_below(&rng, scenario->map_height));
             for (int i = 0; i < scenario->cis_bombers; i++)
-                ADD_UNIT(TYPE_BOMBER, FACTION_CIS, scenario->map_width / 2 + rand() % (scenario->map_width / 2),
-                         rand() % scenario->map_height);
+                ADD_UNIT(TYPE_BOMBER, FACTION_CIS, scenario->map_width / 2 + (int)rng_below(&rng, scenario->map_width / 2),
+                         (int)rng_below(&rng, scenario->map_height));
             for (int i = 0; i < scenario->cis_elites; i++)
-                ADD_UNIT(TYPE_ELITE, FACTION_CIS, scenario->map_width / 2 + rand() % (scenario->map_width / 2),
-                         rand() % scenario->map_height);
+                ADD_UNIT(TYPE_ELITE, FACTION_CIS, scenario->map_width / 2 + (int)rng_below(&rng, scenario->map_width / 2),
+                         (int)rng_below(&rng, scenario->map_height));
             break;
         }
         
@@ -0,0 +1,117 @@
+#define _GNU_SOURCE
+#include "CC/snapshot.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+_Static_assert(sizeof(snapshot_header_t) <= SNAPSHOT_HEADER_SIZE, "snapshot header exceeds its page");
+
+static int write_all(int fd, const void *buf, size_t len) {
+    const char *p = buf;
+    while (len > 0) {
+        ssize_t n = write(fd, p, len);
+        if (n == -1) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        p += n;
+        len -= (size_t)n;
+    }
+    return 0;
+}
+
+int64_t snapshot_write(const shm_state_t *S, const char *scenario, const char *path) {
+    static uint8_t page[SNAPSHOT_HEADER_SIZE];
+    snapshot_header_t h;
+    memset(&h, 0, sizeof(h));
+    memcpy(h.magic, SNAPSHOT_MAGIC, sizeof(h.magic));
+    h.state_size = sizeof(shm_state_t);
+    h.m = M;
+    h.n = N;
+    h.max_units = MAX_UNITS;
+    h.tick = S->ticks;
+    h.seed = S->rng_seed;
+    h.unit_count = S->unit_count;
+    if (scenario) strncpy(h.scenario, scenario, sizeof(h.scenario) - 1);
+    memset(page, 0, sizeof(page));
+    memcpy(page, &h, sizeof(h));
+
+    char tmp[600];
+    snprintf(tmp, sizeof(tmp), "%s.tmp", path);
+    int fd = open(tmp, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd == -1) return -1;
+    /* the image straight from the segment: one write, no staging copy */
+    if (write_all(fd, page, sizeof(page)) == -1 || write_all(fd, S, sizeof(*S)) == -1) {
+        int e = errno;
+        close(fd);
+        unlink(tmp);
+        errno = e;
+        return -1;
+    }
+    if (close(fd) == -1 || rename(tmp, path) == -1) {
+        int e = errno;
+        unlink(tmp);
+        errno = e;
+        return -1;
+    }
+    return (int64_t)(SNAPSHOT_HEADER_SIZE + sizeof(*S));
+}
+
+int snapshot_map(const char *path, snapshot_t *out) {
+    memset(out, 0, sizeof(*out));
+    int fd = open(path, O_RDONLY);
+    if (fd == -1) return -1;
+    struct stat sb;
+    if (fstat(fd, &sb) == -1) {
+        close(fd);
+        return -1;
+    }
+    if ((size_t)sb.st_size != SNAPSHOT_HEADER_SIZE + sizeof(shm_state_t)) {
+        close(fd);
+        errno = EINVAL;
+        return -1;
+    }
+    void *map = mmap(NULL, (size_t)sb.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) return -1;
+
+    const snapshot_header_t *h = map;
+    if (memcmp(h->magic, SNAPSHOT_MAGIC, sizeof(h->magic)) != 0 || h->state_size != sizeof(shm_state_t) ||
+        h->m != M || h->n != N || h->max_units != MAX_UNITS) {
+        munmap(map, (size_t)sb.st_size);
+        errno = EINVAL;
+        return -1;
+    }
+    out->map = map;
+    out->len = (size_t)sb.st_size;
+    out->h = h;
+    out->S = (const shm_state_t *)((const uint8_t *)map + SNAPSHOT_HEADER_SIZE);
+    return 0;
+}
+
+void snapshot_unmap(snapshot_t *snap) {
+    if (snap->map) munmap(snap->map, snap->len);
+    memset(snap, 0, sizeof(*snap));
+}
+
+void snapshot_restore(shm_state_t *S, const snapshot_t *snap) {
+    const shm_state_t *I = snap->S;
+    S->ticks = I->ticks;
+    S->next_unit_id = I->next_unit_id;
+    S->rng_seed = I->rng_seed;
+    memcpy(S->last_step_tick, I->last_step_tick, sizeof(S->last_step_tick));
+    memcpy(S->grid, I->grid, sizeof(S->grid));
+    memset(S->grid_dirty, 1, sizeof(S->grid_dirty));
+    memcpy(S->units, I->units, sizeof(S->units));
+    memcpy(S->orders, I->orders, sizeof(S->orders));
+    memcpy(S->telemetry, I->telemetry, sizeof(S->telemetry));
+    memcpy(S->priv, I->priv, sizeof(S->priv));
+    S->unit_count = I->unit_count;
+    S->fire_count = 0;
+    for (int id = 1; id <= MAX_UNITS; id++) S->units[id].pid = 0;
+}
@@ -13,6 +13,11 @@
 #include "ipc/semaphores.h"
 #include "ipc/shared.h"
 #include "ipc/ipc_mesq.h"
+#include "ipc/phase_prof.h"
+#include "ipc/lockstat.h"
+#include "ipc/trace.h"
+#include "ipc/metrics.h"
+#include "ipc/console_ring.h"
 
 #include "CC/weapon_stats.h"
 #include "CC/unit_stats.h"
@@ -25,9 +30,19 @@ static volatile unit_order_t order = PATROL;
 
 static volatile unit_id_t commander = 0;
 
+/* seq of last order applied from shm order slot */
+static uint32_t order_seq = 0;
+
 static volatile sig_atomic_t g_stop = 0;
 
-static volatile sig_atomic_t g_damage_pending = 0;
+/* last tick a fire intent was posted (telemetry) */
+static uint32_t g_last_fired_tick = 0;
+
+/* approach distance per target type, precomputed from loadout at startup */
+static int16_t g_aproach[UNIT_TYPE_COUNT];
+
+/* per-tick RNG stream keyed by (scenario seed, unit id, tick) */
+static rng_t g_rng;
 
 static ipc_ctx_t *g_ctx = NULL;
 static unit_id_t g_unit_id = 0;
@@ -49,12 +64,6 @@ static void on_term(int sig) {
     g_stop = 1;
 }
 
-static void on_damage(int sig) {
-    (void)sig;
-    LOGD("g_damage_pending flag raised. (g_damage_pending = 1)");
-    g_damage_pending = 1;
-}
-
 static void patrol_action(ipc_ctx_t *ctx,
     unit_id_t unit_id,
     unit_stats_t *st,
@@ -82,12 +91,12 @@ static void patrol_action(ipc_ctx_t *ctx,
     // Chosing patrol point
     if (*have_target_pri && in_disk_i(from.x, from.y, target_pri->x, target_pri->y, *aproach)) *have_target_pri = 0;
     if (!*have_target_pri) {
-        *have_target_pri = unit_chose_patrol_point(ctx, unit_id, target_pri, *st); 
+        *have_target_pri = unit_chose_patrol_point(ctx, unit_id, target_pri, *st, &g_rng); 
     }
     LOGD("[SQ %u] target (%d,%d)", unit_id, target_pri->x, target_pri->y);
     if (*have_target_sec) {
         unit_type_t target_type = (unit_type_t)ctx->S->units[*target_sec].type;
-        *aproach = (int)unit_calculate_aproach(st->ba, target_type);
+        *aproach = (int)g_aproach[target_type < UNIT_TYPE_COUNT ? target_type : DUMMY];
     }
 
 
@@ -104,13 +113,14 @@ static void attack_action(ipc_ctx_t *ctx,
     int *aproach
 )
 {
+    (void)st;
     if (ctx->S->units[*target_sec].alive) {
         *target_pri = get_target_position(ctx, unit_id, *target_sec);
         *have_target_pri = 1;
     }
     if (*have_target_sec) {
         unit_type_t target_type = (unit_type_t)ctx->S->units[*target_sec].type;
-        *aproach = (int)unit_calculate_aproach(st->ba, target_type);
+        *aproach = (int)g_aproach[target_type < UNIT_TYPE_COUNT ? target_type : DUMMY];
     }
 }
 
@@ -186,7 +196,7 @@ static void guard_action(ipc_ctx_t *ctx,
         
         if (*have_target_sec) {
             unit_type_t target_type = (unit_type_t)ctx->S->units[*target_sec].type;
-            *aproach = (int)unit_calculate_aproach(st->ba, target_type);
+            *aproach = (int)g_aproach[target_type < UNIT_TYPE_COUNT ? target_type : DUMMY];
         }
     }
     
@@ -217,13 +227,14 @@ static void squadrone_action(ipc_ctx_t *ctx,
 )
 {
     // Detect units
+    uint64_t p0 = prof_now();
     unit_id_t detect_enemy_id[MAX_UNITS];
     (void)memset(detect_enemy_id, 0, sizeof(detect_enemy_id));
-    st_points_t out_dmg[st->ba.count];
-    (void)memset(out_dmg, 0, sizeof(out_dmg));
     int enemy_count = unit_radar(unit_id, *st, ctx->S->units, detect_enemy_id, ctx->S->units[unit_id].faction);
+    prof_add(PROF_RADAR, p0);
     
     // check for commander assignment replies
+    p0 = prof_now();
     mq_commander_rep_t cmd_rep;
     while (mq_try_recv_commander_reply(ctx->q_rep, &cmd_rep) == 1) {
         if (cmd_rep.status == 0) {
@@ -233,23 +244,29 @@ static void squadrone_action(ipc_ctx_t *ctx,
     }
     
     // check for orders from commander
-    mq_order_t order_msg = {0};
-    while (mq_try_recv_order(ctx->q_req, &order_msg) == 1) {
-        order = order_msg.order;
-        LOGD("[SQ %u] received order %d with target %u", unit_id, order, order_msg.target_id);
-        
-        // Set targets based on order
-        if (order == ATTACK && order_msg.target_id > 0) {
-            *target_sec = order_msg.target_id;
+    order_slot_t order_msg;
+    if (commander && unit_poll_order(ctx, unit_id, commander, &order_seq, &order_msg) == 1) {
+        order = (unit_order_t)order_msg.order;
+        LOGD("[SQ %u] received order %d with target %u", unit_id, order, order_msg.target);
+    }
+
+    // The slot only changes with the order, so re-arm its target every tick
+    // (as the per-tick order message did): a target dropped when it left DR
+    // is picked up again while the order stands and the target lives.
+    const order_slot_t *cur = &ctx->S->orders[unit_id];
+    if (commander && cur->commander == commander && cur->seq == order_seq &&
+        cur->order == (uint8_t)order && cur->target > 0 && ctx->S->units[cur->target].alive) {
+        if (order == ATTACK) {
+            *target_sec = cur->target;
             *have_target_sec = 1;
-        } else if (order == GUARD && order_msg.target_id > 0) {
-            if (ctx->S->units[order_msg.target_id].alive) {
-                *target_ter = order_msg.target_id;
-                *have_target_ter = 1;
-            }
+        } else if (order == GUARD) {
+            *target_ter = cur->target;
+            *have_target_ter = 1;
         }
     }
     
+    prof_add(PROF_MSG, p0);
+
     // logging SQ commander id
     LOGD("[SQ %u] current commander %u state %u", unit_id, commander, ctx->S->units[commander].alive);
 
@@ -267,7 +284,9 @@ static void squadrone_action(ipc_ctx_t *ctx,
         (void)memset(detect_ally_id, 0, sizeof(detect_ally_id));
         faction_t my_faction = ctx->S->units[unit_id].faction;
         // Use FACTION_NONE to detect ALL units, then filter for same-faction capital ships
+        p0 = prof_now();
         int ally_count = unit_radar(unit_id, *st, ctx->S->units, detect_ally_id, FACTION_NONE);
+        prof_add(PROF_RADAR, p0);
         for (int i=0; i<ally_count; i++){
             unit_entity_t u = ctx->S->units[detect_ally_id[i]];
             // Only request commander from same faction flagships/carriers
@@ -279,7 +298,9 @@ static void squadrone_action(ipc_ctx_t *ctx,
                     .sender_id = unit_id,
                     .req_id = (uint32_t)(unit_id * 1000 + ctx->S->ticks)
                 };
-                mq_send_commander_req(ctx->q_req, &req);
+                p0 = prof_now();
+                mq_send_commander_req(ctx->q_cmd, &req);
+                prof_add(PROF_MSG, p0);
                 LOGD("[SQ %u] sent commander request to potential BS %u", unit_id, detect_ally_id[i]);
                 break;  // only send one request per tick
             }
@@ -299,6 +320,8 @@ static void squadrone_action(ipc_ctx_t *ctx,
     int aproach = 1;
     point_t from = ctx->S->units[unit_id].position;
 
+    // order logic (guard_action's scan around the guarded unit included) + move
+    p0 = prof_now();
     switch (order)
         {
         case PATROL:
@@ -322,12 +345,15 @@ static void squadrone_action(ipc_ctx_t *ctx,
 
         // Moving
     unit_move(ctx, unit_id, from, target_pri, st, aproach);
+    prof_add(PROF_PATHFIND, p0);
 
 
 
     // Second scan
+    p0 = prof_now();
     (void)memset(detect_enemy_id, 0, sizeof(detect_enemy_id));
     enemy_count = unit_radar(unit_id, *st, ctx->S->units, detect_enemy_id, ctx->S->units[unit_id].faction);
+    prof_add(PROF_RADAR, p0);
 
     // Checking if secondary target is within DR
     if (*have_target_sec){
@@ -342,7 +368,10 @@ static void squadrone_action(ipc_ctx_t *ctx,
     }
 
     if (*have_target_sec) {
-        (void)unit_weapon_shoot(ctx, unit_id, st, *target_sec, enemy_count, detect_enemy_id, out_dmg);
+        p0 = prof_now();
+        if (unit_weapon_shoot(ctx, unit_id, st, *target_sec, enemy_count, detect_enemy_id) > 0)
+            g_last_fired_tick = ctx->S->ticks;
+        prof_add(PROF_SHOOT, p0);
         LOGD("[SQ %d] ap=%d Sec target %d", unit_id, aproach, *target_sec);
         printf("[SQ %d] ap=%d Sec target %d\n", unit_id, aproach, *target_sec);
     }
@@ -356,6 +385,7 @@ int main(int argc, char **argv) {
     
     const char *ftok_path = "./ipc.key";
     int faction = 0, type_i = 0, x = -1, y = -1;
+    int restore = 0;
 
     int8_t have_target_pri = 0;
     point_t primary_target = {0};
@@ -378,6 +408,7 @@ int main(int argc, char **argv) {
         else if (!strcmp(argv[i], "--x") && i + 1 < argc) x = atoi(argv[++i]);
         else if (!strcmp(argv[i], "--y") && i + 1 < argc) y = atoi(argv[++i]);
         else if (!strcmp(argv[i], "--commander") && i + 1 < argc) commander = (unit_id_t)atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--restore")) restore = 1;   // continue from S->priv (CC --restore)
     }
 
     if (validate_int_range(unit_id, 1, MAX_UNITS, "squadron:validate_unit_id") != 0) {
@@ -391,22 +422,14 @@ int main(int argc, char **argv) {
     CHECK_SYS_CALL_NONFATAL(sigaction(SIGTERM, &sa, NULL), "squadron:sigaction_SIGTERM");
     CHECK_SYS_CALL_NONFATAL(sigaction(SIGINT, &(struct sigaction){ .sa_handler = SIG_IGN }, NULL), "squadron:sigaction_SIGINT");
 
-    // damage payload
-    struct sigaction sa2;
-    memset(&sa2, 0, sizeof(sa2));
-    sa2.sa_handler = on_damage;
-    sigemptyset(&sa2.sa_mask);
-    sa2.sa_flags = 0;
-    CHECK_SYS_CALL_NONFATAL(sigaction(SIGRTMAX, &sa2, NULL), "squadron:sigaction_SIGRTMAX");
-
-    //RNG per process
-    srand((unsigned)(time(NULL) ^ (getpid() << 16)));
-
     if (CHECK_SYS_CALL_NONFATAL(ipc_attach(&ctx, ftok_path), "squadron:ipc_attach") == -1) {
         return 1;
     }
     g_ctx = &ctx;
     g_unit_id = unit_id;
+    lockstat_bind(ctx.S, ctx.sem_id, unit_id, "SQ");
+    trace_bind(ctx.S, unit_id, "SQ");
+    console_ring_redirect(ctx.S);
 
     if (log_init("SQ", unit_id) == -1) {
         fprintf(stderr, "[SQ %u] log_init failed, continuing without logs\n", unit_id);
@@ -428,6 +451,24 @@ int main(int argc, char **argv) {
 
     type = (unit_id_t)type_i;
     st = unit_stats_for_type(type);
+    unit_build_aproach_table(st.ba, g_aproach);
+
+    unit_private_t priv;
+    if (restore && unit_load_private(&ctx, unit_id, &priv)) {
+        st = priv.st;
+        order = (unit_order_t)priv.order;
+        commander = priv.commander;
+        order_seq = priv.order_seq;
+        have_target_pri = priv.have_target_pri;
+        have_target_sec = priv.have_target_sec;
+        have_target_ter = priv.have_target_ter;
+        primary_target = priv.target_pri;
+        secondary_target = priv.target_sec;
+        tertiary_target = priv.target_ter;
+        g_last_fired_tick = priv.last_fired_tick;
+        LOGI("[SQ %u] restored state of tick %u: hp=%d order=%d commander=%u",
+             unit_id, priv.tick, st.hp, order, commander);
+    }
 
     LOGI("pid=%d faction=%d type=%d pos=(%d,%d)", (int)getpid(), faction, type_i, x, y);
     printf("[SQ %u] pid=%d faction=%d type=%d pos=(%d,%d)\n",
@@ -436,16 +477,20 @@ int main(int argc, char **argv) {
 
     while (!g_stop) {
         // wait for tick to start
-        if (sem_wait_intr(ctx.sem_id, SEM_TICK_START, -1, &g_stop) == -1) {
+        // deterministic mode: wait for our own turn (CC runs units in id order)
+        unsigned short start_sem = ctx.S->deterministic ? SEM_UNIT_TURN(unit_id) : SEM_TICK_START;
+        if (sem_wait_intr(ctx.sem_id, start_sem, -1, &g_stop) == -1) {
             if (g_stop) break;
             continue;
         }
+        uint64_t tick_t0 = prof_now();
 
         if (sem_lock_intr(ctx.sem_id, SEM_GLOBAL_LOCK, &g_stop) == -1) {
             if (g_stop) break;
             HANDLE_SYS_ERROR_NONFATAL("squadron:sem_lock_intr", "Failed to acquire global lock");
             continue;
         }
+        prof_add(PROF_LOCK_WAIT, tick_t0);
 
         uint32_t t;
         uint8_t alive;
@@ -461,13 +506,14 @@ int main(int argc, char **argv) {
             break;
         }
 
-        if (g_damage_pending) {
-            g_damage_pending = 0;
+        if (ctx.S->units[unit_id].dmg_payload) {
             st_points_t old_hp = st.hp;
             compute_dmg_payload(&ctx, unit_id, &st);
             LOGD("[SQ %d] damage received: hp %ld -> %ld", unit_id, old_hp, st.hp);
         }
 
+        ctx.S->units[unit_id].hp = st.hp;
+
         if (st.hp <= 0) {
             LOGD("[BS %d] mark as dead", unit_id);
             mark_dead(&ctx, unit_id);
@@ -483,6 +529,7 @@ int main(int argc, char **argv) {
             continue;
         }
         ctx.S->last_step_tick[unit_id] = t;
+        rng_seed(&g_rng, ctx.S->rng_seed, RNG_DOMAIN_UNIT, (uint32_t)unit_id, t);
 
         CHECK_SYS_CALL_NONFATAL(sem_unlock(ctx.sem_id, SEM_GLOBAL_LOCK), "squadron:sem_unlock_pre_action");
 
@@ -494,6 +541,7 @@ int main(int argc, char **argv) {
         // perform action based on current order
         LOGD("[SQ %u] taking order | tick=%u pos=(%d,%d) order=%d",
              unit_id, t, cp.x, cp.y, order);
+        uint64_t p0 = prof_now();
         if (sem_lock_intr(ctx.sem_id, SEM_GLOBAL_LOCK, &g_stop) == -1) {
             if (g_stop) break;
             HANDLE_SYS_ERROR_NONFATAL("squadron:sem_lock_intr_action", "Failed to acquire lock for action");
@@ -502,6 +550,7 @@ int main(int argc, char **argv) {
             }
             break;
         }
+        prof_add(PROF_LOCK_WAIT, p0);
         
         // perform action based on current order
         squadrone_action(&ctx, unit_id, &st,
@@ -518,6 +567,29 @@ int main(int argc, char **argv) {
                 dist2(pos, primary_target), st.hp, st.sp, faction);
         }
 
+        // publish telemetry for UI (own seqlock, no global lock)
+        unit_publish_telemetry(&ctx, unit_id, type, t, &st, order,
+                               have_target_sec ? secondary_target : 0, g_last_fired_tick);
+
+        // private state for world snapshots (taken by CC between ticks)
+        priv = (unit_private_t){
+            .order = (uint8_t)order,
+            .have_target_pri = have_target_pri,
+            .have_target_sec = have_target_sec,
+            .have_target_ter = have_target_ter,
+            .target_pri = primary_target,
+            .target_sec = secondary_target,
+            .target_ter = tertiary_target,
+            .commander = commander,
+            .order_seq = order_seq,
+            .last_fired_tick = g_last_fired_tick,
+            .st = st,
+        };
+        unit_save_private(&ctx, unit_id, t, &priv);
+        prof_add(PROF_UNIT_TICK, tick_t0);
+        prof_publish(ctx.S, unit_id, t);
+        metrics_sync_log_drops();
+
         if (CHECK_SYS_CALL_NONFATAL(sem_post_retry(ctx.sem_id, SEM_TICK_DONE, +1), 
                                      "squadron:sem_post_TICK_DONE") == -1) {
             break;
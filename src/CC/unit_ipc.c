@@ -1,7 +1,11 @@
+/* unit <-> shm/queue glue: logs under the IPC module (see log.h) */
+#define LOG_MODULE LOG_MOD_IPC
 #include "ipc/ipc_mesq.h"
 #include "CC/unit_ipc.h"
 #include "CC/unit_size.h"
 #include "CC/unit_stats.h"
+#include "ipc/telemetry.h"
+#include "ipc/metrics.h"
 
 
 
@@ -50,42 +54,14 @@ void unit_add_to_dmg_payload(
     st_points_t dmg
 ) {
     if (ctx->S->units[target_id].pid <= 0) return;
-    
-    pid_t target_pid = ctx->S->units[target_id].pid;
-    
-    mq_damage_t dmg_msg = {
-        .mtype = target_pid,
-        .target_id = target_id,
-        .damage = dmg
-    };
-    mq_send_damage(ctx->q_req, &dmg_msg);
-    
-    // Signal the target unit that damage is waiting
-    kill(target_pid, SIGRTMAX);
+    ctx->S->units[target_id].dmg_payload += dmg;
 }
 
 void compute_dmg_payload(ipc_ctx_t *ctx, unit_id_t unit_id, unit_stats_t *st){
-    st_points_t total_damage = 0;
-    mq_damage_t dmg_msg;
-    int msg_count = 0;
-    
-    // Process all pending damage messages
-    while (mq_try_recv_damage(ctx->q_req, &dmg_msg) == 1) {
-        msg_count++;
-        if (dmg_msg.target_id == unit_id) {
-            total_damage += dmg_msg.damage;
-        } else {
-            // This shouldn't happen - message sent to wrong PID?
-            fprintf(stderr, "[WARN] Unit %u received damage message for unit %u (damage=%d)\n", 
-                    unit_id, dmg_msg.target_id, dmg_msg.damage);
-        }
-    }
-    
-    if (msg_count > 0 && total_damage == 0) {
-        fprintf(stderr, "[WARN] Unit %u received %d damage messages but total_damage=0\n", 
-                unit_id, msg_count);
-    }
-    
+    // net damage was accumulated by CC during last tick's combat resolution
+    st_points_t total_damage = ctx->S->units[unit_id].dmg_payload;
+    ctx->S->units[unit_id].dmg_payload = 0;
+
     if (total_damage > 0) {
         if (st->hp <= total_damage) {
             st->hp = 0;
@@ -95,75 +71,174 @@ void compute_dmg_payload(ipc_ctx_t *ctx, unit_id_t unit_id, unit_stats_t *st){
     }
 }
 
-st_points_t unit_weapon_shoot(ipc_ctx_t *ctx,
+int unit_publish_order(ipc_ctx_t *ctx, unit_id_t commander_id, unit_id_t underling_id,
+    unit_order_t order, unit_id_t target_id)
+{
+    order_slot_t *o = &ctx->S->orders[underling_id];
+    if (o->seq != 0 && o->order == (uint8_t)order && o->target == target_id && o->commander == commander_id)
+        return 0;
+    o->order = (uint8_t)order;
+    o->target = target_id;
+    o->commander = commander_id;
+    o->seq++;
+    return 1;
+}
+
+int unit_poll_order(ipc_ctx_t *ctx, unit_id_t unit_id, unit_id_t commander_id,
+    uint32_t *seen_seq, order_slot_t *out)
+{
+    const order_slot_t *o = &ctx->S->orders[unit_id];
+    // orders from a commander we have not (yet) accepted stay pending
+    if (o->seq == *seen_seq || o->commander != commander_id) return 0;
+    *seen_seq = o->seq;
+    *out = *o;
+    return 1;
+}
+
+void unit_publish_telemetry(ipc_ctx_t *ctx, unit_id_t unit_id, unit_type_t type, uint32_t tick,
+    const unit_stats_t *st, unit_order_t order, unit_id_t target, uint32_t last_fired_tick)
+{
+    unit_stats_t base = unit_stats_for_type(type);
+    unit_telemetry_t rec = {
+        .tick = tick,
+        .hp = st->hp,
+        .hp_max = base.hp,
+        .sh = st->sh,
+        .sh_max = base.sh,
+        .last_fired_tick = last_fired_tick,
+        .target = target,
+        .order = (uint8_t)order
+    };
+    telemetry_write(ctx->S, unit_id, &rec);
+}
+
+void unit_save_private(ipc_ctx_t *ctx, unit_id_t unit_id, uint32_t tick, unit_private_t *p) {
+    p->tick = tick;
+    ctx->S->priv[unit_id] = *p;
+}
+
+int unit_load_private(ipc_ctx_t *ctx, unit_id_t unit_id, unit_private_t *out) {
+    *out = ctx->S->priv[unit_id];
+    return out->tick != 0;
+}
+
+int unit_post_fire_intent(ipc_ctx_t *ctx, unit_id_t unit_id, uint8_t weapon, unit_id_t target_id) {
+    if (ctx->S->fire_count >= MAX_FIRE_INTENTS) {
+        LOGW("[UnitIPC] fire intent table full, dropping shot %u -> %u", unit_id, target_id);
+        return -1;
+    }
+    ctx->S->fire[ctx->S->fire_count++] = (fire_intent_t){
+        .attacker = unit_id,
+        .target = target_id,
+        .weapon = weapon
+    };
+    return 0;
+}
+
+int resolve_fire_intents(ipc_ctx_t *ctx, combat_hit_t *out, int cap) {
+    unit_entity_t *u = ctx->S->units;
+    uint16_t n = ctx->S->fire_count;
+    int hits = 0;
+
+    // loadouts are static per type: look them up once, not per intent
+    weapon_loadout_view_t ba[UNIT_TYPE_COUNT];
+    for (int t = 0; t < UNIT_TYPE_COUNT; t++)
+        ba[t] = unit_stats_for_type((unit_type_t)t).ba;
+
+    for (uint16_t i = 0; i < n; i++) {
+        fire_intent_t *f = &ctx->S->fire[i];
+        if (f->attacker <= 0 || f->attacker > MAX_UNITS || f->target <= 0 || f->target > MAX_UNITS) continue;
+        unit_entity_t *a = &u[f->attacker];
+        unit_entity_t *t = &u[f->target];
+        if (!t->alive || a->type >= UNIT_TYPE_COUNT || f->weapon >= ba[a->type].count) continue;
+
+        weapon_stats_t *w = &ba[a->type].arr[f->weapon];
+        float accuracy = accuracy_multiplier(w->type, (unit_type_t)t->type);
+        rng_t rng;
+        rng_seed(&rng, ctx->S->rng_seed, RNG_DOMAIN_COMBAT, (uint32_t)f->attacker, ctx->S->ticks);
+        rng.ctr = f->weapon;
+        st_points_t dmg = damage_to_target(a, t, w, accuracy, &rng);
+        if (dmg) {
+            unit_add_to_dmg_payload(ctx, f->target, dmg);
+            metric_add(MET_DAMAGE_POINTS, (uint64_t)dmg);
+            if (out && hits < cap) {
+                out[hits].attacker = f->attacker;
+                out[hits].target = f->target;
+                out[hits].dmg = dmg;
+            }
+            hits++;
+        }
+    }
+    ctx->S->fire_count = 0;
+    return hits;
+}
+
+int unit_weapon_shoot(ipc_ctx_t *ctx,
     unit_id_t unit_id,
     unit_stats_t *st,
     unit_id_t target_sec,
     int count,
-    unit_id_t *detect_id,
-    st_points_t *out_dmg
+    unit_id_t *detect_id
 )
 {
     unit_entity_t unit = ctx->S->units[unit_id];
-    unit_entity_t target;
     int8_t arr_count = st->ba.count;
-    weapon_stats_t weapon;
-    st_points_t total_dmg = 0;
-    float ac_max = 0;
-    int i_max = -1;
+    int posted = 0;
+
+    if (count > MAX_UNITS) count = MAX_UNITS;
+
+    // target types are gathered once and scored per weapon with table lookups
+    uint8_t t_types[MAX_UNITS];
+    float acc[MAX_UNITS];
+    unit_gather_types(ctx->S->units, detect_id, count, t_types);
 
     for (int i=0; i < arr_count; i++){
-        target = ctx->S->units[target_sec];
-        weapon = st->ba.arr[i];
-        weapon.w_target = 0;
-        st->ba.arr[i].w_target = weapon.w_target;
-        float accuracy = accuracy_multiplier(weapon.type, target.type); 
-        if (!accuracy || !in_disk_i(
-                                target.position.x, target.position.y,
+        weapon_stats_t *weapon = &st->ba.arr[i];
+        unit_id_t w_target = 0;
+
+        unit_entity_t *sec = &ctx->S->units[target_sec];
+        float accuracy = target_sec ? accuracy_multiplier(weapon->type, sec->type) : 0;
+        if (accuracy && in_disk_i(
+                                sec->position.x, sec->position.y,
                                 unit.position.x, unit.position.y,
-                                weapon.range)
-        )
+                                weapon->range))
         {
+            w_target = target_sec;
+        } else {
+            // secondary target not reachable with this weapon: pick best other detected unit
+            accuracy_multiplier_batch(weapon->type, t_types, count, acc);
+            float ac_max = 0;
             for (int j=0; j<count; j++){
-                target = ctx->S->units[detect_id[j]];
-                accuracy = accuracy_multiplier(weapon.type, target.type); 
-                if (detect_id != target_sec && accuracy
-                    && in_disk_i(
-                                target.position.x, target.position.y,
-                                unit.position.x, unit.position.y,
-                                weapon.range)
-                )
-                {
-                    if (accuracy>ac_max) {ac_max = accuracy; i_max = j;}
-                }
-            if (i_max == -1) weapon.w_target = 0;
-            else weapon.w_target = detect_id[i_max];
+                if (detect_id[j] == target_sec || acc[j] <= ac_max) continue;
+                unit_entity_t *t = &ctx->S->units[detect_id[j]];
+                if (!in_disk_i(t->position.x, t->position.y,
+                               unit.position.x, unit.position.y,
+                               weapon->range)) continue;
+                ac_max = acc[j];
+                w_target = detect_id[j];
             }
-        }else {
-            weapon.w_target = target_sec;
-        }
-        st->ba.arr[i].w_target = weapon.w_target;  
-        if (weapon.w_target) {
-            st_points_t dmg = damage_to_target(&unit, &target, &st->ba.arr[i], accuracy);
-            out_dmg[i] = dmg;
-            if (dmg) unit_add_to_dmg_payload(ctx, target_sec, dmg);
         }
+        weapon->w_target = w_target;
+        if (w_target && unit_post_fire_intent(ctx, unit_id, (uint8_t)i, w_target) == 0) posted++;
     }
-    char buf[256];
-    int off = 0;
+    // debug trace only: skip building it when the line would be dropped
+    if (LOG_ENABLED(LOG_LVL_DEBUG)) {
+        char buf[256];
+        int off = 0;
 
-    off += snprintf(buf + off, sizeof(buf) - off, "[BS %d] damage to units: [ ", unit_id);
+        off += snprintf(buf + off, sizeof(buf) - off, "[BS %d] fire intents: [ ", unit_id);
 
-    for (int i = 0; i < st->ba.count; i++) {
-        off += snprintf(buf + off, sizeof(buf) - off,
-                        "%d:%d, ",st->ba.arr[i].w_target, out_dmg[i]);
-    }
-    snprintf(buf + off, sizeof(buf) - off, "]");
+        for (int i = 0; i < st->ba.count; i++) {
+            off += snprintf(buf + off, sizeof(buf) - off,
+                            "%d, ",st->ba.arr[i].w_target);
+        }
+        snprintf(buf + off, sizeof(buf) - off, "]");
 
-    LOGD("%s", buf);
-    printf("%s\n", buf);
-    fflush(stdout);
-    return total_dmg;
+        log_msg(LOG_LVL_DEBUG, "%s", buf);
+        printf("%s\n", buf);
+        fflush(stdout);
+    }
+    return posted;
 }
 
 unit_id_t unit_chose_secondary_target(ipc_ctx_t *ctx,
@@ -177,19 +252,19 @@ unit_id_t unit_chose_secondary_target(ipc_ctx_t *ctx,
 {
     float max_multi = 0;
     unit_id_t max_id = 0;
-    float multi = 0;
 
-    unit_type_t t_type = DUMMY;
-    unit_type_t u_type = DUMMY;
+    if (count > MAX_UNITS) count = MAX_UNITS;
+
+    uint8_t t_types[MAX_UNITS];
+    float multi[MAX_UNITS];
 
     unit_entity_t *u = ctx->S->units;
+    unit_gather_types(u, detected_id, count, t_types);
+    damage_multiplier_batch((unit_type_t)u[unit_id].type, t_types, count, multi);
     for (int i = 0; i < count; i++){
-        // if (u[detected_id[i]].faction == u[unit_id].faction) continue;
-        t_type = u[detected_id[i]].type;
-        u_type = u[unit_id].type;
-        multi = damage_multiplier(u_type, t_type);
-        if (max_multi > multi) continue;
-        max_multi = multi;
+        // ties resolve to the last detected unit
+        if (max_multi > multi[i]) continue;
+        max_multi = multi[i];
         max_id = detected_id[i];
     }
     if (!max_id) return 0;
@@ -205,7 +280,8 @@ unit_id_t unit_chose_secondary_target(ipc_ctx_t *ctx,
 int8_t unit_chose_patrol_point(ipc_ctx_t *ctx,
     unit_id_t unit_id,
     point_t *target_pri,
-    unit_stats_t st
+    unit_stats_t st,
+    rng_t *rng
 )
 {
     // pick new patrol target
@@ -216,6 +292,7 @@ int8_t unit_chose_patrol_point(ipc_ctx_t *ctx,
             st.si,
             unit_id,
             ctx,
+            rng,
             target_pri)) {
         LOGD("[BS %u] picked new patrol target (%d,%d)",
                 unit_id, target_pri->x, target_pri->y);
@@ -13,49 +13,69 @@
 
 typedef struct { int16_t dx, dy; } offset_t;
 
+/* Combat lookup tables.
+ * Rows are indexed by attacker unit type / weapon type, columns by target type.
+ * Unknown target types are clamped to the DUMMY column (1.0 dmg, 0.0 accuracy),
+ * which matches the old switch-based fallbacks.
+ */
+static const float k_damage_mult[UNIT_TYPE_COUNT][UNIT_TYPE_COUNT] = {
+    /*                 DUMMY  FLAG   DEST   CARR   FIGH   BOMB   ELIT */
+    [DUMMY]          = {1.0f,  1.0f,  1.0f,  1.0f,  1.0f,  1.0f,  1.0f},
+    [TYPE_FLAGSHIP]  = {1.0f,  1.0f,  1.0f,  1.5f,  1.0f,  1.0f,  1.0f},
+    [TYPE_DESTROYER] = {1.0f,  1.5f,  1.5f,  1.5f,  1.0f,  1.0f,  1.0f},
+    [TYPE_CARRIER]   = {1.0f,  1.0f,  1.0f,  1.0f,  1.5f,  1.5f,  1.5f},
+    [TYPE_FIGHTER]   = {1.0f,  1.0f,  1.0f,  1.0f,  1.5f,  1.5f,  1.0f},
+    [TYPE_BOMBER]    = {1.0f,  3.0f,  3.0f,  3.0f,  1.0f,  1.0f,  1.0f},
+    [TYPE_ELITE]     = {1.0f,  1.0f,  1.0f,  1.0f,  2.0f,  2.0f,  2.0f},
+};
+
+static const float k_accuracy_mult[WEAPON_TYPE_COUNT][UNIT_TYPE_COUNT] = {
+    /*            DUMMY  FLAG   DEST   CARR   FIGH   BOMB   ELIT */
+    [NONE]      = {0.0f,  0.0f,  0.0f,  0.0f,  0.0f,  0.0f,  0.0f},
+    [LR_CANNON] = {0.0f,  0.75f, 0.75f, 0.75f, 0.25f, 0.25f, 0.25f},
+    [MR_CANNON] = {0.0f,  0.75f, 0.75f, 0.75f, 0.25f, 0.25f, 0.25f},
+    [SR_CANNON] = {0.0f,  0.75f, 0.75f, 0.75f, 0.25f, 0.25f, 0.25f},
+    [LR_GUN]    = {0.0f,  0.0f,  0.0f,  0.0f,  0.75f, 0.75f, 0.75f},
+    [MR_GUN]    = {0.0f,  0.0f,  0.0f,  0.0f,  0.75f, 0.75f, 0.75f},
+    [SR_GUN]    = {0.0f,  0.0f,  0.0f,  0.0f,  0.75f, 0.75f, 0.75f},
+};
+
+static inline unsigned type_col(unsigned t) {
+    return (t < UNIT_TYPE_COUNT) ? t : DUMMY;
+}
+
 float damage_multiplier(unit_type_t unit, unit_type_t target) {
-    switch (unit) {
-        case TYPE_FLAGSHIP:
-            if (target == TYPE_CARRIER) return 1.5f;
-            else return 1.0f;
-        case TYPE_DESTROYER:
-            if (target == TYPE_FLAGSHIP || target == TYPE_DESTROYER || target == TYPE_CARRIER) return 1.5f;
-            else return 1.0f;
-        case TYPE_CARRIER:
-            if (target == TYPE_FIGHTER || target == TYPE_BOMBER || target == TYPE_ELITE) return 1.5f;
-            else return 1.0f;
-        case TYPE_FIGHTER:
-            if (target == TYPE_FIGHTER || target == TYPE_BOMBER) return 1.5f;
-            else return 1.0f;
-        case TYPE_BOMBER:
-            if (target == TYPE_FLAGSHIP || target == TYPE_DESTROYER || target == TYPE_CARRIER) return 3.0f;
-            else return 1.0f;
-        case TYPE_ELITE:
-            if (target == TYPE_FIGHTER || target == TYPE_BOMBER || target == TYPE_ELITE) return 2.0f;
-            else return 1.0f;
-        default:
-            return 1.0f;
-    }
+    if ((unsigned)unit >= UNIT_TYPE_COUNT) return 1.0f;
+    return k_damage_mult[unit][type_col((unsigned)target)];
 }
 
 float accuracy_multiplier(weapon_type_t weapon, unit_type_t target) {
-    if (weapon == NONE) return 0.0f;
-    if (LR_CANNON <= weapon && weapon <= SR_CANNON) {
-        if (target == TYPE_FLAGSHIP || target == TYPE_DESTROYER || target == TYPE_CARRIER)
-            return 0.75f;
-        if (target == TYPE_FIGHTER || target == TYPE_BOMBER || target == TYPE_ELITE)
-            return 0.25f;
-    } else if (LR_GUN <= weapon && weapon <= SR_GUN) {
-        if (target == TYPE_FLAGSHIP || target == TYPE_DESTROYER || target == TYPE_CARRIER)
-            return 0.0f;
-        if (target == TYPE_FIGHTER || target == TYPE_BOMBER || target == TYPE_ELITE)
-            return 0.75f;
-    }
-    return 0.0f;
+    if ((unsigned)weapon >= WEAPON_TYPE_COUNT) return 0.0f;
+    return k_accuracy_mult[weapon][type_col((unsigned)target)];
 }
 
-st_points_t damage_to_target(unit_entity_t *attacker, unit_entity_t *target, weapon_stats_t *weapon, float accuracy) {
-    float roll = (float)rand() / (float)RAND_MAX;
+int unit_gather_types(const unit_entity_t *units, const unit_id_t *ids, int count, uint8_t *out_types) {
+    for (int i = 0; i < count; i++)
+        out_types[i] = (uint8_t)type_col(units[ids[i]].type);
+    return count;
+}
+
+void damage_multiplier_batch(unit_type_t unit, const uint8_t *t_types, int count, float *out) {
+    if ((unsigned)unit >= UNIT_TYPE_COUNT) unit = DUMMY;
+    const float *row = k_damage_mult[unit];
+    for (int i = 0; i < count; i++)
+        out[i] = row[t_types[i]];
+}
+
+void accuracy_multiplier_batch(weapon_type_t weapon, const uint8_t *t_types, int count, float *out) {
+    if ((unsigned)weapon >= WEAPON_TYPE_COUNT) weapon = NONE;
+    const float *row = k_accuracy_mult[weapon];
+    for (int i = 0; i < count; i++)
+        out[i] = row[t_types[i]];
+}
+
+st_points_t damage_to_target(unit_entity_t *attacker, unit_entity_t *target, weapon_stats_t *weapon, float accuracy, rng_t *rng) {
+    float roll = rng_float01(rng);
 
     if (roll > accuracy) {
         // MISS (0 dmg)
@@ -134,9 +154,10 @@ static int build_circle_border_offsets(int r, offset_t *out, int max_out) {
 int radar_pick_random_point_in_circle(
     int16_t cx, int16_t cy, int16_t r,
     int grid_w, int grid_h,
+    rng_t *rng,
     point_t *out
 ) {
-    if (!out) return 0;
+    if (!out || !rng) return 0;
     if (r < 0 || grid_w <= 0 || grid_h <= 0) return 0;
 
     const int r2 = r * r;
@@ -169,7 +190,7 @@ int radar_pick_random_point_in_circle(
         return 0;
     }
 
-    int k = rand() % n;
+    int k = (int)rng_below(rng, (uint32_t)n);
     *out = cands[k];
     free(cands);
     return 1;
@@ -181,9 +202,10 @@ int radar_pick_random_point_on_circle_border(
     int8_t unit_size,
     unit_id_t moving_unit_id,
     ipc_ctx_t *ctx,
+    rng_t *rng,
     point_t *out
 ) {
-    if (!out) return 0;
+    if (!out || !rng) return 0;
     if (r < 0 || grid_w <= 0 || grid_h <= 0) return 0;
 
     // safe upper bound for discrete border points in a box
@@ -225,7 +247,7 @@ int radar_pick_random_point_on_circle_border(
         return 0;
     }
 
-    int k = rand() % n;
+    int k = (int)rng_below(rng, (uint32_t)n);
     *out = cands[k];
     free(cands);
     return 1;
@@ -235,13 +257,14 @@ int unit_pick_patrol_target_local(
     point_t pos,
     int16_t dr,
     int grid_w, int grid_h,
+    rng_t *rng,
     point_t *out_target
 ) {
     if (!out_target) return 0;
     if (dr < 0) return 0;
     // 75% of speed radius (integer)
     // const int r = (dr * 3) / 4;
-    return radar_pick_random_point_in_circle(pos.x, pos.y, dr, grid_w, grid_h, out_target);
+    return radar_pick_random_point_in_circle(pos.x, pos.y, dr, grid_w, grid_h, rng, out_target);
 }
 
 int unit_compute_goal_for_tick(
@@ -736,12 +759,14 @@ int unit_radar(
 
 int16_t unit_calculate_aproach(weapon_loadout_view_t ba, unit_type_t t_type){
     int16_t min_range = INT16_MAX;
-    float ac = 0;
     for (int8_t i = 0; i < ba.count; i++){
-        ac = accuracy_multiplier(ba.arr[i].type, t_type);
-        if (ac > 0 && ba.arr[i].range < min_range) 
+        if (accuracy_multiplier(ba.arr[i].type, t_type) > 0 && ba.arr[i].range < min_range)
             min_range =  ba.arr[i].range;
     }   
     return min_range-1;
 }
 
+void unit_build_aproach_table(weapon_loadout_view_t ba, int16_t out[UNIT_TYPE_COUNT]){
+    for (int t = 0; t < UNIT_TYPE_COUNT; t++)
+        out[t] = unit_calculate_aproach(ba, (unit_type_t)t);
+}
@@ -114,6 +114,7 @@ void place_unit_on_grid(ipc_ctx_t *ctx, unit_id_t unit_id, point_t center, st_po
         // Only place if in bounds
         if (x >= 0 && x < M && y >= 0 && y < N) {
             ctx->S->grid[x][y] = unit_id;
+            ctx->S->grid_dirty[x] = 1;
         }
     }
 }
@@ -129,6 +130,7 @@ void remove_unit_from_grid(ipc_ctx_t *ctx, unit_id_t unit_id, point_t center, st
         if (x >= 0 && x < M && y >= 0 && y < N) {
             if (ctx->S->grid[x][y] == unit_id) {
                 ctx->S->grid[x][y] = 0;
+                ctx->S->grid_dirty[x] = 1;
             }
         }
     }
@@ -0,0 +1,169 @@
+#include <string.h>
+
+#include "CC/world_hash.h"
+
+#define XXH_P1 0x9E3779B185EBCA87ull
+#define XXH_P2 0xC2B2AE3D27D4EB4Full
+#define XXH_P3 0x165667B19E3779F9ull
+#define XXH_P4 0x85EBCA77C2B2AE63ull
+#define XXH_P5 0x27D4EB2F165667C5ull
+
+static inline uint64_t rotl64(uint64_t x, int r) {
+    return (x << r) | (x >> (64 - r));
+}
+
+static inline uint64_t read64(const uint8_t *p) {
+    uint64_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static inline uint32_t read32(const uint8_t *p) {
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static inline uint64_t xxh_round(uint64_t acc, uint64_t input) {
+    acc += input * XXH_P2;
+    acc = rotl64(acc, 31);
+    return acc * XXH_P1;
+}
+
+static inline uint64_t xxh_merge(uint64_t acc, uint64_t val) {
+    acc ^= xxh_round(0, val);
+    return acc * XXH_P1 + XXH_P4;
+}
+
+uint64_t xxh64(const void *data, size_t len, uint64_t seed) {
+    const uint8_t *p = (const uint8_t *)data;
+    const uint8_t *end = p + len;
+    uint64_t h;
+
+    if (len >= 32) {
+        uint64_t v1 = seed + XXH_P1 + XXH_P2;
+        uint64_t v2 = seed + XXH_P2;
+        uint64_t v3 = seed;
+        uint64_t v4 = seed - XXH_P1;
+        const uint8_t *limit = end - 32;
+        do {
+            v1 = xxh_round(v1, read64(p));      p += 8;
+            v2 = xxh_round(v2, read64(p));      p += 8;
+            v3 = xxh_round(v3, read64(p));      p += 8;
+            v4 = xxh_round(v4, read64(p));      p += 8;
+        } while (p <= limit);
+        h = rotl64(v1, 1) + rotl64(v2, 7) + rotl64(v3, 12) + rotl64(v4, 18);
+        h = xxh_merge(h, v1);
+        h = xxh_merge(h, v2);
+        h = xxh_merge(h, v3);
+        h = xxh_merge(h, v4);
+    } else {
+        h = seed + XXH_P5;
+    }
+
+    h += (uint64_t)len;
+
+    while (p + 8 <= end) {
+        h ^= xxh_round(0, read64(p));
+        h = rotl64(h, 27) * XXH_P1 + XXH_P4;
+        p += 8;
+    }
+    if (p + 4 <= end) {
+        h ^= (uint64_t)read32(p) * XXH_P1;
+        h = rotl64(h, 23) * XXH_P2 + XXH_P3;
+        p += 4;
+    }
+    while (p < end) {
+        h ^= (*p) * XXH_P5;
+        h = rotl64(h, 11) * XXH_P1;
+        p++;
+    }
+
+    h ^= h >> 33;
+    h *= XXH_P2;
+    h ^= h >> 29;
+    h *= XXH_P3;
+    h ^= h >> 32;
+    return h;
+}
+
+#define UNIT_SEED_BASE 0x10000ull
+#define TICK_SEED 0xFFFFFFFFull
+
+static inline uint64_t col_part(const shm_state_t *S, int x) {
+    return xxh64(S->grid[x], sizeof(S->grid[x]), (uint64_t)x);
+}
+
+static inline void pack_unit(const unit_entity_t *u, unit_hash_rec_t *r) {
+    memset(r, 0, sizeof(*r));
+    r->faction = u->faction;
+    r->type = u->type;
+    r->alive = u->alive;
+    r->x = u->position.x;
+    r->y = u->position.y;
+    r->dmg_payload = u->dmg_payload;
+    r->hp = u->hp;
+}
+
+static inline uint64_t unit_part(const unit_hash_rec_t *r, int id) {
+    return xxh64(r, sizeof(*r), UNIT_SEED_BASE + (uint64_t)id);
+}
+
+static inline uint64_t tick_part(uint32_t ticks) {
+    return xxh64(&ticks, sizeof(ticks), TICK_SEED);
+}
+
+void world_hash_init(world_hash_t *wh, shm_state_t *S) {
+    memset(wh, 0, sizeof(*wh));
+    for (int x = 0; x < M; x++) {
+        wh->col_hash[x] = col_part(S, x);
+        wh->sum += wh->col_hash[x];
+        S->grid_dirty[x] = 0;
+    }
+    for (int id = 1; id <= MAX_UNITS; id++) {
+        pack_unit(&S->units[id], &wh->unit_rec[id]);
+        wh->unit_hash[id] = unit_part(&wh->unit_rec[id], id);
+        wh->sum += wh->unit_hash[id];
+    }
+    wh->cols_rehashed = M;
+    wh->units_rehashed = MAX_UNITS;
+}
+
+uint64_t world_hash_update(world_hash_t *wh, shm_state_t *S) {
+    uint32_t cols = 0, units = 0;
+
+    for (int x = 0; x < M; x++) {
+        if (!S->grid_dirty[x]) continue;
+        S->grid_dirty[x] = 0;
+        uint64_t h = col_part(S, x);
+        wh->sum += h - wh->col_hash[x];
+        wh->col_hash[x] = h;
+        cols++;
+    }
+
+    for (int id = 1; id <= MAX_UNITS; id++) {
+        unit_hash_rec_t r;
+        pack_unit(&S->units[id], &r);
+        if (memcmp(&r, &wh->unit_rec[id], sizeof(r)) == 0) continue;
+        wh->unit_rec[id] = r;
+        uint64_t h = unit_part(&r, id);
+        wh->sum += h - wh->unit_hash[id];
+        wh->unit_hash[id] = h;
+        units++;
+    }
+
+    wh->cols_rehashed = cols;
+    wh->units_rehashed = units;
+    return wh->sum + tick_part(S->ticks);
+}
+
+uint64_t world_hash_full(const shm_state_t *S) {
+    uint64_t sum = 0;
+    for (int x = 0; x < M; x++) sum += col_part(S, x);
+    for (int id = 1; id <= MAX_UNITS; id++) {
+        unit_hash_rec_t r;
+        pack_unit(&S->units[id], &r);
+        sum += unit_part(&r, id);
+    }
+    return sum + tick_part(S->ticks);
+}
@@ -158,6 +158,43 @@ static int parse_command(const char *line, mq_cm_cmd_t *cmd) {
         }
         cmd->cmd = CM_CMD_GRID;
         return 0;
+    } else if (strcmp(first_word, "loglevel") == 0 || strcmp(first_word, "ll") == 0) {
+        /* Parse: loglevel [module|all] [level] */
+        char a1[16], a2[16];
+        int n = sscanf(buffer, "%*s %15s %15s", a1, a2);
+        int ok = 1;
+        cmd->log_module = -1;   /* all */
+        cmd->log_level = -1;    /* query */
+        if (n == 1) {
+            cmd->log_level = log_level_from_name(a1);
+            ok = cmd->log_level >= 0 || log_module_from_name(a1) >= 0;  /* "ll BS" queries */
+        } else if (n == 2) {
+            if (strcmp(a1, "all") != 0) cmd->log_module = log_module_from_name(a1);
+            cmd->log_level = log_level_from_name(a2);
+            ok = cmd->log_level >= 0 && (cmd->log_module >= 0 || strcmp(a1, "all") == 0);
+        }
+        if (!ok) {
+            relay_printf("Usage: loglevel [CC|BS|SQ|UI|CM|IPC|all] [debug|info|warn|error]\n");
+            return -1;
+        }
+        cmd->cmd = CM_CMD_LOGLEVEL;
+        return 0;
+    } else if (strcmp(first_word, "snapshot") == 0 || strcmp(first_word, "snap") == 0) {
+        /* Parse: snapshot <file>; CC has its own cwd, so send an absolute path */
+        char file[128];
+        if (sscanf(buffer, "%*s %127s", file) != 1) {
+            relay_printf("Usage: snapshot <file>\n");
+            return -1;
+        }
+        char cwd[128] = "";
+        if (file[0] != '/' && getcwd(cwd, sizeof(cwd)) == NULL) cwd[0] = '\0';
+        int n = snprintf(cmd->path, sizeof(cmd->path), "%s%s%s", cwd, cwd[0] ? "/" : "", file);
+        if (n < 0 || n >= (int)sizeof(cmd->path)) {
+            relay_printf("Snapshot path too long (max %zu)\n", sizeof(cmd->path) - 1);
+            return -1;
+        }
+        cmd->cmd = CM_CMD_SNAPSHOT;
+        return 0;
     } else if (strcmp(first_word, "end") == 0) {
         cmd->cmd = CM_CMD_END;
         return 0;
@@ -167,6 +204,10 @@ static int parse_command(const char *line, mq_cm_cmd_t *cmd) {
         relay_printf("  unfreeze / uf                   - Resume simulation\n");
         relay_printf("  tickspeed [ms] / ts             - Get/set tick speed (0-1000000 ms)\n");
         relay_printf("  grid [on|off] / g               - Toggle/set grid display\n");
+        relay_printf("  loglevel [module] [level] / ll  - Get/set runtime log level (all modules\n");
+        relay_printf("                                    or CC/BS/SQ/UI/CM/IPC; debug..error)\n");
+        relay_printf("  snapshot <file> / snap          - Save the world at the next tick\n");
+        relay_printf("                                    (start from it: command_center --restore)\n");
         relay_printf("  spawn <type> <faction> <x> <y>  - Spawn unit at position\n");
         relay_printf("  sp <type> <faction> <x> <y>     - Alias for spawn\n");
         relay_printf("    Types: carrier, destroyer, flagship, fighter, bomber, elite (or 1-6)\n");
@@ -204,7 +245,7 @@ static int send_and_wait(ipc_ctx_t *ctx, mq_cm_cmd_t *cmd) {
         printf("[CM] Sending spawn request: type=%d faction=%d pos=(%d,%d)\n",
                spawn_req.utype, spawn_req.faction, spawn_req.pos.x, spawn_req.pos.y);
         
-        if (mq_send_spawn(ctx->q_req, &spawn_req) < 0) {
+        if (mq_send_spawn(ctx->q_spawn, &spawn_req) < 0) {
             HANDLE_SYS_ERROR_NONFATAL("console_manager:mq_send_spawn", "Failed to send spawn request");
             return -1;
         }
@@ -255,7 +296,7 @@ static int send_and_wait(ipc_ctx_t *ctx, mq_cm_cmd_t *cmd) {
     cmd->req_id = req_id;
     
     /* Send command */
-    if (mq_send_cm_cmd(ctx->q_req, cmd) < 0) {
+    if (mq_send_cm_cmd(ctx->q_cmd, cmd) < 0) {
         HANDLE_SYS_ERROR_NONFATAL("console_manager:mq_send_cm_cmd", "Failed to send command");
         return -1;
     }
@@ -314,8 +355,8 @@ int main(int argc, char **argv) {
         return 1;
     }
     
-    LOGI("[CM] Connected to IPC (qreq=%d, qrep=%d)", ctx.q_req, ctx.q_rep);
-    printf("[CM] Connected to IPC (qreq=%d, qrep=%d)\n", ctx.q_req, ctx.q_rep);
+    LOGI("[CM] Connected to IPC (qspawn=%d, qcmd=%d, qrep=%d)", ctx.q_spawn, ctx.q_cmd, ctx.q_rep);
+    printf("[CM] Connected to IPC (qspawn=%d, qcmd=%d, qrep=%d)\n", ctx.q_spawn, ctx.q_cmd, ctx.q_rep);
     
     /* Create FIFOs for UI communication */
     const char *cm_to_ui = "/tmp/skirmish_cm_to_ui.fifo";
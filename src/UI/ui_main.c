@@ -6,6 +6,8 @@
 #include <string.h>
 #include <signal.h>
 #include <unistd.h>
+#include <errno.h>
+#include <time.h>
 #include <sys/stat.h>
 #include <ncurses.h>
 #include <pthread.h>
@@ -13,18 +15,145 @@
 #include "UI/ui.h"
 #include "UI/ui_map.h"
 #include "UI/ui_ust.h"
+#include "UI/ui_prf.h"
+#include "UI/ui_replay.h"
 #include "ipc/ipc_context.h"
+#include "ipc/semaphores.h"
+#include "ipc/ui_frame.h"
 #include "log.h"
 #include "error_handler.h"
 
 static ui_context_t g_ui_ctx = {0};
 
+/* Default cap on renders per second per thread (--max-fps) */
+#define UI_DEFAULT_MAX_FPS 30
+/* How often idle threads re-check stop/resize/IPC while no tick arrives */
+#define UI_IDLE_POLL_MS 100
+
 static void signal_handler(int sig) {
     (void)sig;
     g_ui_ctx.stop = 1;
     LOGI("[UI] Signal %d received, setting stop flag", sig);
 }
 
+/* Window sizes for a max_y x max_x screen: MAP fits the grid (M x N) + borders,
+ * STD gets the bottom (at least 5 lines), UST the rest to the right of MAP with
+ * PRF (one row per phase) below it. */
+static void ui_layout(int max_y, int max_x, int *map_height, int *map_width, int *bottom_height,
+                      int *prf_height) {
+    *map_width = M + 2;   // Grid width + 2 for borders
+    *map_height = N + 2;  // Grid height + 2 for borders
+    
+    /* Adjust if screen is too small */
+    if (*map_width > max_x) *map_width = max_x;
+    if (*map_height > max_y - 5) *map_height = max_y - 5;  // Leave room for STD
+    
+    /* Calculate bottom portion for STD (at least 5 lines) */
+    *bottom_height = max_y - *map_height;
+    if (*bottom_height < 5) {
+        *bottom_height = 5;
+        *map_height = max_y - *bottom_height;
+    }
+    
+    /* PRF: borders + header + one row per phase, at most half of the column */
+    *prf_height = PROF_PHASES + 3;
+    if (*prf_height > *map_height / 2) *prf_height = *map_height / 2;
+    if (*prf_height < 3) *prf_height = 3;
+}
+
+/* Re-layout windows after KEY_RESIZE; render threads redraw on the next redraw_gen. */
+static void ui_handle_resize(ui_context_t *ui_ctx) {
+    pthread_mutex_lock(&ui_ctx->ui_lock);
+    
+    int max_y, max_x;
+    getmaxyx(stdscr, max_y, max_x);
+    int map_height, map_width, bottom_height, prf_height;
+    ui_layout(max_y, max_x, &map_height, &map_width, &bottom_height, &prf_height);
+    
+    wresize(ui_ctx->map_win, map_height, map_width);
+    wresize(ui_ctx->ust_win, map_height - prf_height, max_x - map_width);
+    mvwin(ui_ctx->ust_win, 0, map_width);
+    wresize(ui_ctx->prf_win, prf_height, max_x - map_width);
+    mvwin(ui_ctx->prf_win, map_height - prf_height, map_width);
+    wresize(ui_ctx->std_win, bottom_height, max_x);
+    mvwin(ui_ctx->std_win, map_height, 0);
+    
+    werase(stdscr);
+    wnoutrefresh(stdscr);
+    werase(ui_ctx->map_win);
+    werase(ui_ctx->ust_win);
+    werase(ui_ctx->prf_win);
+    box(ui_ctx->map_win, 0, 0);
+    box(ui_ctx->ust_win, 0, 0);
+    box(ui_ctx->prf_win, 0, 0);
+    box(ui_ctx->std_win, 0, 0);
+    mvwprintw(ui_ctx->std_win, 0, 2, " OUTPUT ");
+    
+    pthread_mutex_unlock(&ui_ctx->ui_lock);
+    
+    __atomic_add_fetch(&ui_ctx->redraw_gen, 1, __ATOMIC_RELEASE);
+    LOGI("[UI] Terminal resized to %dx%d", max_x, max_y);
+}
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+/* Returns 0 once CC removed the IPC objects (semaphore set gone). */
+static int ipc_still_alive(ui_context_t *ui_ctx) {
+    if (ui_ctx->replay) return 1;   // private state, nothing to lose
+    if (semctl(ui_ctx->ctx->sem_id, SEM_GLOBAL_LOCK, GETVAL) == -1 &&
+        (errno == EINVAL || errno == EIDRM)) {
+        return 0;
+    }
+    return 1;
+}
+
+void ui_pacer_init(ui_context_t *ui_ctx, ui_pacer_t *p) {
+    memset(p, 0, sizeof(*p));
+    /* epoch differs from the current one, so the first wait renders immediately */
+    p->epoch = tick_epoch_load(ui_ctx->ctx->S) - 1;
+    p->redraw_gen = __atomic_load_n(&ui_ctx->redraw_gen, __ATOMIC_ACQUIRE);
+}
+
+int ui_pacer_wait(ui_context_t *ui_ctx, ui_pacer_t *p) {
+    /* Frame rate cap: ticks arriving faster than max_fps are coalesced */
+    if (ui_ctx->max_fps > 0 && p->renders > 0) {
+        uint64_t min_ns = 1000000000ull / (uint64_t)ui_ctx->max_fps;
+        uint64_t elapsed = now_ns() - p->last_ns;
+        if (elapsed < min_ns) {
+            uint64_t rest = min_ns - elapsed;
+            struct timespec ts = { (time_t)(rest / 1000000000ull), (long)(rest % 1000000000ull) };
+            while (nanosleep(&ts, &ts) == -1 && errno == EINTR && !ui_ctx->stop) {
+            }
+        }
+    }
+    
+    while (!ui_ctx->stop) {
+        uint32_t gen = __atomic_load_n(&ui_ctx->redraw_gen, __ATOMIC_ACQUIRE);
+        uint32_t epoch = tick_epoch_load(ui_ctx->ctx->S);
+        if (gen != p->redraw_gen || epoch != p->epoch) {
+            p->redraw_gen = gen;
+            p->epoch = epoch;
+            p->last_ns = now_ns();
+            p->renders++;
+            return 1;
+        }
+        
+        int ret = tick_epoch_wait(ui_ctx->ctx->S, epoch, UI_IDLE_POLL_MS);
+        if (ret == 0 && !ipc_still_alive(ui_ctx)) {
+            LOGI("[UI] IPC resources destroyed, stopping");
+            ui_ctx->stop = 1;
+        } else if (ret == -1) {
+            HANDLE_SYS_ERROR_NONFATAL("ui_pacer_wait:tick_epoch_wait", "Failed to wait for tick");
+            ui_ctx->stop = 1;
+        }
+    }
+    return 0;
+}
+
 int ui_init(ui_context_t *ui_ctx, const char *run_dir) {
     memset(ui_ctx, 0, sizeof(*ui_ctx));
     
@@ -33,6 +162,7 @@ int ui_init(ui_context_t *ui_ctx, const char *run_dir) {
     }
     
     ui_ctx->std_fifo_fd = -1;
+    ui_ctx->max_fps = UI_DEFAULT_MAX_FPS;
     ui_ctx->cm_in_fd = -1;
     ui_ctx->cm_out_fd = -1;
     
@@ -61,27 +191,16 @@ int ui_init(ui_context_t *ui_ctx, const char *run_dir) {
     int max_y, max_x;
     getmaxyx(stdscr, max_y, max_x);
     
-    /* Calculate MAP window to fit grid (M x N) + borders */
-    int map_width = M + 2;   // Grid width + 2 for borders
-    int map_height = N + 2;  // Grid height + 2 for borders
-    
-    /* Adjust if screen is too small */
-    if (map_width > max_x) map_width = max_x;
-    if (map_height > max_y - 5) map_height = max_y - 5;  // Leave room for STD
-    
-    /* Calculate bottom portion for STD (at least 5 lines) */
-    int bottom_height = max_y - map_height;
-    if (bottom_height < 5) {
-        bottom_height = 5;
-        map_height = max_y - bottom_height;
-    }
+    int map_height, map_width, bottom_height, prf_height;
+    ui_layout(max_y, max_x, &map_height, &map_width, &bottom_height, &prf_height);
     
-    /* UST takes remaining width to the right of MAP */
+    /* UST and PRF take remaining width to the right of MAP */
     int ust_width = max_x - map_width;
     
     /* Create windows */
     ui_ctx->map_win = newwin(map_height, map_width, 0, 0);
-    ui_ctx->ust_win = newwin(map_height, ust_width, 0, map_width);
+    ui_ctx->ust_win = newwin(map_height - prf_height, ust_width, 0, map_width);
+    ui_ctx->prf_win = newwin(prf_height, ust_width, map_height - prf_height, map_width);
     ui_ctx->std_win = newwin(bottom_height, max_x, map_height, 0);
     
     /* Enable scrolling for STD */
@@ -90,14 +209,17 @@ int ui_init(ui_context_t *ui_ctx, const char *run_dir) {
     /* Draw borders and titles */
     box(ui_ctx->map_win, 0, 0);
     box(ui_ctx->ust_win, 0, 0);
+    box(ui_ctx->prf_win, 0, 0);
     box(ui_ctx->std_win, 0, 0);
     
     mvwprintw(ui_ctx->map_win, 0, 2, " MAP ");
     mvwprintw(ui_ctx->ust_win, 0, 2, " UNIT STATS ");
+    mvwprintw(ui_ctx->prf_win, 0, 2, " TICK PHASES ");
     mvwprintw(ui_ctx->std_win, 0, 2, " OUTPUT ");
     
     wrefresh(ui_ctx->map_win);
     wrefresh(ui_ctx->ust_win);
+    wrefresh(ui_ctx->prf_win);
     wrefresh(ui_ctx->std_win);
     
     return 0;
@@ -106,6 +228,7 @@ int ui_init(ui_context_t *ui_ctx, const char *run_dir) {
 void ui_cleanup(ui_context_t *ui_ctx) {
     if (ui_ctx->map_win) delwin(ui_ctx->map_win);
     if (ui_ctx->ust_win) delwin(ui_ctx->ust_win);
+    if (ui_ctx->prf_win) delwin(ui_ctx->prf_win);
     if (ui_ctx->std_win) delwin(ui_ctx->std_win);
     
     endwin();
@@ -115,7 +238,7 @@ void ui_cleanup(ui_context_t *ui_ctx) {
     if (ui_ctx->cm_out_fd != -1) close(ui_ctx->cm_out_fd);
     
     /* Remove FIFO - this signals tee to return to normal terminal output */
-    unlink("/tmp/skirmish_std.fifo");
+    if (!ui_ctx->replay) unlink("/tmp/skirmish_std.fifo");
     
     pthread_mutex_destroy(&ui_ctx->ui_lock);
 }
@@ -125,14 +248,29 @@ void ui_refresh_all(ui_context_t *ui_ctx) {
     
     wrefresh(ui_ctx->map_win);
     wrefresh(ui_ctx->ust_win);
+    wrefresh(ui_ctx->prf_win);
     wrefresh(ui_ctx->std_win);
     
     pthread_mutex_unlock(&ui_ctx->ui_lock);
 }
 
+/* Detach from IPC, or free the private state of a replay. */
+static void ui_detach(ipc_ctx_t *ctx, ui_replay_t *replay) {
+    if (replay) {
+        ui_replay_close(replay);
+        free(ctx->S);
+        ctx->S = NULL;
+        return;
+    }
+    CHECK_SYS_CALL_NONFATAL(ipc_detach(ctx), "ui_main:ipc_detach");
+}
+
 int main(int argc, char **argv) {
     const char *ftok_path = "./ipc.key";
     char run_dir[512] = {0};
+    int max_fps = UI_DEFAULT_MAX_FPS;
+    const char *replay_path = NULL;
+    double replay_speed = 10.0;
     
     /* Initialize logging */
     log_init("UI", 0);
@@ -144,6 +282,13 @@ int main(int argc, char **argv) {
             ftok_path = argv[++i];
         } else if (!strcmp(argv[i], "--run-dir") && i + 1 < argc) {
             strncpy(run_dir, argv[++i], sizeof(run_dir) - 1);
+        } else if (!strcmp(argv[i], "--max-fps") && i + 1 < argc) {
+            max_fps = atoi(argv[++i]);
+            if (max_fps < 0) max_fps = 0;
+        } else if (!strcmp(argv[i], "--replay") && i + 1 < argc) {
+            replay_path = argv[++i];
+        } else if (!strcmp(argv[i], "--speed") && i + 1 < argc) {
+            replay_speed = atof(argv[++i]);
         }
     }
     
@@ -160,31 +305,48 @@ int main(int argc, char **argv) {
     signal(SIGINT, signal_handler);
     signal(SIGTERM, signal_handler);
     
-    /* Attach to IPC */
+    /* Attach to IPC, or decode a recording into private state (--replay) */
     ipc_ctx_t ctx;
-    if (CHECK_SYS_CALL_NONFATAL(ipc_attach(&ctx, ftok_path), "ui_main:ipc_attach") == -1) {
+    ui_replay_t *replay = NULL;
+    if (replay_path) {
+        replay = ui_replay_open(replay_path, replay_speed);
+        memset(&ctx, 0, sizeof(ctx));
+        ctx.shm_id = ctx.sem_id = -1;
+        ctx.S = calloc(1, sizeof(shm_state_t));
+        if (!replay || !ctx.S) {
+            LOGE("[UI] Failed to open recording %s", replay_path);
+            ui_replay_close(replay);
+            free(ctx.S);
+            return 1;
+        }
+        LOGI("[UI] Replaying %s", replay_path);
+    } else if (CHECK_SYS_CALL_NONFATAL(ipc_attach(&ctx, ftok_path), "ui_main:ipc_attach") == -1) {
         fprintf(stderr, "[UI] Failed to attach to IPC. Is command_center running?\n");
         LOGE("[UI] Failed to attach to IPC");
         return 1;
+    } else {
+        LOGI("[UI] Successfully attached to IPC");
     }
-    LOGI("[UI] Successfully attached to IPC");
     
     /* Initialize UI */
     if (ui_init(&g_ui_ctx, run_dir[0] ? run_dir : NULL) == -1) {
         fprintf(stderr, "[UI] Failed to initialize UI\n");
         LOGE("[UI] Failed to initialize ncurses");
-        ipc_detach(&ctx);
+        ui_detach(&ctx, replay);
         return 1;
     }
     LOGI("[UI] ncurses initialized successfully");
     
     g_ui_ctx.ctx = &ctx;
+    g_ui_ctx.replay = replay;
+    g_ui_ctx.max_fps = max_fps;
+    LOGI("[UI] max fps per render thread: %d%s", max_fps, max_fps ? "" : " (unlimited)");
     
     /* Start MAP thread */
     if (pthread_create(&g_ui_ctx.map_thread_id, NULL, ui_map_thread, &g_ui_ctx) != 0) {
         HANDLE_SYS_ERROR_NONFATAL("ui_main:pthread_create_MAP", "Failed to create MAP thread");
         ui_cleanup(&g_ui_ctx);
-        ipc_detach(&ctx);
+        ui_detach(&ctx, replay);
         return 1;
     }
     
@@ -194,18 +356,30 @@ int main(int argc, char **argv) {
         g_ui_ctx.stop = 1;
         pthread_join(g_ui_ctx.map_thread_id, NULL);
         ui_cleanup(&g_ui_ctx);
-        ipc_detach(&ctx);
+        ui_detach(&ctx, replay);
+        return 1;
+    }
+    
+    /* Start PRF thread */
+    if (pthread_create(&g_ui_ctx.prf_thread_id, NULL, ui_prf_thread, &g_ui_ctx) != 0) {
+        HANDLE_SYS_ERROR_NONFATAL("ui_main:pthread_create_PRF", "Failed to create PRF thread");
+        g_ui_ctx.stop = 1;
+        pthread_join(g_ui_ctx.map_thread_id, NULL);
+        pthread_join(g_ui_ctx.ust_thread_id, NULL);
+        ui_cleanup(&g_ui_ctx);
+        ui_detach(&ctx, replay);
         return 1;
     }
     
-    /* Start STD thread */
-    if (pthread_create(&g_ui_ctx.std_thread_id, NULL, ui_std_thread, &g_ui_ctx) != 0) {
+    /* Start STD thread (the replay player takes its place: no tee output to show) */
+    if (pthread_create(&g_ui_ctx.std_thread_id, NULL, replay ? ui_replay_thread : ui_std_thread, &g_ui_ctx) != 0) {
         HANDLE_SYS_ERROR_NONFATAL("ui_main:pthread_create_STD", "Failed to create STD thread");
         g_ui_ctx.stop = 1;
         pthread_join(g_ui_ctx.map_thread_id, NULL);
         pthread_join(g_ui_ctx.ust_thread_id, NULL);
+        pthread_join(g_ui_ctx.prf_thread_id, NULL);
         ui_cleanup(&g_ui_ctx);
-        ipc_detach(&ctx);
+        ui_detach(&ctx, replay);
         return 1;
     }
     
@@ -218,6 +392,11 @@ int main(int argc, char **argv) {
             LOGI("[UI] User requested quit");
             break;
         }
+        if (ch == KEY_RESIZE) {
+            ui_handle_resize(&g_ui_ctx);
+        } else if (ch != ERR) {
+            if (!ui_replay_handle_key(&g_ui_ctx, ch)) (void)ui_map_handle_key(&g_ui_ctx, ch);
+        }
         
         /* Refresh all windows */
         ui_refresh_all(&g_ui_ctx);
@@ -233,13 +412,15 @@ int main(int argc, char **argv) {
         close(g_ui_ctx.std_fifo_fd);
         g_ui_ctx.std_fifo_fd = -1;
     }
-    unlink("/tmp/skirmish_std.fifo");
+    if (!replay) unlink("/tmp/skirmish_std.fifo");
     
     /* Wait for threads to finish */
     LOGI("[UI] Joining MAP thread...");
     pthread_join(g_ui_ctx.map_thread_id, NULL);
     LOGI("[UI] Joining UST thread...");
     pthread_join(g_ui_ctx.ust_thread_id, NULL);
+    LOGI("[UI] Joining PRF thread...");
+    pthread_join(g_ui_ctx.prf_thread_id, NULL);
     LOGI("[UI] Joining STD thread...");
     pthread_join(g_ui_ctx.std_thread_id, NULL);
     LOGI("[UI] All threads joined");
@@ -247,7 +428,7 @@ int main(int argc, char **argv) {
     /* Cleanup */
     LOGI("[UI] Shutting down...");
     ui_cleanup(&g_ui_ctx);
-    CHECK_SYS_CALL_NONFATAL(ipc_detach(&ctx), "ui_main:ipc_detach");
+    ui_detach(&ctx, replay);
     LOGI("[UI] Shutdown complete");
     log_close();
     
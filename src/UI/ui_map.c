@@ -5,15 +5,13 @@
 #include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
-#include <sys/msg.h>
 #include <errno.h>
 #include <ncurses.h>
 
 #include "UI/ui.h"
 #include "UI/ui_map.h"
 #include "ipc/shared.h"
-#include "ipc/ipc_mesq.h"
-#include "ipc/semaphores.h"
+#include "ipc/ui_frame.h"
 #include "log.h"
 #include "error_handler.h"
 
@@ -22,8 +20,152 @@
 #define COLOR_CIS       2
 #define COLOR_NEUTRAL   3
 
-/* Render the map grid */
-static void render_map(ui_context_t *ui_ctx, unit_id_t grid[M][N], uint32_t tick) {
+/* Screen cell of the map: glyph + color pair (0 = default colors) */
+typedef struct {
+    char ch;
+    uint8_t color;
+} map_cell_t;
+
+/* Viewport of one render, clamped to the map and window */
+typedef struct {
+    int level;          // 0 = grid cells, L = mipmap level L
+    int vx, vy;         // top-left, in units of the level
+    int vis_w, vis_h;   // visible size, in units of the level (= screen cells)
+    int content_w, content_h;
+} map_view_t;
+
+/* Map as last drawn on screen: diff base for incremental rendering */
+typedef struct {
+    map_cell_t cells[N][M];
+    map_view_t view;            // view it was drawn for
+    uint32_t epoch;             // frame epoch it shows
+    uint32_t redraw_gen;        // redraw generation it was drawn for
+    int valid;
+    uint64_t cells_written;     // stats, logged on thread exit
+    uint64_t bytes_read;
+    uint64_t renders;
+} map_screen_t;
+
+static map_screen_t g_screen;
+
+/* Worlds bigger than the default 120x40: at 1:1 only diff tiles CC stamped as
+ * changed since the drawn frame, instead of every visible cell */
+#define UI_MAP_TILE_DRIVEN (M * N > 120 * 40)
+
+#define COLOR_CONTESTED 4
+
+static uint8_t faction_color(uint8_t faction) {
+    if (faction == FACTION_REPUBLIC) return COLOR_REPUBLIC;
+    if (faction == FACTION_CIS) return COLOR_CIS;
+    return 0;
+}
+
+static map_cell_t grid_cell(const ui_frame_t *frame, unit_id_t cell) {
+    if (cell == 0) return (map_cell_t){ '.', 0 };
+    if (cell < 0) return (map_cell_t){ '#', 0 };    // Obstacle
+    return (map_cell_t){ (char)('0' + (cell % 10)), faction_color(frame->units[cell].faction) };
+}
+
+/* Downsampled cell: 'B' capital ships, 's' squadrons, '*' both factions, '#' obstacles only */
+static map_cell_t mip_cell(const ui_mip_tile_t *t) {
+    int rep = t->n[UI_MIP_REP_CAPITAL] + t->n[UI_MIP_REP_CRAFT];
+    int cis = t->n[UI_MIP_CIS_CAPITAL] + t->n[UI_MIP_CIS_CRAFT];
+    if (rep && cis) return (map_cell_t){ '*', COLOR_CONTESTED };
+    if (rep) return (map_cell_t){ t->n[UI_MIP_REP_CAPITAL] ? 'B' : 's', COLOR_REPUBLIC };
+    if (cis) return (map_cell_t){ t->n[UI_MIP_CIS_CAPITAL] ? 'B' : 's', COLOR_CIS };
+    if (t->n[UI_MIP_OBSTACLE]) return (map_cell_t){ '#', 0 };
+    return (map_cell_t){ '.', 0 };
+}
+
+static map_cell_t view_cell(const ui_frame_t *frame, const map_view_t *v, int sx, int sy) {
+    int x = v->vx + sx, y = v->vy + sy;
+    if (v->level == 0) return grid_cell(frame, frame->grid[x][y]);
+    return mip_cell(&frame->mip[ui_mip_index(v->level, x, y)]);
+}
+
+/* Redraw screen cells of row sy in [x0, x1) that differ from the screen (all if force),
+ * as runs of the same color: one move + one attribute switch per run.
+ * Returns number of cells written. */
+static int draw_row_diff(WINDOW *win, const ui_frame_t *frame, const map_view_t *v,
+                         int sy, int x0, int x1, int force) {
+    int written = 0;
+    int sx = x0;
+    
+    while (sx < x1) {
+        map_cell_t c = view_cell(frame, v, sx, sy);
+        map_cell_t *prev = &g_screen.cells[sy][sx];
+        if (!force && c.ch == prev->ch && c.color == prev->color) {
+            sx++;
+            continue;
+        }
+        
+        /* extend run while cells are changed and keep the same color */
+        char run[M];
+        int n = 0;
+        int start = sx;
+        uint8_t color = c.color;
+        while (sx < x1) {
+            c = view_cell(frame, v, sx, sy);
+            prev = &g_screen.cells[sy][sx];
+            if (c.color != color) break;
+            if (!force && c.ch == prev->ch && c.color == prev->color) break;
+            run[n++] = c.ch;
+            *prev = c;
+            sx++;
+        }
+        
+        if (color) wattron(win, COLOR_PAIR(color));
+        mvwaddnstr(win, 1 + sy, 1 + start, run, n);
+        if (color) wattroff(win, COLOR_PAIR(color));
+        written += n;
+    }
+    return written;
+}
+
+/* Smallest mipmap level at which the whole map fits content_w x content_h */
+static int fit_level(int content_w, int content_h) {
+    for (int l = 0; l < UI_MIP_LEVELS; l++) {
+        int w = l ? UI_MIP_W(l) : M;
+        int h = l ? UI_MIP_H(l) : N;
+        if (w <= content_w && h <= content_h) return l;
+    }
+    return UI_MIP_LEVELS;
+}
+
+/* Clamp the requested viewport to the window and map; writes the clamped
+ * origin back so panning cannot run off the map. Caller holds ui_lock. */
+static void map_view_get(ui_context_t *ui_ctx, map_view_t *v) {
+    int win_h = 2, win_w = 2;
+    if (ui_ctx->map_win) getmaxyx(ui_ctx->map_win, win_h, win_w);
+    v->content_w = win_w - 2 > 0 ? win_w - 2 : 0;
+    v->content_h = win_h - 2 > 0 ? win_h - 2 : 0;
+    
+    int level = ui_ctx->view_level;
+    if (level < 0) level = 0;
+    if (level > UI_MIP_LEVELS) level = UI_MIP_LEVELS;
+    int lw = level ? UI_MIP_W(level) : M;
+    int lh = level ? UI_MIP_H(level) : N;
+    
+    int vx = ui_ctx->view_x >> level;
+    int vy = ui_ctx->view_y >> level;
+    if (vx > lw - v->content_w) vx = lw - v->content_w;
+    if (vy > lh - v->content_h) vy = lh - v->content_h;
+    if (vx < 0) vx = 0;
+    if (vy < 0) vy = 0;
+    
+    v->level = level;
+    v->vx = vx;
+    v->vy = vy;
+    v->vis_w = (lw - vx < v->content_w) ? lw - vx : v->content_w;
+    v->vis_h = (lh - vy < v->content_h) ? lh - vy : v->content_h;
+    
+    ui_ctx->view_level = level;
+    ui_ctx->view_x = vx << level;
+    ui_ctx->view_y = vy << level;
+}
+
+/* Render the map: full redraw after resize/view change, otherwise only changed cells */
+static void render_map(ui_context_t *ui_ctx, const ui_frame_t *frame, const map_view_t *v) {
     pthread_mutex_lock(&ui_ctx->ui_lock);
     
     WINDOW *win = ui_ctx->map_win;
@@ -34,162 +176,139 @@ static void render_map(ui_context_t *ui_ctx, unit_id_t grid[M][N], uint32_t tick
     
     int win_h, win_w;
     getmaxyx(win, win_h, win_w);
-    
-    /* Clear content area (preserve border) */
-    for (int y = 1; y < win_h - 1; y++) {
-        wmove(win, y, 1);
-        for (int x = 1; x < win_w - 1; x++) {
-            waddch(win, ' ');
-        }
-    }
-    
-    /* Calculate available display area (excluding borders) */
-    int content_h = win_h - 2;
-    int content_w = win_w - 2;
+    (void)win_h;
     
     /* Debug: log actual window and content dimensions */
     static int logged = 0;
     if (!logged) {
-        LOGI("[UI-MAP] Window size: %dx%d, Content size: %dx%d, Grid: %dx%d", 
-             win_w, win_h, content_w, content_h, M, N);
-        
-        /* Count non-empty cells to verify we're reading the grid correctly */
-        int non_empty = 0;
-        for (int y = 0; y < N; y++) {
-            for (int x = 0; x < M; x++) {
-                if (grid[x][y] != 0) non_empty++;
-            }
-        }
-        LOGI("[UI-MAP] Non-empty cells in grid: %d", non_empty);
+        LOGI("[UI-MAP] Window size: %dx%d, Content size: %dx%d, Grid: %dx%d%s", 
+             win_w, win_h, v->content_w, v->content_h, M, N,
+             UI_MAP_TILE_DRIVEN ? " (tile-driven diff)" : "");
         logged = 1;
     }
     
-    /* Draw grid at 1:1 scale (one cell = one character) */
-    int cells_drawn = 0;
-    for (int gy = 0; gy < N && gy < content_h; gy++) {
-        for (int gx = 0; gx < M && gx < content_w; gx++) {
-            unit_id_t cell = grid[gx][gy];
-            
-            int wy = 1 + gy;
-            int wx = 1 + gx;
-            
-            cells_drawn++;
-            
-            /* Draw cell */
-            if (cell == 0) {
-                mvwaddch(win, wy, wx, '.');
-            } else if (cell < 0) {
-                mvwaddch(win, wy, wx, '#');  // Obstacle
-            } else {
-                /* Get unit info from shared memory */
-                uint8_t faction = ui_ctx->ctx->S->units[cell].faction;
-                
-                /* Apply color based on faction */
-                if (faction == FACTION_REPUBLIC) {
-                    wattron(win, COLOR_PAIR(COLOR_REPUBLIC));
-                    mvwaddch(win, wy, wx, '0' + (cell % 10));
-                    wattroff(win, COLOR_PAIR(COLOR_REPUBLIC));
-                } else if (faction == FACTION_CIS) {
-                    wattron(win, COLOR_PAIR(COLOR_CIS));
-                    mvwaddch(win, wy, wx, '0' + (cell % 10));
-                    wattroff(win, COLOR_PAIR(COLOR_CIS));
-                } else {
-                    mvwaddch(win, wy, wx, '0' + (cell % 10));
-                }
-            }
-        }
-    }
+    uint32_t gen = __atomic_load_n(&ui_ctx->redraw_gen, __ATOMIC_ACQUIRE);
+    int full = !g_screen.valid || g_screen.redraw_gen != gen ||
+               memcmp(&g_screen.view, v, sizeof(*v)) != 0;
     
-    /* Debug: log draw statistics */
-    if (!logged) {
-        LOGI("[UI-MAP] Drew %d cells (expected %d x %d = %d)", 
-             cells_drawn, 
-             (M < content_w ? M : content_w),
-             (N < content_h ? N : content_h),
-             (M < content_w ? M : content_w) * (N < content_h ? N : content_h));
+    if (full) {
+        werase(win);
+        box(win, 0, 0);
+        /* Title: scale, and visible window if the map is clipped */
+        int lw = v->level ? UI_MIP_W(v->level) : M;
+        int lh = v->level ? UI_MIP_H(v->level) : N;
+        if (v->vis_w < lw || v->vis_h < lh) {
+            mvwprintw(win, 0, 2, " MAP %dx%d 1:%d @(%d,%d) ", M, N, 1 << v->level,
+                      v->vx << v->level, v->vy << v->level);
+        } else {
+            mvwprintw(win, 0, 2, " MAP %dx%d (1:%d) ", M, N, 1 << v->level);
+        }
     }
     
-    /* Note if map is clipped */
-    int clipped_x = (M > content_w) ? 1 : 0;
-    int clipped_y = (N > content_h) ? 1 : 0;
-    
-    /* Redraw border and title */
-    box(win, 0, 0);
-    if (clipped_x || clipped_y) {
-        mvwprintw(win, 0, 2, " MAP %dx%d (showing %dx%d) ", 
-                  M, N, 
-                  (M > content_w) ? content_w : M, 
-                  (N > content_h) ? content_h : N);
+    int written = 0;
+    if (!full && v->level == 0 && UI_MAP_TILE_DRIVEN) {
+        /* only tiles stamped since the frame on screen */
+        for (int tx = v->vx / UI_TILE; tx * UI_TILE < v->vx + v->vis_w && tx < UI_TILES_X; tx++) {
+            int x0 = tx * UI_TILE - v->vx;
+            int x1 = x0 + UI_TILE;
+            if (x0 < 0) x0 = 0;
+            if (x1 > v->vis_w) x1 = v->vis_w;
+            for (int ty = v->vy / UI_TILE; ty * UI_TILE < v->vy + v->vis_h && ty < UI_TILES_Y; ty++) {
+                if ((int32_t)(frame->tile_epoch[tx][ty] - g_screen.epoch) <= 0) continue;
+                int y0 = ty * UI_TILE - v->vy;
+                int y1 = y0 + UI_TILE;
+                if (y0 < 0) y0 = 0;
+                if (y1 > v->vis_h) y1 = v->vis_h;
+                for (int sy = y0; sy < y1; sy++)
+                    written += draw_row_diff(win, frame, v, sy, x0, x1, 0);
+            }
+        }
     } else {
-        mvwprintw(win, 0, 2, " MAP %dx%d (1:1) ", M, N);
+        for (int sy = 0; sy < v->vis_h; sy++)
+            written += draw_row_diff(win, frame, v, sy, 0, v->vis_w, full);
     }
     
+    g_screen.valid = 1;
+    g_screen.redraw_gen = gen;
+    g_screen.view = *v;
+    g_screen.epoch = frame->epoch;
+    g_screen.cells_written += (uint64_t)written;
+    g_screen.renders++;
+    
     /* Show tick in header */
-    mvwprintw(win, 0, win_w - 15, " Tick:%u ", tick);
+    mvwprintw(win, 0, win_w - 15, " Tick:%u ", frame->tick);
+    
+    wrefresh(win);
+    pthread_mutex_unlock(&ui_ctx->ui_lock);
+}
+
+int ui_map_handle_key(ui_context_t *ui_ctx, int ch) {
+    pthread_mutex_lock(&ui_ctx->ui_lock);
+    map_view_t v;
+    map_view_get(ui_ctx, &v);
+    
+    /* pan step: a quarter of the window, in grid cells */
+    int step_x = ((v.content_w / 4) > 0 ? v.content_w / 4 : 1) << v.level;
+    int step_y = ((v.content_h / 4) > 0 ? v.content_h / 4 : 1) << v.level;
+    int handled = 1;
     
+    switch (ch) {
+        case '+': case '=':
+            if (ui_ctx->view_level > 0) ui_ctx->view_level--;
+            break;
+        case '-': case '_':
+            if (ui_ctx->view_level < UI_MIP_LEVELS) ui_ctx->view_level++;
+            break;
+        case 'f': case 'F':
+            ui_ctx->view_level = fit_level(v.content_w, v.content_h);
+            ui_ctx->view_x = 0;
+            ui_ctx->view_y = 0;
+            break;
+        case KEY_LEFT:  ui_ctx->view_x -= step_x; break;
+        case KEY_RIGHT: ui_ctx->view_x += step_x; break;
+        case KEY_UP:    ui_ctx->view_y -= step_y; break;
+        case KEY_DOWN:  ui_ctx->view_y += step_y; break;
+        default:
+            handled = 0;
+            break;
+    }
+    if (handled) map_view_get(ui_ctx, &v);
     pthread_mutex_unlock(&ui_ctx->ui_lock);
+    
+    if (handled) __atomic_add_fetch(&ui_ctx->redraw_gen, 1, __ATOMIC_RELEASE);
+    return handled;
 }
 
 void* ui_map_thread(void* arg) {
     ui_context_t *ui_ctx = (ui_context_t*)arg;
-    uint32_t last_tick = 0;
+    static ui_frame_t frame;
+    ui_pacer_t pacer;
     
-    LOGI("[UI-MAP] Thread started, sending requests to CC");
+    LOGI("[UI-MAP] Thread started, reading frames published by CC");
     
-    /* Request-response loop */
-    while (!ui_ctx->stop) {
-        /* Send request for map snapshot */
-        mq_ui_map_req_t req;
-        req.mtype = MSG_UI_MAP_REQ;
-        req.sender = getpid();
+    /* Render on tick advance, resize or view change, capped at max_fps: no lock, no message */
+    ui_pacer_init(ui_ctx, &pacer);
+    while (ui_pacer_wait(ui_ctx, &pacer)) {
+        if (ui_ctx->ctx->S->frame.seq == 0) continue;  // nothing published yet
         
-        if (mq_send_ui_map_req(ui_ctx->ctx->q_req, &req) == 0) {
-            /* Wait for response (blocking with timeout) */
-            mq_ui_map_rep_t rep;
-            int ret = mq_recv_ui_map_rep_blocking(ui_ctx->ctx->q_rep, &rep);
-            
-            if (ret > 0 && rep.ready) {
-                /* Got notification, read grid from shared memory */
-                int lock_ret = sem_lock(ui_ctx->ctx->sem_id, SEM_GLOBAL_LOCK);
-                if (lock_ret == 0) {
-                    /* Copy grid from shared memory */
-                    unit_id_t grid_snapshot[M][N];
-                    memcpy(grid_snapshot, ui_ctx->ctx->S->grid, sizeof(grid_snapshot));
-                    uint32_t tick = ui_ctx->ctx->S->ticks;
-                    sem_unlock(ui_ctx->ctx->sem_id, SEM_GLOBAL_LOCK);
-                    
-                    /* Update display */
-                    last_tick = tick;
-                    render_map(ui_ctx, grid_snapshot, last_tick);
-                } else if (errno == EINVAL) {
-                    /* Semaphore destroyed - IPC resources gone, exit gracefully */
-                    LOGI("[UI-MAP] IPC resources destroyed, exiting");
-                    ui_ctx->stop = 1;
-                    break;
-                }
-            } else if (!ui_ctx->stop) {
-                /* Check if message queue was destroyed */
-                if (errno == EINVAL || errno == EIDRM) {
-                    LOGI("[UI-MAP] Message queue destroyed, exiting");
-                    ui_ctx->stop = 1;
-                    break;
-                }
-                LOGW("[UI-MAP] Failed to receive response");
-            }
-        } else if (!ui_ctx->stop) {
-            /* Check if message queue was destroyed */
-            if (errno == EINVAL || errno == EIDRM) {
-                LOGI("[UI-MAP] Message queue destroyed, exiting");
-                ui_ctx->stop = 1;
-                break;
-            }
-            LOGW("[UI-MAP] Failed to send request");
-        }
+        map_view_t v;
+        pthread_mutex_lock(&ui_ctx->ui_lock);
+        map_view_get(ui_ctx, &v);
+        pthread_mutex_unlock(&ui_ctx->ui_lock);
         
-        /* Wait before next request */
-        //usleep(200000);  // 200ms = 5 updates/sec
+        /* copy only what is visible at the current level of detail */
+        if (ui_frame_read_region(ui_ctx->ctx->S, &frame, v.level, v.vx, v.vy, v.vis_w, v.vis_h) != 0) {
+            LOGW("[UI-MAP] Frame kept changing while copying, skipping");
+            continue;
+        }
+        g_screen.bytes_read += (uint64_t)v.vis_w * (uint64_t)v.vis_h *
+                               (v.level ? sizeof(ui_mip_tile_t) : sizeof(unit_id_t));
+        render_map(ui_ctx, &frame, &v);
     }
     
-    LOGI("[UI-MAP] Thread exiting");
+    LOGI("[UI-MAP] Thread exiting (%u renders, %.1f cells written, %.0f map bytes read per render)",
+         pacer.renders,
+         g_screen.renders ? (double)g_screen.cells_written / (double)g_screen.renders : 0.0,
+         g_screen.renders ? (double)g_screen.bytes_read / (double)g_screen.renders : 0.0);
     return NULL;
 }
@@ -0,0 +1,88 @@
+// UI PRF thread - displays per-phase tick timing aggregated by CC
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <string.h>
+#include <ncurses.h>
+
+#include "UI/ui.h"
+#include "UI/ui_prf.h"
+#include "ipc/shared.h"
+#include "ipc/phase_prof.h"
+#include "log.h"
+
+/* ns as a short duration: "812ns", "45.3us", "12.1ms" (fits 7 chars) */
+static void fmt_ns(char *buf, size_t size, uint32_t ns) {
+    if (ns < 1000) snprintf(buf, size, "%uns", ns);
+    else if (ns < 1000000) snprintf(buf, size, "%.1fus", ns / 1e3);
+    else snprintf(buf, size, "%.1fms", ns / 1e6);
+}
+
+/* Render phase table: one row per phase that ran in the window */
+static void render_prf(ui_context_t *ui_ctx) {
+    pthread_mutex_lock(&ui_ctx->ui_lock);
+
+    WINDOW *win = ui_ctx->prf_win;
+    if (!win) {
+        pthread_mutex_unlock(&ui_ctx->ui_lock);
+        return;
+    }
+
+    int win_h, win_w;
+    getmaxyx(win, win_h, win_w);
+
+    werase(win);
+    box(win, 0, 0);
+    mvwprintw(win, 0, 2, " TICK PHASES ");
+
+    prof_summary_t sum;
+    if (prof_summary_read(ui_ctx->ctx->S, &sum) != 0 || sum.window == 0) {
+        wrefresh(win);
+        pthread_mutex_unlock(&ui_ctx->ui_lock);
+        return;
+    }
+    if (win_w > 30) mvwprintw(win, 0, win_w - 16, " last %u ticks ", sum.window);
+
+    int row = 1;
+    if (win_h > 2 && win_w > 40) {
+        wattron(win, A_BOLD);
+        mvwprintw(win, row++, 1, "Phase            n     min     avg     p99     max");
+        wattroff(win, A_BOLD);
+    }
+
+    for (int ph = 0; ph < PROF_PHASES && row < win_h - 1; ph++) {
+        const prof_stat_t *st = &sum.ph[ph];
+        if (!st->n) continue;
+        char mn[16], av[16], p99[16], mx[16];
+        fmt_ns(mn, sizeof(mn), st->min_ns);
+        fmt_ns(av, sizeof(av), st->avg_ns);
+        fmt_ns(p99, sizeof(p99), st->p99_ns);
+        fmt_ns(mx, sizeof(mx), st->max_ns);
+
+        /* CC phases in yellow, units' in the default color */
+        int cc = ph >= PROF_CC_LOCK_WAIT;
+        if (cc) wattron(win, COLOR_PAIR(4));
+        mvwprintw(win, row++, 1, "%-13s %5u %7s %7s %7s %7s",
+                  prof_phase_name((prof_phase_t)ph), st->n, mn, av, p99, mx);
+        if (cc) wattroff(win, COLOR_PAIR(4));
+    }
+
+    wrefresh(win);
+    pthread_mutex_unlock(&ui_ctx->ui_lock);
+}
+
+void* ui_prf_thread(void* arg) {
+    ui_context_t *ui_ctx = (ui_context_t*)arg;
+
+    LOGI("[UI-PRF] Thread started");
+
+    /* Render on tick advance or resize, capped at max_fps */
+    ui_pacer_t pacer;
+    ui_pacer_init(ui_ctx, &pacer);
+    while (ui_pacer_wait(ui_ctx, &pacer)) {
+        render_prf(ui_ctx);
+    }
+
+    LOGI("[UI-PRF] Thread exiting (%u renders)", pacer.renders);
+    return NULL;
+}
@@ -0,0 +1,349 @@
+// UI replay player - plays a battle recording into the UI windows
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <ncurses.h>
+
+#include "UI/ui.h"
+#include "UI/ui_replay.h"
+#include "ipc/recording.h"
+#include "ipc/ui_frame.h"
+#include "log.h"
+
+/* ticks skipped by '<' / '>' */
+#define REPLAY_SEEK_STEP 100
+#define REPLAY_SPEED_MIN 0.25
+#define REPLAY_SPEED_MAX 1000.0
+/* longest sleep between checks for keys and stop */
+#define REPLAY_POLL_NS 20000000ull
+
+struct ui_replay {
+    const uint8_t *map;
+    size_t len;
+    rec_header_t h;
+    size_t *off;            // file offset of record i (record i = i-th recorded tick)
+    uint8_t *kind;          // REC_KEY / REC_DELTA of record i
+    int count;
+
+    /* requests from the main thread, under mu */
+    pthread_mutex_t mu;
+    int paused;
+    int step;
+    int seek;               // record index to jump to, -1 none
+    double speed;           // ticks per second
+
+    /* player thread only */
+    rec_state_t st, prev;
+    int pos;                // record applied to st, -1 none
+    int out_line;           // next line in std_win
+};
+
+static const char *type_name(int64_t type) {
+    switch (type) {
+        case TYPE_FLAGSHIP:  return "Flagship";
+        case TYPE_DESTROYER: return "Destroyer";
+        case TYPE_CARRIER:   return "Carrier";
+        case TYPE_FIGHTER:   return "Fighter";
+        case TYPE_BOMBER:    return "Bomber";
+        case TYPE_ELITE:     return "Elite";
+        default:             return "Unknown";
+    }
+}
+
+static const char *faction_name(int64_t faction) {
+    return faction == FACTION_REPUBLIC ? "Republic" : faction == FACTION_CIS ? "CIS" : "None";
+}
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+ui_replay_t *ui_replay_open(const char *path, double ticks_per_s) {
+    int fd = open(path, O_RDONLY);
+    if (fd == -1) {
+        fprintf(stderr, "[UI] %s: %s\n", path, strerror(errno));
+        return NULL;
+    }
+    struct stat sb;
+    if (fstat(fd, &sb) == -1 || sb.st_size < REC_HEADER_SIZE) {
+        fprintf(stderr, "[UI] %s: not a battle recording\n", path);
+        close(fd);
+        return NULL;
+    }
+    void *map = mmap(NULL, (size_t)sb.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        fprintf(stderr, "[UI] mmap %s: %s\n", path, strerror(errno));
+        return NULL;
+    }
+
+    ui_replay_t *rp = calloc(1, sizeof(*rp));
+    if (!rp) {
+        munmap(map, (size_t)sb.st_size);
+        return NULL;
+    }
+    rp->map = map;
+    rp->len = (size_t)sb.st_size;
+    pthread_mutex_init(&rp->mu, NULL);
+    rp->seek = -1;
+    rp->pos = -1;
+    rp->speed = ticks_per_s > 0 ? ticks_per_s : 1.0;
+
+    if (rec_header_read(&rp->h, rp->map, rp->len) != 0) {
+        fprintf(stderr, "[UI] %s: not a recording of this build (magic or M/N/MAX_UNITS differ)\n", path);
+        ui_replay_close(rp);
+        return NULL;
+    }
+
+    /* index every record once; seeking then never scans the file */
+    int cap = 0;
+    size_t off = REC_HEADER_SIZE;
+    uint8_t kind;
+    const uint8_t *payload;
+    size_t plen;
+    size_t at = off;
+    int r;
+    while ((r = rec_next(rp->map, rp->len, &off, &kind, &payload, &plen)) == 1) {
+        if (rp->count == cap) {
+            cap = cap ? cap * 2 : 1024;
+            size_t *o = realloc(rp->off, sizeof(*o) * (size_t)cap);
+            uint8_t *k = o ? realloc(rp->kind, (size_t)cap) : NULL;
+            if (o) rp->off = o;
+            if (!o || !k) {
+                fprintf(stderr, "[UI] out of memory indexing %s\n", path);
+                ui_replay_close(rp);
+                return NULL;
+            }
+            rp->kind = k;
+        }
+        rp->off[rp->count] = at;
+        rp->kind[rp->count] = kind;
+        rp->count++;
+        at = off;
+    }
+    if (r == -1) LOGW("[UI-REPLAY] %s: truncated after %d records (CC killed while writing?)", path, rp->count);
+    if (rp->count == 0 || rp->kind[0] != REC_KEY) {
+        fprintf(stderr, "[UI] %s: no ticks recorded\n", path);
+        ui_replay_close(rp);
+        return NULL;
+    }
+    LOGI("[UI-REPLAY] %s: scenario '%s' seed=%llu, %d ticks, keyframe every %u",
+         path, rp->h.scenario, (unsigned long long)rp->h.seed, rp->count, rp->h.key_every);
+    return rp;
+}
+
+void ui_replay_close(ui_replay_t *rp) {
+    if (!rp) return;
+    if (rp->map) munmap((void *)rp->map, rp->len);
+    pthread_mutex_destroy(&rp->mu);
+    free(rp->off);
+    free(rp->kind);
+    free(rp);
+}
+
+/* One line into the OUTPUT window, scrolling like the STD thread does. */
+static void out_line(ui_context_t *ui_ctx, const char *fmt, ...) {
+    ui_replay_t *rp = ui_ctx->replay;
+    char buf[256];
+    va_list ap;
+    va_start(ap, fmt);
+    vsnprintf(buf, sizeof(buf), fmt, ap);
+    va_end(ap);
+
+    pthread_mutex_lock(&ui_ctx->ui_lock);
+    WINDOW *win = ui_ctx->std_win;
+    if (win) {
+        int max_y, max_x;
+        getmaxyx(win, max_y, max_x);
+        if (rp->out_line < 1) rp->out_line = 1;
+        if (rp->out_line >= max_y - 1) {
+            wscrl(win, 1);
+            rp->out_line = max_y - 2;
+        }
+        wmove(win, rp->out_line, 1);
+        wclrtoeol(win);
+        mvwprintw(win, rp->out_line, 1, "%.*s", max_x > 2 ? max_x - 2 : 0, buf);
+        rp->out_line++;
+        box(win, 0, 0);
+    }
+    pthread_mutex_unlock(&ui_ctx->ui_lock);
+}
+
+static int apply_record(ui_replay_t *rp, int i) {
+    size_t off = rp->off[i];
+    uint8_t kind;
+    const uint8_t *payload;
+    size_t plen;
+    if (rec_next(rp->map, rp->len, &off, &kind, &payload, &plen) != 1) return -1;
+    return rec_apply(&rp->st, kind, payload, plen);
+}
+
+/* Bring st to record target: the next record directly, anything else from
+ * the last keyframe at or before it. */
+static int go_to(ui_replay_t *rp, int target) {
+    int from = rp->pos + 1;
+    if (target != rp->pos + 1) {
+        from = target;
+        while (from > 0 && rp->kind[from] != REC_KEY) from--;
+    }
+    for (int i = from; i <= target; i++) {
+        if (apply_record(rp, i) != 0) return -1;
+    }
+    rp->pos = target;
+    return 0;
+}
+
+/* Spawns, deaths and hits between prev and st (sequential playback only). */
+static void report_events(ui_context_t *ui_ctx) {
+    ui_replay_t *rp = ui_ctx->replay;
+    const rec_state_t *a = &rp->prev, *b = &rp->st;
+    for (int id = 1; id <= MAX_UNITS; id++) {
+        const int64_t *u0 = a->unit[id], *u1 = b->unit[id];
+        if (!u0[REC_U_ALIVE] && u1[REC_U_ALIVE]) {
+            out_line(ui_ctx, "[%u] #%d %s %s spawned at (%lld,%lld)", b->tick, id,
+                     faction_name(u1[REC_U_FACTION]), type_name(u1[REC_U_TYPE]),
+                     (long long)u1[REC_U_X], (long long)u1[REC_U_Y]);
+        } else if (u0[REC_U_ALIVE] && !u1[REC_U_ALIVE]) {
+            out_line(ui_ctx, "[%u] #%d %s %s destroyed", b->tick, id,
+                     faction_name(u0[REC_U_FACTION]), type_name(u0[REC_U_TYPE]));
+        }
+    }
+    if (b->hit_count) {
+        long long total = 0;
+        int top = 0;
+        for (int i = 0; i < b->hit_count; i++) {
+            total += b->hits[i].dmg;
+            if (b->hits[i].dmg > b->hits[top].dmg) top = i;
+        }
+        out_line(ui_ctx, "[%u] %u hits, %lld damage (largest #%d -> #%d: %d)", b->tick, b->hit_count,
+                 total, b->hits[top].attacker, b->hits[top].target, (int)b->hits[top].dmg);
+    }
+}
+
+static void show_status(ui_context_t *ui_ctx, int paused, double speed) {
+    ui_replay_t *rp = ui_ctx->replay;
+    pthread_mutex_lock(&ui_ctx->ui_lock);
+    if (ui_ctx->std_win) {
+        int max_x = getmaxx(ui_ctx->std_win);
+        mvwhline(ui_ctx->std_win, 0, 1, ACS_HLINE, max_x > 2 ? max_x - 2 : 0);
+        mvwprintw(ui_ctx->std_win, 0, 2, " REPLAY %s  tick %u (%d/%d)  %.2f ticks/s%s ",
+                  rp->h.scenario, rp->st.tick, rp->pos + 1, rp->count, speed, paused ? "  PAUSED" : "");
+    }
+    pthread_mutex_unlock(&ui_ctx->ui_lock);
+}
+
+void *ui_replay_thread(void *arg) {
+    ui_context_t *ui_ctx = (ui_context_t *)arg;
+    ui_replay_t *rp = ui_ctx->replay;
+    shm_state_t *S = ui_ctx->ctx->S;
+    uint64_t next_ns = now_ns();
+    uint32_t shown = 0;
+
+    LOGI("[UI-REPLAY] Player started");
+    out_line(ui_ctx, "Replay '%s' seed=%llu: %d ticks. space pause, [ ] speed, . step, < > seek, 0-9 jump",
+             rp->h.scenario, (unsigned long long)rp->h.seed, rp->count);
+
+    while (!ui_ctx->stop) {
+        pthread_mutex_lock(&rp->mu);
+        int target = -1;
+        int seeking = 0;
+        if (rp->seek >= 0) {
+            target = rp->seek;
+            seeking = 1;
+            rp->seek = -1;
+        } else if (rp->step) {
+            target = rp->pos + 1;
+        } else if (!rp->paused && now_ns() >= next_ns) {
+            target = rp->pos + 1;
+            next_ns += (uint64_t)(1e9 / rp->speed);
+        }
+        rp->step = 0;
+        if (target >= rp->count) {          // end of the recording: stay on the last tick
+            target = seeking ? rp->count - 1 : -1;
+            if (!rp->paused && !seeking) {
+                rp->paused = 1;
+                pthread_mutex_unlock(&rp->mu);
+                out_line(ui_ctx, "[%u] end of recording", rp->st.tick);
+                pthread_mutex_lock(&rp->mu);
+            }
+        }
+        if (target < 0 && seeking) target = 0;
+        int paused = rp->paused;
+        double speed = rp->speed;
+        pthread_mutex_unlock(&rp->mu);
+
+        if (target >= 0 && target != rp->pos) {
+            int sequential = (target == rp->pos + 1);
+            if (sequential) rp->prev = rp->st;
+            if (go_to(rp, target) != 0) {
+                out_line(ui_ctx, "record %d is malformed, playback stopped", target);
+                LOGE("[UI-REPLAY] malformed record %d", target);
+                /* st is undefined now: play only up to the record before */
+                pthread_mutex_lock(&rp->mu);
+                rp->paused = 1;
+                if (target > 0) {
+                    rp->count = target;
+                    rp->seek = target - 1;
+                }
+                pthread_mutex_unlock(&rp->mu);
+                rp->pos = -1;
+                continue;
+            }
+            if (!sequential) out_line(ui_ctx, "[%u] jumped here", rp->st.tick);
+            else if (target > 0) report_events(ui_ctx);
+
+            /* same publication path as CC: MAP/UST wake on tick_epoch */
+            rec_state_publish(&rp->st, S);
+            ui_frame_publish(S);
+            shown++;
+        }
+        show_status(ui_ctx, paused, speed);
+
+        /* sleep until the next tick is due, but keep reacting to keys */
+        uint64_t now = now_ns();
+        uint64_t wait = REPLAY_POLL_NS;
+        if (paused) next_ns = now;
+        else if (next_ns > now && next_ns - now < wait) wait = next_ns - now;
+        else if (next_ns <= now) wait = 0;
+        if (!paused && now > next_ns + 1000000000ull) next_ns = now;   // do not race to catch up
+        if (wait) {
+            struct timespec ts = { 0, (long)wait };
+            nanosleep(&ts, NULL);
+        }
+    }
+
+    LOGI("[UI-REPLAY] Player exiting (%u ticks shown)", shown);
+    return NULL;
+}
+
+int ui_replay_handle_key(ui_context_t *ui_ctx, int ch) {
+    ui_replay_t *rp = ui_ctx->replay;
+    if (!rp) return 0;
+    int handled = 1;
+    pthread_mutex_lock(&rp->mu);
+    int from = rp->seek >= 0 ? rp->seek : rp->pos;
+    switch (ch) {
+    case ' ': rp->paused = !rp->paused; break;
+    case ']': if (rp->speed * 2 <= REPLAY_SPEED_MAX) rp->speed *= 2; break;
+    case '[': if (rp->speed / 2 >= REPLAY_SPEED_MIN) rp->speed /= 2; break;
+    case '.': rp->paused = 1; rp->step = 1; break;
+    case '>': rp->seek = from + REPLAY_SEEK_STEP < rp->count ? from + REPLAY_SEEK_STEP : rp->count - 1; break;
+    case '<': rp->seek = from - REPLAY_SEEK_STEP > 0 ? from - REPLAY_SEEK_STEP : 0; break;
+    default:
+        if (ch >= '0' && ch <= '9') rp->seek = (int)((long long)(rp->count - 1) * (ch - '0') / 9);
+        else handled = 0;
+    }
+    pthread_mutex_unlock(&rp->mu);
+    return handled;
+}
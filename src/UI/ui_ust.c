@@ -10,7 +10,8 @@
 #include "UI/ui.h"
 #include "UI/ui_ust.h"
 #include "ipc/shared.h"
-#include "ipc/semaphores.h"
+#include "ipc/ui_frame.h"
+#include "ipc/telemetry.h"
 #include "log.h"
 #include "error_handler.h"
 
@@ -40,6 +41,26 @@ static const char* get_faction_name(uint8_t faction) {
     }
 }
 
+/* Helper to get short order name */
+static const char* get_order_name(uint8_t order) {
+    switch (order) {
+        case DO_NOTHING:  return "IDL";
+        case PATROL:      return "PAT";
+        case ATTACK:      return "ATK";
+        case MOVE:        return "MOV";
+        case MOVE_ATTACK: return "MAT";
+        case GUARD:       return "GRD";
+        default:          return "?";
+    }
+}
+
+/* Percentage of cur in max, clamped to 0..999 (-1 if max unknown) */
+static int pct(st_points_t cur, st_points_t max) {
+    if (max <= 0) return -1;
+    long p = (long)cur * 100 / max;
+    return p < 0 ? 0 : (p > 999 ? 999 : (int)p);
+}
+
 /* Render unit statistics table */
 static void render_ust(ui_context_t *ui_ctx) {
     pthread_mutex_lock(&ui_ctx->ui_lock);
@@ -58,30 +79,17 @@ static void render_ust(ui_context_t *ui_ctx) {
     box(win, 0, 0);
     mvwprintw(win, 0, 2, " UNIT STATS ");
     
-    /* Lock shared memory and read unit data */
-    int lock_ret = sem_lock(ui_ctx->ctx->sem_id, SEM_GLOBAL_LOCK);
-    if (lock_ret != 0) {
-        if (errno == EINVAL) {
-            /* Semaphore destroyed - IPC resources gone, exit gracefully */
-            LOGI("[UI-UST] IPC resources destroyed, exiting");
-            ui_ctx->stop = 1;
-            pthread_mutex_unlock(&ui_ctx->ui_lock);
-            return;
-        }
-        mvwprintw(win, 1, 1, "Failed to lock shared memory");
+    /* Copy the last frame published by CC (no lock) */
+    static ui_frame_t frame;
+    if (ui_frame_read(ui_ctx->ctx->S, &frame) != 0) {
         wrefresh(win);
         pthread_mutex_unlock(&ui_ctx->ui_lock);
         return;
     }
     
-    uint16_t unit_count = ui_ctx->ctx->S->unit_count;
-    uint32_t tick = ui_ctx->ctx->S->ticks;
-    
-    /* Copy unit data */
-    unit_entity_t units[MAX_UNITS+1];
-    memcpy(units, ui_ctx->ctx->S->units, sizeof(units));
-    
-    sem_unlock(ui_ctx->ctx->sem_id, SEM_GLOBAL_LOCK);
+    uint16_t unit_count = frame.unit_count;
+    uint32_t tick = frame.tick;
+    const ui_unit_summary_t *units = frame.units;
     
     /* Display header */
     mvwprintw(win, 0, win_w - 15, " Tick:%u ", tick);
@@ -90,7 +98,7 @@ static void render_ust(ui_context_t *ui_ctx) {
     int row = 1;
     if (win_h > 2 && win_w > 40) {
         wattron(win, A_BOLD);
-        mvwprintw(win, row++, 1, "ID Type       Faction   HP    Pos      PID");
+        mvwprintw(win, row++, 1, "ID Type       Faction   HP%%  SH%%  Ord Tgt Fired  Pos      PID");
         wattroff(win, A_BOLD);
     }
     
@@ -100,8 +108,20 @@ static void render_ust(ui_context_t *ui_ctx) {
         if (units[i].alive) {
             alive_count++;
             
-            /* Calculate HP percentage (assume max HP = some value, or just show damage) */
-            int hp_pct = 100;  // TODO: calculate based on max HP
+            /* HP/shields/order/target from the unit's own telemetry record (no lock) */
+            unit_telemetry_t tm;
+            char hp_s[8] = "  ?", sh_s[8] = "  -", tgt_s[8] = "-", fired_s[8] = "-";
+            const char *ord_s = "?";
+            if (telemetry_read(ui_ctx->ctx->S, (unit_id_t)i, &tm) == 0 && tm.tick != 0) {
+                int hp_pct = pct(tm.hp, tm.hp_max);
+                int sh_pct = pct(tm.sh, tm.sh_max);
+                if (hp_pct >= 0) snprintf(hp_s, sizeof(hp_s), "%3d", hp_pct);
+                if (sh_pct >= 0) snprintf(sh_s, sizeof(sh_s), "%3d", sh_pct);
+                if (tm.target > 0) snprintf(tgt_s, sizeof(tgt_s), "%d", tm.target);
+                if (tm.last_fired_tick) snprintf(fired_s, sizeof(fired_s), "-%u",
+                                                 tm.tick - tm.last_fired_tick);
+                ord_s = get_order_name(tm.order);
+            }
             
             /* Color based on faction */
             if (units[i].faction == FACTION_REPUBLIC) {
@@ -110,12 +130,16 @@ static void render_ust(ui_context_t *ui_ctx) {
                 wattron(win, COLOR_PAIR(COLOR_CIS));
             }
             
-            /* Format: ID Type Faction HP Pos PID */
-            mvwprintw(win, row++, 1, "%-2d %-10s %-9s %3d%% (%3d,%3d) %d",
+            /* Format: ID Type Faction HP SH Ord Tgt Fired Pos PID */
+            mvwprintw(win, row++, 1, "%-2d %-10s %-9s %-4s %-4s %-3s %3s %-6s (%3d,%3d) %d",
                       i,
                       get_type_name(units[i].type),
                       get_faction_name(units[i].faction),
-                      hp_pct,
+                      hp_s,
+                      sh_s,
+                      ord_s,
+                      tgt_s,
+                      fired_s,
                       units[i].position.x,
                       units[i].position.y,
                       units[i].pid);
@@ -140,14 +164,13 @@ void* ui_ust_thread(void* arg) {
     
     LOGI("[UI-UST] Thread started");
     
-    /* Display loop */
-    while (!ui_ctx->stop) {
+    /* Render on tick advance or resize, capped at max_fps */
+    ui_pacer_t pacer;
+    ui_pacer_init(ui_ctx, &pacer);
+    while (ui_pacer_wait(ui_ctx, &pacer)) {
         render_ust(ui_ctx);
-        
-        /* Update every 500ms (2 Hz) */
-        //usleep(500000);
     }
     
-    LOGI("[UI-UST] Thread exiting");
+    LOGI("[UI-UST] Thread exiting (%u renders)", pacer.renders);
     return NULL;
 }
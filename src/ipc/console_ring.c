@@ -0,0 +1,218 @@
+#define _GNU_SOURCE
+#include "ipc/console_ring.h"
+
+#include <errno.h>
+#include <sched.h>
+#include <signal.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+#ifdef __linux__
+#include <sys/prctl.h>
+#endif
+
+/* slots reserved per fetch_add; longer flushes take several reservations */
+#define CONSOLE_MAX_RESERVE 64
+/* forwarder: output batch, idle sleep, and how long a slot may stay half written */
+#define FWD_BATCH 65536
+#define FWD_IDLE_NS 2000000L
+#define FWD_STUCK_NS 20000000ull
+
+static FILE *g_orig_stdout = NULL;
+static FILE *g_orig_stderr = NULL;
+
+static uint64_t mono_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+/* fopencookie write: never blocks, never fails */
+static ssize_t ring_write(void *cookie, const char *buf, size_t size) {
+    console_ring_t *c = cookie;
+    size_t off = 0;
+    while (off < size) {
+        size_t n = size - off;
+        if (n > (size_t)CONSOLE_MAX_RESERVE * CONSOLE_SLOT_BYTES) n = (size_t)CONSOLE_MAX_RESERVE * CONSOLE_SLOT_BYTES;
+        uint64_t k = (n + CONSOLE_SLOT_BYTES - 1) / CONSOLE_SLOT_BYTES;
+        uint64_t t = __atomic_fetch_add(&c->head, k, __ATOMIC_RELAXED);
+        for (uint64_t i = 0; i < k; i++) {
+            console_slot_t *s = &c->slot[(t + i) & (CONSOLE_SLOTS - 1)];
+            size_t len = n - i * CONSOLE_SLOT_BYTES;
+            if (len > CONSOLE_SLOT_BYTES) len = CONSOLE_SLOT_BYTES;
+            __atomic_store_n(&s->seq, 2 * (t + i) + 1, __ATOMIC_RELAXED);
+            __atomic_thread_fence(__ATOMIC_RELEASE);
+            memcpy(s->data, buf + off + i * CONSOLE_SLOT_BYTES, len);
+            s->len = (uint16_t)len;
+            __atomic_store_n(&s->seq, 2 * (t + i) + 2, __ATOMIC_RELEASE);
+        }
+        off += n;
+    }
+    return (ssize_t)size;
+}
+
+static FILE *ring_stream(console_ring_t *c) {
+    cookie_io_functions_t io = { .read = NULL, .write = ring_write, .seek = NULL, .close = NULL };
+    FILE *f = fopencookie(c, "w", io);
+    if (f) setvbuf(f, NULL, _IOLBF, BUFSIZ);
+    return f;
+}
+
+int console_ring_redirect(shm_state_t *S) {
+    if (!S || !S->console.enabled || g_orig_stdout) return -1;
+    FILE *out = ring_stream(&S->console);
+    FILE *err = ring_stream(&S->console);
+    if (!out || !err) {
+        if (out) fclose(out);
+        if (err) fclose(err);
+        return -1;
+    }
+    fflush(stdout);
+    fflush(stderr);
+    g_orig_stdout = stdout;
+    g_orig_stderr = stderr;
+    stdout = out;
+    stderr = err;
+    return 0;
+}
+
+void console_ring_restore(void) {
+    if (!g_orig_stdout) return;
+    FILE *out = stdout, *err = stderr;
+    stdout = g_orig_stdout;
+    stderr = g_orig_stderr;
+    g_orig_stdout = g_orig_stderr = NULL;
+    fclose(out);    // flushes into the ring, which is still attached
+    fclose(err);
+}
+
+static void write_all(int fd, const char *buf, size_t len) {
+    while (len > 0) {
+        ssize_t w = write(fd, buf, len);
+        if (w < 0 && errno == EINTR) continue;
+        if (w <= 0) return;     // tee gone: the rest of this batch is lost
+        buf += w;
+        len -= (size_t)w;
+    }
+}
+
+/* Copy complete slots in ticket order to out_fd until CC says so (or is gone) */
+static void forwarder(console_ring_t *c, int out_fd, uint64_t tail) {
+    static char batch[FWD_BATCH];
+    size_t blen = 0;
+    uint64_t stuck_since = 0;
+    uint64_t lost = 0;
+
+    for (;;) {
+        uint64_t head = __atomic_load_n(&c->head, __ATOMIC_ACQUIRE);
+        if (head - tail > CONSOLE_SLOTS) {
+            /* lapped: everything older than the last CONSOLE_SLOTS tickets is gone */
+            lost += head - CONSOLE_SLOTS - tail;
+            tail = head - CONSOLE_SLOTS;
+        }
+        if (tail == head) {
+            if (blen) {
+                write_all(out_fd, batch, blen);
+                blen = 0;
+            }
+            if (lost) {
+                __atomic_fetch_add(&c->dropped, lost, __ATOMIC_RELAXED);
+                lost = 0;
+            }
+            /* the write above may have blocked for a while: only stop if
+             * nothing new arrived meanwhile */
+            int stop = __atomic_load_n(&c->closing, __ATOMIC_ACQUIRE) ||
+                       (kill(c->cc_pid, 0) == -1 && errno == ESRCH);
+            if (stop && __atomic_load_n(&c->head, __ATOMIC_ACQUIRE) == tail) break;
+            if (stop) continue;
+            struct timespec ts = { 0, FWD_IDLE_NS };
+            nanosleep(&ts, NULL);
+            continue;
+        }
+
+        console_slot_t *s = &c->slot[tail & (CONSOLE_SLOTS - 1)];
+        uint64_t want = 2 * tail + 2;
+        uint64_t s1 = __atomic_load_n(&s->seq, __ATOMIC_ACQUIRE);
+        if (s1 < want) {
+            /* reserved but not written yet; skip it if the writer never finishes */
+            uint64_t now = mono_ns();
+            if (!stuck_since) stuck_since = now;
+            if (now - stuck_since < FWD_STUCK_NS) {
+                if (blen) {
+                    write_all(out_fd, batch, blen);
+                    blen = 0;
+                }
+                sched_yield();
+                continue;
+            }
+            lost++;
+        } else if (s1 > want) {
+            lost++;                 // overwritten by a later ticket
+        } else {
+            uint16_t len = s->len;
+            if (len > CONSOLE_SLOT_BYTES) len = CONSOLE_SLOT_BYTES;
+            if (blen + len > sizeof(batch)) {
+                write_all(out_fd, batch, blen);
+                blen = 0;
+            }
+            memcpy(batch + blen, s->data, len);
+            __atomic_thread_fence(__ATOMIC_ACQUIRE);
+            if (__atomic_load_n(&s->seq, __ATOMIC_RELAXED) == s1) blen += len;
+            else lost++;
+        }
+        stuck_since = 0;
+        tail++;
+    }
+
+    __atomic_store_n(&c->done, 1, __ATOMIC_RELEASE);
+}
+
+int console_forwarder_start(shm_state_t *S, int out_fd) {
+    console_ring_t *c = &S->console;
+    c->cc_pid = (int32_t)getpid();
+    c->closing = 0;
+    c->done = 0;
+    /* taken before fork: output printed before the worker runs is not skipped */
+    uint64_t tail = __atomic_load_n(&c->head, __ATOMIC_ACQUIRE);
+
+    /* double fork like the terminal tee: CC's waitpid(-1) must not reap it */
+    pid_t first = fork();
+    if (first == -1) return -1;
+    if (first == 0) {
+        pid_t worker = fork();
+        if (worker == -1) _exit(1);
+        if (worker == 0) {
+#ifdef __linux__
+            prctl(PR_SET_NAME, "console_fwd", 0, 0, 0);
+#endif
+            signal(SIGINT, SIG_IGN);
+            signal(SIGTERM, SIG_IGN);
+            signal(SIGHUP, SIG_IGN);
+            signal(SIGPIPE, SIG_IGN);
+            setsid();
+            forwarder(c, out_fd, tail);
+            _exit(0);
+        }
+        _exit(0);
+    }
+    waitpid(first, NULL, 0);
+    c->enabled = 1;
+    return 0;
+}
+
+int console_forwarder_stop(shm_state_t *S, int timeout_ms) {
+    console_ring_t *c = &S->console;
+    if (!c->enabled) return 0;
+    fflush(stdout);
+    fflush(stderr);
+    __atomic_store_n(&c->closing, 1, __ATOMIC_RELEASE);
+    for (int waited = 0; waited < timeout_ms; waited += 5) {
+        if (__atomic_load_n(&c->done, __ATOMIC_ACQUIRE)) return 0;
+        struct timespec ts = { 0, 5000000L };
+        nanosleep(&ts, NULL);
+    }
+    return -1;
+}
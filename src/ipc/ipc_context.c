@@ -1,7 +1,12 @@
 #define _GNU_SOURCE
 #include "ipc/ipc_context.h"
 #include "ipc/semaphores.h"
+#include "ipc/lockstat.h"
+#include "ipc/metrics.h"
+#include "ipc/console_ring.h"
+#include "ipc/ipc_mesq.h"
 #include "error_handler.h"
+#include "log.h"
 
 #include <errno.h>
 #include <string.h>
@@ -12,9 +17,11 @@
 #include <sys/shm.h>
 #include <sys/sem.h>
 #include <sys/msg.h>
+#include <sys/mman.h>
 
 /*
  * IPC helper: create/attach/destroy SysV shared memory + semaphore set
+ * (or a POSIX world segment, see ipc/shm_backend.h)
  *
  * Overview:
  *  - ipc_create(): create (or open) and initialize a fresh shared-state run.
@@ -34,9 +41,75 @@
  *  - Shared state is protected by SEM_GLOBAL_LOCK where required; ipc_create
  *    resets the shared memory contents under that lock so a fresh run starts
  *    with predictable values.
- *  - ftok project ids are single characters: 'S' for shared memory, 'M' for semaphores.
+ *  - create/attach also bind the queue counters, the runtime log levels
+ *    (S->log_levels) and the metrics registry (if enabled) of this process;
+ *    ipc_detach unbinds them and the lock profiler (lockstat_bind, done by
+ *    the caller) and gives back stdout/stderr (console_ring_redirect) first.
+ *  - ftok project ids are single characters: 'S' for shared memory, 'M' for semaphores,
+ *    and one per message queue class (see k_mq_classes).
+ *  - The world segment is SysV unless ipc_set_shm_backend chose POSIX; its
+ *    file is named after the 'S' key. ipc_create removes a stale segment of
+ *    the other backend, so ipc_attach can take whichever exists (POSIX first).
  */
 
+static ipc_shm_backend_t g_shm_backend = IPC_SHM_SYSV;
+static int g_shm_huge = 0;
+
+void ipc_set_shm_backend(ipc_shm_backend_t backend, int huge) {
+    g_shm_backend = backend;
+    g_shm_huge = huge;
+}
+
+/* Message queue classes: ftok project id and requested capacity (msg_qbytes).
+ * Raising msg_qbytes above the system msgmnb needs CAP_SYS_RESOURCE; when
+ * IPC_SET is refused the kernel default capacity is kept. */
+typedef struct {
+    int proj;
+    unsigned long qbytes;
+    const char *name;
+} mq_class_def_t;
+
+static const mq_class_def_t k_mq_classes[MQ_COUNT] = {
+    [MQ_SPAWN] = { 'Q', 16384, "spawn" },
+    [MQ_CMD]   = { 'C', 16384, "cmd"   },
+    [MQ_REP]   = { 'R', 32768, "rep"   },
+};
+
+static int *ctx_queue(ipc_ctx_t *ctx, int cls) {
+    switch (cls) {
+        case MQ_SPAWN: return &ctx->q_spawn;
+        case MQ_CMD:   return &ctx->q_cmd;
+        default:       return &ctx->q_rep;
+    }
+}
+
+const char *ipc_queue_name(int cls) {
+    if (cls < 0 || cls >= MQ_COUNT) return "?";
+    return k_mq_classes[cls].name;
+}
+
+static void ctx_reset_queues(ipc_ctx_t *ctx) {
+    for (int c = 0; c < MQ_COUNT; c++) *ctx_queue(ctx, c) = -1;
+}
+
+static void bind_queue_stats(ipc_ctx_t *ctx) {
+    int qids[MQ_COUNT];
+    for (int c = 0; c < MQ_COUNT; c++) qids[c] = *ctx_queue(ctx, c);
+    mq_bind_stats(qids, ctx->S->mq_stats);
+}
+
+/* Apply the class capacity to a freshly created queue (best effort). */
+static void set_queue_capacity(int qid, const mq_class_def_t *def) {
+    struct msqid_ds ds;
+    if (msgctl(qid, IPC_STAT, &ds) == -1) return;
+    if (ds.msg_qbytes == def->qbytes) return;
+    ds.msg_qbytes = def->qbytes;
+    if (msgctl(qid, IPC_SET, &ds) == -1) {
+        fprintf(stderr, "[IPC] queue '%s': keeping default capacity (%s)\n",
+                def->name, strerror(errno));
+    }
+}
+
 static key_t make_key(const char *path, int proj_id) {
     key_t k = ftok(path, proj_id);
     if (k == -1) {
@@ -80,6 +153,65 @@ static int esure_ftok_file(const char *path) {
 //     return 0;
 // }
 
+/* World segment of ipc_create, SysV backend: create-or-open and attach.
+ * Removes a stale POSIX segment of the same key first. */
+static int create_sysv_shm(ipc_ctx_t *ctx, key_t shm_key) {
+    shm_posix_unlink(shm_key);
+    ctx->shm_id = shmget(shm_key, sizeof(shm_state_t), IPC_CREAT | 0600);
+    if (ctx->shm_id == -1 && errno == EINVAL) {
+        // stale segment smaller than current shm_state_t: remove and recreate
+        int old_id = shmget(shm_key, 0, 0600);
+        if (old_id != -1) shmctl(old_id, IPC_RMID, NULL);
+        ctx->shm_id = shmget(shm_key, sizeof(shm_state_t), IPC_CREAT | 0600);
+    }
+    if (ctx->shm_id == -1) {
+        HANDLE_SYS_ERROR_NONFATAL("ipc:shmget", "Failed to create shared memory segment");
+        return -1;
+    }
+
+    ctx->S = (shm_state_t*)shmat(ctx->shm_id, NULL, 0);
+    if (ctx->S == (void*)-1) {
+        perror("[IPC] shmat");
+        fprintf(stderr, "[IPC] Failed to attach shared memory: %s (errno=%d)\n",
+                strerror(errno), errno);
+        return -1;
+    }
+    return 0;
+}
+
+/* World segment of ipc_create, POSIX backend. Removes a stale SysV segment
+ * of the same key first. */
+static int create_posix_shm(ipc_ctx_t *ctx, key_t shm_key) {
+    int old_id = shmget(shm_key, 0, 0600);
+    if (old_id != -1) shmctl(old_id, IPC_RMID, NULL);
+    if (shm_posix_create(&ctx->shm, shm_key, sizeof(shm_state_t), g_shm_huge) == -1) {
+        HANDLE_SYS_ERROR_NONFATAL("ipc:shm_posix_create", "Failed to create POSIX shared memory");
+        return -1;
+    }
+    ctx->S = (shm_state_t*)ctx->shm.addr;
+    return 0;
+}
+
+/* World segment of ipc_attach, SysV backend. */
+static int attach_sysv_shm(ipc_ctx_t *ctx, key_t shm_key) {
+    ctx->shm_id = shmget(shm_key, sizeof(shm_state_t), 0600);
+    if (ctx->shm_id == -1) {
+        perror("[IPC] shmget in ipc_attach");
+        fprintf(stderr, "[IPC] Failed to get shared memory segment: %s (errno=%d)\n",
+                strerror(errno), errno);
+        return -1;
+    }
+
+    ctx->S = (shm_state_t*)shmat(ctx->shm_id, NULL, 0);
+    if (ctx->S == (void*)-1) {
+        perror("[IPC] shmat in ipc_attach");
+        fprintf(stderr, "[IPC] Failed to attach shared memory: %s (errno=%d)\n",
+                strerror(errno), errno);
+        return -1;
+    }
+    return 0;
+}
+
 /* ipc_create
  *  - Prepare ctx and create/reset IPC objects for a fresh run.
  *  - Ensures the ftok file exists, obtains keys, creates semaphores and SHM.
@@ -96,24 +228,21 @@ int ipc_create(ipc_ctx_t *ctx, const char *ftok_path) {
 
     if (esure_ftok_file(ftok_path) == -1) return -1;
     
-    key_t req_key = make_key(ftok_path, 'Q');
-    key_t rep_key = make_key(ftok_path, 'R');
-    if (req_key == -1 || rep_key == -1) return -1;
-
-    // create-or-open
-    ctx->q_req = CHECK_SYS_CALL_NONFATAL(msgget(req_key, IPC_CREAT | 0600), "ipc:msgget_req_initial");
-    ctx->q_rep = CHECK_SYS_CALL_NONFATAL(msgget(rep_key, IPC_CREAT | 0600), "ipc:msgget_rep_initial");
-    if (ctx->q_req == -1 || ctx->q_rep == -1) {
-        return -1;
-    }
-
-    // optional but recommended for "fresh run": clear stale queues
-    msgctl(ctx->q_req, IPC_RMID, NULL);
-    msgctl(ctx->q_rep, IPC_RMID, NULL);
-    ctx->q_req = CHECK_SYS_CALL_NONFATAL(msgget(req_key, IPC_CREAT | 0600), "ipc:msgget_req_recreate");
-    ctx->q_rep = CHECK_SYS_CALL_NONFATAL(msgget(rep_key, IPC_CREAT | 0600), "ipc:msgget_rep_recreate");
-    if (ctx->q_req == -1 || ctx->q_rep == -1) {
-        return -1;
+    ctx_reset_queues(ctx);
+    for (int c = 0; c < MQ_COUNT; c++) {
+        const mq_class_def_t *def = &k_mq_classes[c];
+        key_t key = make_key(ftok_path, def->proj);
+        if (key == -1) return -1;
+
+        // create-or-open, then clear stale queue for a fresh run
+        int qid = CHECK_SYS_CALL_NONFATAL(msgget(key, IPC_CREAT | 0600), "ipc:msgget_initial");
+        if (qid == -1) return -1;
+        msgctl(qid, IPC_RMID, NULL);
+        qid = CHECK_SYS_CALL_NONFATAL(msgget(key, IPC_CREAT | 0600), "ipc:msgget_recreate");
+        if (qid == -1) return -1;
+
+        set_queue_capacity(qid, def);
+        *ctx_queue(ctx, c) = qid;
     }
 
     key_t shm_key = make_key(ftok_path, 'S');
@@ -121,13 +250,21 @@ int ipc_create(ipc_ctx_t *ctx, const char *ftok_path) {
     if (shm_key == -1 || sem_key == -1) return -1;
     
     // 1) Semaphores: create-or-open, then RESET ALWAYS for fresh run
-    ctx->sem_id = CHECK_SYS_CALL_NONFATAL(semget(sem_key, SEM_COUNT, IPC_CREAT | 0600), "ipc:semget");
+    ctx->sem_id = semget(sem_key, SEM_COUNT, IPC_CREAT | 0600);
+    if (ctx->sem_id == -1 && errno == EINVAL) {
+        // stale set left by a build with different SEM_COUNT: remove and recreate
+        int old_id = semget(sem_key, 0, 0600);
+        if (old_id != -1) semctl(old_id, 0, IPC_RMID);
+        ctx->sem_id = semget(sem_key, SEM_COUNT, IPC_CREAT | 0600);
+    }
     if (ctx->sem_id == -1) {
+        HANDLE_SYS_ERROR_NONFATAL("ipc:semget", "Failed to create semaphore set");
         return -1;
     }
 
     union semun u;
     unsigned short vals[SEM_COUNT];
+    memset(vals, 0, sizeof(vals));
     vals[SEM_GLOBAL_LOCK] = 1;
     vals[SEM_TICK_START]  = 0;
     vals[SEM_TICK_DONE]   = 0;
@@ -137,18 +274,9 @@ int ipc_create(ipc_ctx_t *ctx, const char *ftok_path) {
     }
 
     // 2) SHM: create-or-open, attach, RESET ALWAYS for fresh run
-    ctx->shm_id = CHECK_SYS_CALL_NONFATAL(shmget(shm_key, sizeof(shm_state_t), IPC_CREAT | 0600), "ipc:shmget");
-    if (ctx->shm_id == -1) {
+    ctx->shm_backend = g_shm_backend;
+    if ((ctx->shm_backend == IPC_SHM_POSIX ? create_posix_shm(ctx, shm_key) : create_sysv_shm(ctx, shm_key)) == -1)
         return -1;
-    }
-
-    ctx->S = (shm_state_t*)shmat(ctx->shm_id, NULL, 0);
-    if (ctx->S == (void*)-1) {
-        perror("[IPC] shmat");
-        fprintf(stderr, "[IPC] Failed to attach shared memory: %s (errno=%d)\n",
-                strerror(errno), errno);
-        return -1;
-    }
 
     // safe reset under lock (now sem exists)
     if (sem_lock(ctx->sem_id, SEM_GLOBAL_LOCK) == -1) {
@@ -160,6 +288,9 @@ int ipc_create(ipc_ctx_t *ctx, const char *ftok_path) {
     memset(ctx->S, 0, sizeof(*ctx->S));
     ctx->S->magic = SHM_MAGIC;
     ctx->S->next_unit_id = 1;
+    bind_queue_stats(ctx);
+    log_bind_levels(ctx->S->log_levels, SHM_LOG_MODULES);
+    metrics_bind(&ctx->S->metrics);
     if (sem_unlock(ctx->sem_id, SEM_GLOBAL_LOCK) == -1) {
         perror("[IPC] sem_unlock in ipc_create");
         fprintf(stderr, "[IPC] Failed to release global lock: %s (errno=%d)\n",
@@ -184,17 +315,18 @@ int ipc_attach(ipc_ctx_t *ctx, const char *ftok_path) {
 
     strncpy(ctx->ftok_path, ftok_path, sizeof(ctx->ftok_path)-1);
 
-    key_t req_key = make_key(ftok_path, 'Q');
-    key_t rep_key = make_key(ftok_path, 'R');
-    if (req_key == -1 || rep_key == -1) return -1;
-
-    ctx->q_req = msgget(req_key, 0600);
-    ctx->q_rep = msgget(rep_key, 0600);
-    if (ctx->q_req == -1 || ctx->q_rep == -1) {
-        perror("[IPC] msgget in ipc_attach");
-        fprintf(stderr, "[IPC] Failed to attach to message queues: %s (errno=%d)\n",
-                strerror(errno), errno);
-        return -1;
+    ctx_reset_queues(ctx);
+    for (int c = 0; c < MQ_COUNT; c++) {
+        key_t key = make_key(ftok_path, k_mq_classes[c].proj);
+        if (key == -1) return -1;
+        int qid = msgget(key, 0600);
+        if (qid == -1) {
+            perror("[IPC] msgget in ipc_attach");
+            fprintf(stderr, "[IPC] Failed to attach to message queue '%s': %s (errno=%d)\n",
+                    k_mq_classes[c].name, strerror(errno), errno);
+            return -1;
+        }
+        *ctx_queue(ctx, c) = qid;
     }
 
 
@@ -202,19 +334,15 @@ int ipc_attach(ipc_ctx_t *ctx, const char *ftok_path) {
     key_t sem_key = make_key(ftok_path, 'M');
     if (shm_key == -1 || sem_key == -1) return -1;
 
-    ctx->shm_id = shmget(shm_key, sizeof(shm_state_t), 0600);
-    if (ctx->shm_id == -1) {
-        perror("[IPC] shmget in ipc_attach");
-        fprintf(stderr, "[IPC] Failed to get shared memory segment: %s (errno=%d)\n",
-                strerror(errno), errno);
+    if (shm_posix_open(&ctx->shm, shm_key, sizeof(shm_state_t), 0) == 0) {
+        ctx->shm_backend = IPC_SHM_POSIX;
+        ctx->S = (shm_state_t*)ctx->shm.addr;
+    } else if (errno != ENOENT) {
+        perror("[IPC] shm_posix_open in ipc_attach");
+        fprintf(stderr, "[IPC] Failed to map %s: %s (errno=%d)\n",
+                ctx->shm.path, strerror(errno), errno);
         return -1;
-    }
-
-    ctx->S = (shm_state_t*)shmat(ctx->shm_id, NULL, 0);
-    if (ctx->S == (void*)-1) {
-        perror("[IPC] shmat in ipc_attach");
-        fprintf(stderr, "[IPC] Failed to attach shared memory: %s (errno=%d)\n",
-                strerror(errno), errno);
+    } else if (attach_sysv_shm(ctx, shm_key) == -1) {
         return -1;
     }
 
@@ -231,18 +359,26 @@ int ipc_attach(ipc_ctx_t *ctx, const char *ftok_path) {
         errno = EPROTO;
         return -1;
     }
+    bind_queue_stats(ctx);
+    log_bind_levels(ctx->S->log_levels, SHM_LOG_MODULES);
+    metrics_bind(&ctx->S->metrics);
 
     return 0;
 }
 
 /* ipc_detach
  *  - Detach the shared memory mapping for this process.
- *  - Returns 0 on success, -1 on failure (errno set by shmdt).
+ *  - Returns 0 on success, -1 on failure (errno set by shmdt / munmap).
  */
 int ipc_detach(ipc_ctx_t *ctx) {
     int ok = 0;
     if (ctx->S && ctx->S != (void*)-1) {
-        if (shmdt(ctx->S) == -1) {
+        log_bind_levels(NULL, 0);
+        lockstat_unbind();
+        metrics_bind(NULL);
+        console_ring_restore();
+        int rc = ctx->shm_backend == IPC_SHM_POSIX ? shm_posix_close(&ctx->shm) : shmdt(ctx->S);
+        if (rc == -1) {
             perror("[IPC] shmdt");
             fprintf(stderr, "[IPC] Failed to detach shared memory: %s (errno=%d)\n",
                     strerror(errno), errno);
@@ -254,32 +390,37 @@ int ipc_detach(ipc_ctx_t *ctx) {
 }
 
 /* ipc_destroy
- *  - Remove the SysV shared memory and semaphore objects (IPC_RMID).
+ *  - Remove the SysV shared memory and semaphore objects (IPC_RMID), or the
+ *    file of a POSIX segment.
  *  - Intended to be called by the owner (Command Center) during cleanup.
  *  - Returns 0 on success, -1 if any removal failed.
  */
 int ipc_destroy(ipc_ctx_t* ctx) {
     int ok =0;
 
-    if (ctx->q_req != -1) { 
-        if (msgctl(ctx->q_req, IPC_RMID, NULL) == -1) {
-            perror("[IPC] msgctl IPC_RMID q_req");
-            fprintf(stderr, "[IPC] Failed to remove request message queue: %s (errno=%d)\n",
-                    strerror(errno), errno);
+    for (int c = 0; c < MQ_COUNT; c++) {
+        int *q = ctx_queue(ctx, c);
+        if (*q == -1) continue;
+        if (msgctl(*q, IPC_RMID, NULL) == -1) {
+            perror("[IPC] msgctl IPC_RMID");
+            fprintf(stderr, "[IPC] Failed to remove message queue '%s': %s (errno=%d)\n",
+                    k_mq_classes[c].name, strerror(errno), errno);
             ok = -1;
         }
-        ctx->q_req = -1; 
-    }
-    if (ctx->q_rep != -1) {
-        if (msgctl(ctx->q_rep, IPC_RMID, NULL) == -1) {
-            perror("[IPC] msgctl IPC_RMID q_rep");
-            fprintf(stderr, "[IPC] Failed to remove reply message queue: %s (errno=%d)\n",
-                    strerror(errno), errno);
-            ok = -1;
-        }
-        ctx->q_rep = -1;
+        *q = -1;
     }
 
+    if (ctx->shm_backend == IPC_SHM_POSIX && ctx->shm.path[0]) {
+            const char *name = strrchr(ctx->shm.path, '/');
+            int rc = ctx->shm.pages == SHM_PAGES_HUGETLB ? unlink(ctx->shm.path) : shm_unlink(name);
+            if (rc == -1 && errno != ENOENT) {
+                perror("[IPC] shm_unlink");
+                fprintf(stderr, "[IPC] Failed to remove shared memory %s: %s (errno=%d)\n",
+                        ctx->shm.path, strerror(errno), errno);
+                ok = -1;
+            }
+            ctx->shm.path[0] = '\0';
+    }
     if (ctx->shm_id != -1) {
             if (shmctl(ctx->shm_id, IPC_RMID, NULL) == -1) {
                 perror("[IPC] shmctl IPC_RMID");
@@ -18,119 +18,118 @@ static inline int mq_open_or_create(key_t key) {
 int mq_req_id(void) { return mq_open_or_create(MQ_KEY_REQ); }
 int mq_rep_id(void) { return mq_open_or_create(MQ_KEY_REP); }
 
+/* Per-queue depth counters (shm, bound by ipc_create/ipc_attach). */
+static mq_stats_t *g_mq_stats = NULL;
+static int g_mq_ids[MQ_COUNT] = { -1, -1, -1 };
+
+void mq_bind_stats(const int qids[MQ_COUNT], mq_stats_t *stats) {
+    for (int c = 0; c < MQ_COUNT; c++) g_mq_ids[c] = qids[c];
+    g_mq_stats = stats;
+}
+
+static inline mq_stats_t *stats_for(int qid) {
+    if (!g_mq_stats) return NULL;
+    for (int c = 0; c < MQ_COUNT; c++) {
+        if (g_mq_ids[c] == qid) return &g_mq_stats[c];
+    }
+    return NULL;
+}
+
+static int mq_snd(int qid, const void *msg, size_t sz) {
+    int rc = msgsnd(qid, msg, sz, IPC_NOWAIT);
+    mq_stats_t *st = stats_for(qid);
+    if (!st) return rc;
+    if (rc == -1) {
+        __atomic_add_fetch(&st->send_fail, 1, __ATOMIC_RELAXED);
+        return rc;
+    }
+    uint32_t sent = __atomic_add_fetch(&st->sent, 1, __ATOMIC_RELAXED);
+    uint32_t depth = sent - __atomic_load_n(&st->received, __ATOMIC_RELAXED);
+    uint32_t cur = __atomic_load_n(&st->depth_max, __ATOMIC_RELAXED);
+    while (depth > cur && depth < UINT32_MAX / 2 &&
+           !__atomic_compare_exchange_n(&st->depth_max, &cur, depth, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+    }
+    return rc;
+}
+
+static ssize_t mq_rcv(int qid, void *msg, size_t sz, long type, int flags) {
+    ssize_t n = msgrcv(qid, msg, sz, type, flags);
+    if (n >= 0) {
+        mq_stats_t *st = stats_for(qid);
+        if (st) __atomic_add_fetch(&st->received, 1, __ATOMIC_RELAXED);
+    }
+    return n;
+}
+
+uint32_t mq_depth(const mq_stats_t *st) {
+    return __atomic_load_n(&st->sent, __ATOMIC_RELAXED) - __atomic_load_n(&st->received, __ATOMIC_RELAXED);
+}
+
 int mq_try_recv_spawn(int qreq, mq_spawn_req_t *out) {
-    ssize_t n = msgrcv(qreq, out, sizeof(*out) - sizeof(long), MSG_SPAWN, IPC_NOWAIT);
+    ssize_t n = mq_rcv(qreq, out, sizeof(*out) - sizeof(long), MSG_SPAWN, IPC_NOWAIT);
     if (n < 0 && errno == ENOMSG) return 0;   // nothing
     return (n < 0) ? -1 : 1;                  // -1 error, 1 got msg
 }
 
 int mq_send_spawn(int qreq, const mq_spawn_req_t *req) {
-    return msgsnd(qreq, req, sizeof(*req) - sizeof(long), IPC_NOWAIT);
+    return mq_snd(qreq, req, sizeof(*req) - sizeof(long));
 }
 
 int mq_send_reply(int qrep, const mq_spawn_rep_t *rep) {
-    return msgsnd(qrep, rep, sizeof(*rep) - sizeof(long), IPC_NOWAIT);
+    return mq_snd(qrep, rep, sizeof(*rep) - sizeof(long));
 }
 
 int mq_try_recv_reply(int qrep, mq_spawn_rep_t *out) {
     pid_t me = getpid();
-    ssize_t n = msgrcv(qrep, out, sizeof(*out) - sizeof(long), me, IPC_NOWAIT);
+    ssize_t n = mq_rcv(qrep, out, sizeof(*out) - sizeof(long), me, IPC_NOWAIT);
     if (n < 0 && errno == ENOMSG) return 0;
     return (n < 0) ? -1 : 1;
 }
 
 int mq_try_recv_commander_req(int qreq, mq_commander_req_t *out) {
-    ssize_t n = msgrcv(qreq, out, sizeof(*out) - sizeof(long), MSG_COMMANDER_REQ, IPC_NOWAIT);
+    ssize_t n = mq_rcv(qreq, out, sizeof(*out) - sizeof(long), MSG_COMMANDER_REQ, IPC_NOWAIT);
     if (n < 0 && errno == ENOMSG) return 0;
     return (n < 0) ? -1 : 1;
 }
 
 int mq_send_commander_req(int qreq, const mq_commander_req_t *req) {
-    return msgsnd(qreq, req, sizeof(*req) - sizeof(long), IPC_NOWAIT);
+    return mq_snd(qreq, req, sizeof(*req) - sizeof(long));
 }
 
 int mq_send_commander_reply(int qrep, const mq_commander_rep_t *rep) {
-    return msgsnd(qrep, rep, sizeof(*rep) - sizeof(long), IPC_NOWAIT);
+    return mq_snd(qrep, rep, sizeof(*rep) - sizeof(long));
 }
 
 int mq_try_recv_commander_reply(int qrep, mq_commander_rep_t *out) {
     pid_t me = getpid();
-    ssize_t n = msgrcv(qrep, out, sizeof(*out) - sizeof(long), me, IPC_NOWAIT);
-    if (n < 0 && errno == ENOMSG) return 0;
-    return (n < 0) ? -1 : 1;
-}
-
-int mq_send_damage(int qreq, const mq_damage_t *dmg) {
-    return msgsnd(qreq, dmg, sizeof(*dmg) - sizeof(long), IPC_NOWAIT);
-}
-
-int mq_try_recv_damage(int qreq, mq_damage_t *out) {
-    pid_t me = getpid();
-    ssize_t n = msgrcv(qreq, out, sizeof(*out) - sizeof(long), me, IPC_NOWAIT);
+    ssize_t n = mq_rcv(qrep, out, sizeof(*out) - sizeof(long), me, IPC_NOWAIT);
     if (n < 0 && errno == ENOMSG) return 0;
     return (n < 0) ? -1 : 1;
 }
 
-int mq_send_order(int qreq, const mq_order_t *order) {
-    mq_order_t msg = *order;
-    msg.mtype += MQ_ORDER_MTYPE_OFFSET;
-    return msgsnd(qreq, &msg, sizeof(msg) - sizeof(long), IPC_NOWAIT);
-}
-
-int mq_try_recv_order(int qreq, mq_order_t *out) {
-    pid_t me = getpid();
-    ssize_t n = msgrcv(qreq, out, sizeof(*out) - sizeof(long), me + MQ_ORDER_MTYPE_OFFSET, IPC_NOWAIT);
-    if (n < 0 && errno == ENOMSG) return 0;
-    if (n > 0) {
-        out->mtype -= MQ_ORDER_MTYPE_OFFSET;
-    }
-    return (n < 0) ? -1 : 1;
-}
-
 int mq_send_cm_cmd(int qreq, const mq_cm_cmd_t *cmd) {
-    return msgsnd(qreq, cmd, sizeof(*cmd) - sizeof(long), IPC_NOWAIT);
+    return mq_snd(qreq, cmd, sizeof(*cmd) - sizeof(long));
 }
 
 int mq_try_recv_cm_cmd(int qreq, mq_cm_cmd_t *out) {
-    ssize_t n = msgrcv(qreq, out, sizeof(*out) - sizeof(long), MSG_CM_CMD, IPC_NOWAIT);
+    ssize_t n = mq_rcv(qreq, out, sizeof(*out) - sizeof(long), MSG_CM_CMD, IPC_NOWAIT);
     if (n < 0 && errno == ENOMSG) return 0;
     return (n < 0) ? -1 : 1;
 }
 
 int mq_send_cm_reply(int qrep, const mq_cm_rep_t *rep) {
-    return msgsnd(qrep, rep, sizeof(*rep) - sizeof(long), IPC_NOWAIT);
+    return mq_snd(qrep, rep, sizeof(*rep) - sizeof(long));
 }
 
 int mq_try_recv_cm_reply(int qrep, mq_cm_rep_t *out) {
     pid_t me = getpid();
-    ssize_t n = msgrcv(qrep, out, sizeof(*out) - sizeof(long), me, IPC_NOWAIT);
+    ssize_t n = mq_rcv(qrep, out, sizeof(*out) - sizeof(long), me, IPC_NOWAIT);
     if (n < 0 && errno == ENOMSG) return 0;
     return (n < 0) ? -1 : 1;
 }
 
 int mq_recv_cm_reply_blocking(int qrep, mq_cm_rep_t *out) {
     pid_t me = getpid();
-    ssize_t n = msgrcv(qrep, out, sizeof(*out) - sizeof(long), me, 0);
-    return (n < 0) ? -1 : 1;
-}
-
-/* UI Map snapshot request/response */
-int mq_send_ui_map_req(int qreq, const mq_ui_map_req_t *req) {
-    return msgsnd(qreq, req, sizeof(*req) - sizeof(long), IPC_NOWAIT);
-}
-
-int mq_try_recv_ui_map_req(int qreq, mq_ui_map_req_t *out) {
-    ssize_t n = msgrcv(qreq, out, sizeof(*out) - sizeof(long), MSG_UI_MAP_REQ, IPC_NOWAIT);
-    if (n < 0 && errno == ENOMSG) return 0;
-    return (n < 0) ? -1 : 1;
-}
-
-int mq_send_ui_map_rep(int qrep, const mq_ui_map_rep_t *rep) {
-    return msgsnd(qrep, rep, sizeof(*rep) - sizeof(long), IPC_NOWAIT);
-}
-
-int mq_recv_ui_map_rep_blocking(int qrep, mq_ui_map_rep_t *out) {
-    pid_t me = getpid();
-    ssize_t n = msgrcv(qrep, out, sizeof(*out) - sizeof(long), me, 0);
+    ssize_t n = mq_rcv(qrep, out, sizeof(*out) - sizeof(long), me, 0);
     return (n < 0) ? -1 : 1;
 }
@@ -0,0 +1,23 @@
+#define _GNU_SOURCE
+#include "ipc/metrics.h"
+#include "log.h"
+
+#include <stddef.h>
+
+metrics_t *g_metrics = NULL;
+
+/* log_dropped() already counted into MET_LOG_DROPPED */
+static uint64_t g_log_dropped_seen = 0;
+
+void metrics_bind(metrics_t *m) {
+    g_metrics = (m && m->enabled) ? m : NULL;
+}
+
+void metrics_sync_log_drops(void) {
+    if (!g_metrics) return;
+    uint64_t d = log_dropped();
+    if (d > g_log_dropped_seen) {
+        metric_add(MET_LOG_DROPPED, d - g_log_dropped_seen);
+        g_log_dropped_seen = d;
+    }
+}
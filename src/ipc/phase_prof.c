@@ -0,0 +1,158 @@
+#define _GNU_SOURCE
+#include "ipc/phase_prof.h"
+#include "ipc/trace.h"
+
+#include <errno.h>
+#include <sched.h>
+#include <string.h>
+
+#define PROF_READ_RETRIES 8
+#define PROF_SAMPLES (PROF_WINDOW * (MAX_UNITS + 1))
+
+static const char *const k_phase_names[PROF_PHASES] = {
+    "lock_wait", "radar", "pathfind", "shoot", "messages", "unit_tick",
+    "cc_lock_wait", "cc_spawn", "cc_barrier", "cc_combat", "cc_print_grid",
+    "cc_cleanup", "cc_frame", "cc_tick"
+};
+
+/* this process' sums for the current tick */
+static uint64_t g_acc[PROF_PHASES];
+
+/* CC: phase samples of the last PROF_WINDOW ticks (ring by tick) */
+static uint32_t g_win[PROF_WINDOW][PROF_PHASES][MAX_UNITS + 1];
+static uint16_t g_win_n[PROF_WINDOW][PROF_PHASES];
+static uint32_t g_win_ticks = 0;
+
+void prof_add(prof_phase_t ph, uint64_t since) {
+    if ((unsigned)ph >= PROF_PHASES) return;
+    uint64_t now = prof_now();
+    g_acc[ph] += now - since;
+    trace_span(ph, since, now);
+}
+
+void prof_publish(shm_state_t *S, unit_id_t slot, uint32_t tick) {
+    if (slot < 0 || slot > MAX_UNITS) return;
+    phase_prof_t *p = &S->prof[slot];
+    for (int i = 0; i < PROF_PHASES; i++) {
+        p->ns[i] = g_acc[i] > UINT32_MAX ? UINT32_MAX : (uint32_t)g_acc[i];
+        g_acc[i] = 0;
+    }
+    __atomic_store_n(&p->tick, tick, __ATOMIC_RELEASE);
+}
+
+void prof_reset(shm_state_t *S, unit_id_t slot) {
+    if (slot < 0 || slot > MAX_UNITS) return;
+    memset(&S->prof[slot], 0, sizeof(S->prof[slot]));
+}
+
+/* k-th smallest of v[0..n) (reorders v) */
+static uint32_t select_kth(uint32_t *v, int n, int k) {
+    int lo = 0, hi = n - 1;
+    while (lo < hi) {
+        uint32_t pivot = v[(lo + hi) / 2];
+        int i = lo, j = hi;
+        while (i <= j) {
+            while (v[i] < pivot) i++;
+            while (v[j] > pivot) j--;
+            if (i <= j) {
+                uint32_t t = v[i];
+                v[i] = v[j];
+                v[j] = t;
+                i++;
+                j--;
+            }
+        }
+        if (k <= j) hi = j;
+        else if (k >= i) lo = i;
+        else break;
+    }
+    return v[k];
+}
+
+static void summary_store(prof_summary_t *dst, const prof_summary_t *src) {
+    uint32_t seq = __atomic_load_n(&dst->seq, __ATOMIC_RELAXED);
+    __atomic_store_n(&dst->seq, seq | 1u, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    dst->tick = src->tick;
+    dst->window = src->window;
+    memcpy(dst->ph, src->ph, sizeof(dst->ph));
+
+    __atomic_store_n(&dst->seq, (seq | 1u) + 1, __ATOMIC_RELEASE);
+}
+
+void prof_aggregate(shm_state_t *S, uint32_t tick) {
+    uint32_t w = g_win_ticks % PROF_WINDOW;
+    g_win_ticks++;
+
+    /* this tick's samples: slots stamped with tick, phases that ran (ns > 0) */
+    memset(g_win_n[w], 0, sizeof(g_win_n[w]));
+    for (int slot = 0; slot <= MAX_UNITS; slot++) {
+        const phase_prof_t *p = &S->prof[slot];
+        if (__atomic_load_n(&p->tick, __ATOMIC_ACQUIRE) != tick) continue;
+        for (int ph = 0; ph < PROF_PHASES; ph++)
+            if (p->ns[ph]) g_win[w][ph][g_win_n[w][ph]++] = p->ns[ph];
+    }
+
+    static uint32_t samples[PROF_SAMPLES];
+    prof_summary_t sum = { .tick = tick };
+    sum.window = g_win_ticks < PROF_WINDOW ? g_win_ticks : PROF_WINDOW;
+    for (int ph = 0; ph < PROF_PHASES; ph++) {
+        int n = 0;
+        uint64_t total = 0;
+        uint32_t lo = UINT32_MAX, hi = 0;
+        for (uint32_t k = 0; k < sum.window; k++) {
+            for (int i = 0; i < g_win_n[k][ph]; i++) {
+                uint32_t v = g_win[k][ph][i];
+                samples[n++] = v;
+                total += v;
+                if (v < lo) lo = v;
+                if (v > hi) hi = v;
+            }
+        }
+        if (n == 0) continue;
+        prof_stat_t *st = &sum.ph[ph];
+        st->n = (uint32_t)n;
+        st->min_ns = lo;
+        st->max_ns = hi;
+        st->avg_ns = (uint32_t)(total / (uint64_t)n);
+        st->p99_ns = select_kth(samples, n, (n * 99 + 99) / 100 - 1);
+    }
+    summary_store(&S->prof_summary, &sum);
+}
+
+int prof_summary_read(const shm_state_t *S, prof_summary_t *out) {
+    const prof_summary_t *s = &S->prof_summary;
+    for (int i = 0; i < PROF_READ_RETRIES; i++) {
+        uint32_t s1 = __atomic_load_n(&s->seq, __ATOMIC_ACQUIRE);
+        if (s1 & 1u) {
+            sched_yield();
+            continue;
+        }
+        *out = *s;
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (__atomic_load_n(&s->seq, __ATOMIC_RELAXED) == s1) {
+            out->seq = s1;
+            return 0;
+        }
+    }
+    errno = EAGAIN;
+    return -1;
+}
+
+void prof_csv_header(FILE *f) {
+    fprintf(f, "tick,phase,n,min_ns,avg_ns,p99_ns,max_ns\n");
+}
+
+void prof_csv_rows(FILE *f, const prof_summary_t *sum) {
+    for (int ph = 0; ph < PROF_PHASES; ph++) {
+        const prof_stat_t *st = &sum->ph[ph];
+        if (!st->n) continue;
+        fprintf(f, "%u,%s,%u,%u,%u,%u,%u\n", sum->tick, k_phase_names[ph],
+                st->n, st->min_ns, st->avg_ns, st->p99_ns, st->max_ns);
+    }
+}
+
+const char *prof_phase_name(prof_phase_t ph) {
+    return (unsigned)ph < PROF_PHASES ? k_phase_names[ph] : "?";
+}
@@ -0,0 +1,306 @@
+#define _GNU_SOURCE
+#include "ipc/recording.h"
+#include "ipc/telemetry.h"
+
+#include <errno.h>
+#include <string.h>
+
+/* ---- varints ---- */
+
+static uint8_t *put_uv(uint8_t *p, uint64_t v) {
+    while (v >= 0x80) {
+        *p++ = (uint8_t)(v | 0x80);
+        v >>= 7;
+    }
+    *p++ = (uint8_t)v;
+    return p;
+}
+
+static uint8_t *put_sv(uint8_t *p, int64_t v) {
+    return put_uv(p, ((uint64_t)v << 1) ^ (uint64_t)(v >> 63));
+}
+
+typedef struct {
+    const uint8_t *p, *end;
+    int bad;
+} rd_t;
+
+static uint64_t get_uv(rd_t *r) {
+    uint64_t v = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        if (r->p >= r->end) break;
+        uint8_t b = *r->p++;
+        v |= (uint64_t)(b & 0x7f) << shift;
+        if (!(b & 0x80)) return v;
+    }
+    r->bad = 1;
+    return 0;
+}
+
+static int64_t get_sv(rd_t *r) {
+    uint64_t u = get_uv(r);
+    return (int64_t)(u >> 1) ^ -(int64_t)(u & 1);
+}
+
+static void put_u16(uint8_t *p, uint16_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static uint16_t get_u16(const uint8_t *p) {
+    return (uint16_t)(p[0] | p[1] << 8);
+}
+
+/* ---- header ---- */
+
+void rec_header_write(const rec_header_t *h, uint8_t out[REC_HEADER_SIZE]) {
+    memset(out, 0, REC_HEADER_SIZE);
+    memcpy(out, REC_MAGIC, sizeof(REC_MAGIC));
+    put_u16(out + 8, h->m);
+    put_u16(out + 10, h->n);
+    put_u16(out + 12, h->max_units);
+    put_u16(out + 14, h->key_every);
+    for (int i = 0; i < 8; i++) out[16 + i] = (uint8_t)(h->seed >> (8 * i));
+    memcpy(out + 24, h->scenario, sizeof(h->scenario));
+    out[REC_HEADER_SIZE - 1] = '\0';
+}
+
+int rec_header_read(rec_header_t *h, const uint8_t *buf, size_t len) {
+    if (len < REC_HEADER_SIZE || memcmp(buf, REC_MAGIC, sizeof(REC_MAGIC)) != 0) {
+        errno = EINVAL;
+        return -1;
+    }
+    h->m = get_u16(buf + 8);
+    h->n = get_u16(buf + 10);
+    h->max_units = get_u16(buf + 12);
+    h->key_every = get_u16(buf + 14);
+    h->seed = 0;
+    for (int i = 0; i < 8; i++) h->seed |= (uint64_t)buf[16 + i] << (8 * i);
+    memcpy(h->scenario, buf + 24, sizeof(h->scenario));
+    h->scenario[sizeof(h->scenario) - 1] = '\0';
+    if (h->m != M || h->n != N || h->max_units != MAX_UNITS) {
+        errno = EINVAL;
+        return -1;
+    }
+    return 0;
+}
+
+/* ---- capture / publish ---- */
+
+void rec_state_capture(rec_state_t *st, const shm_state_t *S, const combat_hit_t *hits, int n_hits) {
+    st->tick = S->ticks;
+    memcpy(st->grid, S->grid, sizeof(st->grid));
+    memset(st->unit, 0, sizeof(st->unit));
+    for (int id = 1; id <= MAX_UNITS; id++) {
+        const unit_entity_t *u = &S->units[id];
+        if (!u->alive) continue;
+        int64_t *f = st->unit[id];
+        f[REC_U_ALIVE] = 1;
+        f[REC_U_FACTION] = u->faction;
+        f[REC_U_TYPE] = u->type;
+        f[REC_U_X] = u->position.x;
+        f[REC_U_Y] = u->position.y;
+        f[REC_U_HP] = u->hp;
+        f[REC_U_PID] = u->pid;
+        unit_telemetry_t tm;
+        if (telemetry_read(S, (unit_id_t)id, &tm) == 0 && tm.tick != 0) {
+            f[REC_U_HP_MAX] = tm.hp_max;
+            f[REC_U_SH] = tm.sh;
+            f[REC_U_SH_MAX] = tm.sh_max;
+            f[REC_U_TARGET] = tm.target;
+            f[REC_U_ORDER] = tm.order;
+            f[REC_U_FIRED] = tm.last_fired_tick;
+        }
+    }
+    if (n_hits < 0) n_hits = 0;
+    if (n_hits > MAX_FIRE_INTENTS) n_hits = MAX_FIRE_INTENTS;
+    st->hit_count = (uint16_t)n_hits;
+    if (n_hits) memcpy(st->hits, hits, sizeof(hits[0]) * (size_t)n_hits);
+}
+
+void rec_state_publish(const rec_state_t *st, shm_state_t *S) {
+    S->ticks = st->tick;
+    memcpy(S->grid, st->grid, sizeof(S->grid));
+    memset(S->grid_dirty, 1, sizeof(S->grid_dirty));
+    uint16_t count = 0;
+    for (int id = 1; id <= MAX_UNITS; id++) {
+        const int64_t *f = st->unit[id];
+        unit_entity_t *u = &S->units[id];
+        u->alive = (uint8_t)f[REC_U_ALIVE];
+        u->faction = (uint8_t)f[REC_U_FACTION];
+        u->type = (uint8_t)f[REC_U_TYPE];
+        u->position.x = (int16_t)f[REC_U_X];
+        u->position.y = (int16_t)f[REC_U_Y];
+        u->hp = (st_points_t)f[REC_U_HP];
+        u->pid = (pid_t)f[REC_U_PID];
+        if (u->alive) count++;
+
+        unit_telemetry_t tm = {
+            .tick = u->alive ? st->tick : 0,
+            .hp = u->hp,
+            .hp_max = (st_points_t)f[REC_U_HP_MAX],
+            .sh = (st_points_t)f[REC_U_SH],
+            .sh_max = (st_points_t)f[REC_U_SH_MAX],
+            .last_fired_tick = (uint32_t)f[REC_U_FIRED],
+            .target = (unit_id_t)f[REC_U_TARGET],
+            .order = (uint8_t)f[REC_U_ORDER],
+        };
+        telemetry_write(S, (unit_id_t)id, &tm);
+    }
+    S->unit_count = count;
+}
+
+/* ---- encode ---- */
+
+static uint8_t *put_hits(uint8_t *p, const rec_state_t *cur) {
+    p = put_uv(p, cur->hit_count);
+    for (int i = 0; i < cur->hit_count; i++) {
+        p = put_uv(p, (uint64_t)(uint16_t)cur->hits[i].attacker);
+        p = put_uv(p, (uint64_t)(uint16_t)cur->hits[i].target);
+        p = put_sv(p, cur->hits[i].dmg);
+    }
+    return p;
+}
+
+static uint8_t *put_key(uint8_t *p, const rec_state_t *cur) {
+    p = put_uv(p, cur->tick);
+
+    const unit_id_t *g = &cur->grid[0][0];
+    uint32_t count = 0;
+    for (int i = 0; i < M * N; i++) count += g[i] != 0;
+    p = put_uv(p, count);
+    int last = -1;
+    for (int i = 0; i < M * N; i++) {
+        if (!g[i]) continue;
+        p = put_uv(p, (uint64_t)(i - last - 1));
+        p = put_sv(p, g[i]);
+        last = i;
+    }
+
+    for (int id = 1; id <= MAX_UNITS; id++) {
+        if (!cur->unit[id][REC_U_ALIVE]) continue;
+        p = put_uv(p, (uint64_t)id);
+        for (int f = 0; f < REC_U_FIELDS; f++) p = put_sv(p, cur->unit[id][f]);
+    }
+    p = put_uv(p, 0);
+    return put_hits(p, cur);
+}
+
+static uint8_t *put_delta(uint8_t *p, const rec_state_t *prev, const rec_state_t *cur) {
+    p = put_uv(p, (uint64_t)(cur->tick - prev->tick));
+
+    const unit_id_t *a = &prev->grid[0][0], *b = &cur->grid[0][0];
+    uint32_t count = 0;
+    for (int i = 0; i < M * N; i++) count += a[i] != b[i];
+    p = put_uv(p, count);
+    int last = -1;
+    for (int i = 0; i < M * N && count; i++) {
+        if (a[i] == b[i]) continue;
+        p = put_uv(p, (uint64_t)(i - last - 1));
+        p = put_sv(p, b[i]);
+        last = i;
+    }
+
+    for (int id = 1; id <= MAX_UNITS; id++) {
+        const int64_t *u0 = prev->unit[id], *u1 = cur->unit[id];
+        uint32_t mask = 0;
+        for (int f = 0; f < REC_U_FIELDS; f++)
+            if (u0[f] != u1[f]) mask |= 1u << f;
+        if (!mask) continue;
+        p = put_uv(p, (uint64_t)id);
+        if (!u1[REC_U_ALIVE] && u0[REC_U_ALIVE]) {
+            p = put_uv(p, REC_UNIT_CLEAR);      // died: every field back to 0
+            continue;
+        }
+        p = put_uv(p, mask);
+        for (int f = 0; f < REC_U_FIELDS; f++)
+            if (mask & (1u << f)) p = put_sv(p, u1[f] - u0[f]);
+    }
+    p = put_uv(p, 0);
+    return put_hits(p, cur);
+}
+
+size_t rec_encode(const rec_state_t *prev, const rec_state_t *cur, int key, uint8_t *out, size_t cap) {
+    if (cap < REC_RECORD_MAX || (!key && !prev)) return 0;
+    /* payload first, 10 bytes in: then move it behind the real length */
+    uint8_t *payload = out + 10;
+    uint8_t *end = key ? put_key(payload, cur) : put_delta(payload, prev, cur);
+    size_t plen = (size_t)(end - payload);
+
+    uint8_t hdr[11];
+    hdr[0] = key ? REC_KEY : REC_DELTA;
+    size_t hlen = (size_t)(put_uv(hdr + 1, plen) - hdr);
+    memmove(out + hlen, payload, plen);
+    memcpy(out, hdr, hlen);
+    return hlen + plen;
+}
+
+/* ---- decode ---- */
+
+int rec_next(const uint8_t *buf, size_t len, size_t *off, uint8_t *kind, const uint8_t **payload, size_t *plen) {
+    if (*off >= len) return 0;
+    rd_t r = { buf + *off + 1, buf + len, 0 };
+    uint8_t k = buf[*off];
+    uint64_t n = get_uv(&r);
+    if (r.bad || (k != REC_KEY && k != REC_DELTA) || n > (uint64_t)(r.end - r.p)) return -1;
+    *kind = k;
+    *payload = r.p;
+    *plen = (size_t)n;
+    *off = (size_t)(r.p - buf) + (size_t)n;
+    return 1;
+}
+
+static int get_hits(rd_t *r, rec_state_t *st) {
+    uint64_t n = get_uv(r);
+    if (n > MAX_FIRE_INTENTS) return -1;
+    st->hit_count = (uint16_t)n;
+    for (uint64_t i = 0; i < n; i++) {
+        st->hits[i].attacker = (unit_id_t)get_uv(r);
+        st->hits[i].target = (unit_id_t)get_uv(r);
+        st->hits[i].dmg = (st_points_t)get_sv(r);
+    }
+    return r->bad ? -1 : 0;
+}
+
+int rec_apply(rec_state_t *st, uint8_t kind, const uint8_t *payload, size_t plen) {
+    rd_t r = { payload, payload + plen, 0 };
+    unit_id_t *g = &st->grid[0][0];
+    int key = (kind == REC_KEY);
+
+    if (key) {
+        memset(st->grid, 0, sizeof(st->grid));
+        memset(st->unit, 0, sizeof(st->unit));
+        st->tick = (uint32_t)get_uv(&r);
+    } else {
+        st->tick += (uint32_t)get_uv(&r);
+    }
+
+    uint64_t count = get_uv(&r);
+    int64_t idx = -1;
+    for (uint64_t i = 0; i < count && !r.bad; i++) {
+        idx += (int64_t)get_uv(&r) + 1;
+        if (idx >= M * N) return -1;
+        g[idx] = (unit_id_t)get_sv(&r);
+    }
+
+    for (;;) {
+        uint64_t id = get_uv(&r);
+        if (r.bad || id > MAX_UNITS) return -1;
+        if (id == 0) break;
+        int64_t *u = st->unit[id];
+        if (key) {
+            for (int f = 0; f < REC_U_FIELDS; f++) u[f] = get_sv(&r);
+            continue;
+        }
+        uint64_t mask = get_uv(&r);
+        if (mask == REC_UNIT_CLEAR) {
+            memset(u, 0, sizeof(st->unit[0]));
+            continue;
+        }
+        for (int f = 0; f < REC_U_FIELDS; f++)
+            if (mask & (1u << f)) u[f] += get_sv(&r);
+    }
+
+    if (get_hits(&r, st) != 0 || r.bad) return -1;
+    return 0;
+}
@@ -1,7 +1,13 @@
 #define _GNU_SOURCE
 #include "ipc/semaphores.h"
+#include "ipc/lockstat.h"
+#include "ipc/metrics.h"
 #include "error_handler.h"
 #include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
 
 /*
  * Small, focused wrappers around System V semop/semctl.
@@ -17,6 +23,100 @@
  *    semop variant used by the tick/barrier logic.
  */
 
+/* Lock contention profiler state of this process (see ipc/lockstat.h).
+ * CC takes SEM_GLOBAL_LOCK from two threads, so the acquire time is per thread. */
+static lockstat_slot_t *g_ls_slot = NULL;
+static int g_ls_semid = -1;
+static __thread uint64_t g_ls_hold_t0 = 0;
+
+static inline uint64_t ls_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+/* lockstat_lock_t of a wait on semid/semnum, -1 if not profiled */
+static int ls_lock_of(int semid, unsigned short semnum) {
+    if (!g_ls_slot || semid != g_ls_semid) return -1;
+    if (semnum == SEM_GLOBAL_LOCK) return LOCKSTAT_GLOBAL;
+    if (semnum == SEM_TICK_DONE) return LOCKSTAT_TICK_DONE;
+    return LOCKSTAT_TICK_START;     // SEM_TICK_START or SEM_UNIT_TURN(id)
+}
+
+static void ls_record(lockstat_hist_t *h, uint64_t ns) {
+    __atomic_fetch_add(&h->count, 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&h->total_ns, ns, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&h->hist[lockstat_bucket(ns)], 1, __ATOMIC_RELAXED);
+    uint64_t max = __atomic_load_n(&h->max_ns, __ATOMIC_RELAXED);
+    while (ns > max &&
+           !__atomic_compare_exchange_n(&h->max_ns, &max, ns, 0, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+    }
+}
+
+/* Single-semaphore semop, timed when the profiler tracks the semaphore or
+ * the metrics registry counts SEM_GLOBAL_LOCK waits (ipc/metrics.h).
+ * intr selects sem_op_intr (cooperative cancellation) over sem_op_retry. */
+static int sem_op_one(int semid, struct sembuf *op, volatile sig_atomic_t *stop_flag, int intr) {
+    int lock = op->sem_op < 0 ? ls_lock_of(semid, op->sem_num) : -1;
+    int metered = g_metrics && op->sem_op < 0 && op->sem_num == SEM_GLOBAL_LOCK;
+    if (lock < 0 && !metered) return intr ? sem_op_intr(semid, op, 1, stop_flag) : sem_op_retry(semid, op, 1);
+
+    uint64_t t0 = ls_now();
+    int rc = intr ? sem_op_intr(semid, op, 1, stop_flag) : sem_op_retry(semid, op, 1);
+    if (rc == 0) {
+        uint64_t t1 = ls_now();
+        if (lock >= 0) {
+            ls_record(&g_ls_slot->wait[lock], t1 - t0);
+            if (lock == LOCKSTAT_GLOBAL) g_ls_hold_t0 = t1;
+        }
+        if (metered) {
+            metric_inc(MET_LOCK_WAITS);
+            metric_add(MET_LOCK_WAIT_NS, t1 - t0);
+        }
+    }
+    return rc;
+}
+
+/* Hold time of SEM_GLOBAL_LOCK ends when it is posted */
+static void ls_release(int semid, unsigned short semnum) {
+    if (semnum != SEM_GLOBAL_LOCK || !g_ls_slot || semid != g_ls_semid || !g_ls_hold_t0) return;
+    ls_record(&g_ls_slot->hold, ls_now() - g_ls_hold_t0);
+    g_ls_hold_t0 = 0;
+}
+
+void lockstat_bind(shm_state_t *S, int semid, unit_id_t slot, const char *role) {
+    if (!S || !S->lockstat.enabled || slot < 0 || slot > MAX_UNITS) return;
+    lockstat_slot_t *ls = &S->lockstat.slot[slot];
+    if (strncmp(ls->role, role, sizeof(ls->role)) != 0) {
+        memset(ls, 0, sizeof(*ls));
+        strncpy(ls->role, role, sizeof(ls->role) - 1);
+    }
+    ls->pid = (int32_t)getpid();
+    g_ls_semid = semid;
+    g_ls_slot = ls;
+}
+
+void lockstat_unbind(void) {
+    g_ls_slot = NULL;
+    g_ls_semid = -1;
+}
+
+int lockstat_dump(const shm_state_t *S, const char *path) {
+    FILE *f = fopen(path, "wb");
+    if (!f) return -1;
+    lockstat_dump_header_t h;
+    memset(&h, 0, sizeof(h));
+    memcpy(h.magic, LOCKSTAT_DUMP_MAGIC, sizeof(h.magic));
+    h.ticks = S->ticks;
+    h.slots = MAX_UNITS + 1;
+    h.buckets = LOCKSTAT_BUCKETS;
+    h.locks = LOCKSTAT_LOCKS;
+    int ok = fwrite(&h, sizeof(h), 1, f) == 1 &&
+             fwrite(S->lockstat.slot, sizeof(S->lockstat.slot), 1, f) == 1;
+    if (fclose(f) != 0) ok = 0;
+    return ok ? 0 : -1;
+}
+
 /* sem_op_retry
  *  Perform semop(2) with the provided ops array.
  *  Retries on EINTR until the operation succeeds or fails with a
@@ -63,20 +163,22 @@ int sem_op_intr(int semid, struct sembuf *ops, size_t nops, volatile sig_atomic_
  *   - sem_lock: decrement (wait) semaphore[semnum] by 1.
  *   - sem_unlock: increment (post) semaphore[semnum] by 1.
  *  These use sem_op_retry (uninterruptible from caller's POV).
+ *  With the profiler bound, SEM_GLOBAL_LOCK wait and hold times are recorded.
  */
 int sem_lock(int semid, unsigned short semnum) {
     struct sembuf op = {.sem_num=semnum, .sem_op=-1, .sem_flg=0};
-    return sem_op_retry(semid, &op, 1);
+    return sem_op_one(semid, &op, NULL, 0);
 }
 
 int sem_lock_intr(int semid, unsigned short semnum, volatile sig_atomic_t *stop_flag) {
     struct sembuf op = {.sem_num=semnum, .sem_op=-1, .sem_flg=0};
-    return sem_op_intr(semid, &op, 1, stop_flag);
+    return sem_op_one(semid, &op, stop_flag, 1);
 }
 
 
 int sem_unlock(int semid , unsigned short semnum) {
     struct sembuf op = {.sem_num=semnum, .sem_op=+1, .sem_flg=0};
+    ls_release(semid, semnum);
     return sem_op_retry(semid, &op, 1);
 }
 
@@ -87,7 +189,7 @@ int sem_unlock(int semid , unsigned short semnum) {
  */
 int sem_wait_intr(int semid, unsigned short semnum, short delta, volatile sig_atomic_t *stop_flag) {
     struct sembuf op = {.sem_num=semnum, .sem_op=delta, .sem_flg=0};
-    return sem_op_intr(semid, &op, 1, stop_flag);
+    return sem_op_one(semid, &op, stop_flag, 1);
 }
 
 /* sem_post_retry
@@ -95,5 +197,6 @@ int sem_wait_intr(int semid, unsigned short semnum, short delta, volatile sig_at
  */
 int sem_post_retry(int semid, unsigned short semnum, short delta) {
     struct sembuf op = {.sem_num=semnum, .sem_op=delta, .sem_flg=0};
+    if (delta > 0) ls_release(semid, semnum);
     return sem_op_retry(semid, &op, 1);
 }
\ No newline at end of file
@@ -0,0 +1,206 @@
+#define _GNU_SOURCE
+#include "ipc/shm_backend.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <mntent.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/statfs.h>
+
+#define SHM_DEV_DIR "/dev/shm"
+#define THP_SIZE (2u << 20)
+
+/* name of the segment for key: shm_open(3) takes "/<name>" */
+static void seg_name(key_t key, char *out, size_t cap) {
+    snprintf(out, cap, "skirmish-%08x", (unsigned)key);
+}
+
+/* First hugetlbfs mount and its page size, or -1 if there is none. */
+static int hugetlbfs_mount(char *dir, size_t cap, size_t *page) {
+    FILE *f = setmntent("/proc/mounts", "r");
+    if (!f) return -1;
+    int found = -1;
+    struct mntent *m;
+    while ((m = getmntent(f)) != NULL) {
+        if (strcmp(m->mnt_type, "hugetlbfs") != 0) continue;
+        struct statfs sfs;
+        if (statfs(m->mnt_dir, &sfs) == -1) continue;
+        snprintf(dir, cap, "%s", m->mnt_dir);
+        *page = (size_t)sfs.f_bsize;
+        found = 0;
+        break;
+    }
+    endmntent(f);
+    return found;
+}
+
+/* Whether MADV_HUGEPAGE on /dev/shm can take effect (madvise itself
+ * succeeds either way): shmem_enabled [force] or [deny] override everything,
+ * otherwise the huge= option of the /dev/shm mount decides (shmem_enabled
+ * alone only covers the kernel's internal mount, e.g. SysV segments). */
+static int thp_shmem_advisable(void) {
+    char buf[128] = "";
+    FILE *f = fopen("/sys/kernel/mm/transparent_hugepage/shmem_enabled", "r");
+    if (f) {
+        if (!fgets(buf, sizeof(buf), f)) buf[0] = '\0';
+        fclose(f);
+    }
+    if (strstr(buf, "[force]")) return 1;
+    if (strstr(buf, "[deny]")) return 0;
+
+    int ok = 0;
+    f = setmntent("/proc/mounts", "r");
+    if (!f) return 0;
+    struct mntent *m;
+    while ((m = getmntent(f)) != NULL) {
+        if (strcmp(m->mnt_dir, SHM_DEV_DIR) != 0) continue;
+        const char *opt = hasmntopt(m, "huge");
+        ok = opt && strncmp(opt, "huge=never", 10) != 0;
+    }
+    endmntent(f);
+    return ok;
+}
+
+static size_t round_up(size_t n, size_t to) {
+    return (n + to - 1) / to * to;
+}
+
+static int map_fd(shm_posix_t *seg, int fd, size_t len, int readonly) {
+    void *p = mmap(NULL, len, readonly ? PROT_READ : PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (p == MAP_FAILED) return -1;
+    seg->addr = p;
+    seg->len = len;
+    return 0;
+}
+
+/* hugetlbfs: fails (and leaves nothing behind) when the pool is too small */
+static int create_hugetlb(shm_posix_t *seg, key_t key, size_t size) {
+    char dir[96], name[32];
+    size_t page;
+    if (hugetlbfs_mount(dir, sizeof(dir), &page) == -1) {
+        errno = ENOENT;
+        return -1;
+    }
+    seg_name(key, name, sizeof(name));
+    snprintf(seg->path, sizeof(seg->path), "%s/%s", dir, name);
+    int fd = open(seg->path, O_RDWR | O_CREAT | O_TRUNC, 0600);
+    if (fd == -1) return -1;
+    size_t len = round_up(size, page);
+    /* hugetlbfs reserves the pages at mmap time, so a short pool fails here */
+    if (ftruncate(fd, (off_t)len) == -1 || map_fd(seg, fd, len, 0) == -1) {
+        int e = errno;
+        close(fd);
+        unlink(seg->path);
+        errno = e;
+        return -1;
+    }
+    close(fd);
+    seg->pages = SHM_PAGES_HUGETLB;
+    return 0;
+}
+
+int shm_posix_create(shm_posix_t *seg, key_t key, size_t size, int huge) {
+    memset(seg, 0, sizeof(*seg));
+    shm_posix_unlink(key);
+    if (huge && create_hugetlb(seg, key, size) == 0) return 0;
+
+    char name[32], shm[40];
+    seg_name(key, name, sizeof(name));
+    snprintf(shm, sizeof(shm), "/%s", name);
+    snprintf(seg->path, sizeof(seg->path), SHM_DEV_DIR "/%s", name);
+    int fd = shm_open(shm, O_RDWR | O_CREAT | O_TRUNC, 0600);
+    if (fd == -1) return -1;
+    /* whole 2 MiB extents, so the kernel can back the mapping with THPs */
+    size_t len = round_up(size, huge ? THP_SIZE : (size_t)sysconf(_SC_PAGESIZE));
+    if (ftruncate(fd, (off_t)len) == -1 || map_fd(seg, fd, len, 0) == -1) {
+        int e = errno;
+        close(fd);
+        shm_unlink(shm);
+        errno = e;
+        return -1;
+    }
+    close(fd);
+    seg->pages = SHM_PAGES_NORMAL;
+    if (huge && madvise(seg->addr, seg->len, MADV_HUGEPAGE) == 0 && thp_shmem_advisable())
+        seg->pages = SHM_PAGES_THP;
+    return 0;
+}
+
+int shm_posix_open(shm_posix_t *seg, key_t key, size_t min_size, int readonly) {
+    memset(seg, 0, sizeof(*seg));
+    char dir[96], name[32];
+    size_t page;
+    seg_name(key, name, sizeof(name));
+
+    int fd = -1;
+    if (hugetlbfs_mount(dir, sizeof(dir), &page) == 0) {
+        snprintf(seg->path, sizeof(seg->path), "%s/%s", dir, name);
+        fd = open(seg->path, readonly ? O_RDONLY : O_RDWR);
+        if (fd != -1) seg->pages = SHM_PAGES_HUGETLB;
+    }
+    if (fd == -1) {
+        char shm[40];
+        snprintf(shm, sizeof(shm), "/%s", name);
+        snprintf(seg->path, sizeof(seg->path), SHM_DEV_DIR "/%s", name);
+        fd = shm_open(shm, readonly ? O_RDONLY : O_RDWR, 0);
+        if (fd == -1) return -1;
+        seg->pages = SHM_PAGES_NORMAL;
+    }
+
+    struct stat sb;
+    if (fstat(fd, &sb) == -1) {
+        int e = errno;
+        close(fd);
+        errno = e;
+        return -1;
+    }
+    if ((size_t)sb.st_size < min_size) {
+        close(fd);
+        errno = EINVAL;
+        return -1;
+    }
+    int rc = map_fd(seg, fd, (size_t)sb.st_size, readonly);
+    int e = errno;
+    close(fd);
+    errno = e;
+    /* the advice is per mapping: repeat it for a segment created with huge
+     * (only those are whole 2 MiB extents) */
+    if (rc == 0 && seg->pages == SHM_PAGES_NORMAL && seg->len % THP_SIZE == 0 &&
+        madvise(seg->addr, seg->len, MADV_HUGEPAGE) == 0 && thp_shmem_advisable())
+        seg->pages = SHM_PAGES_THP;
+    return rc;
+}
+
+int shm_posix_close(shm_posix_t *seg) {
+    int rc = 0;
+    if (seg->addr) rc = munmap(seg->addr, seg->len);
+    seg->addr = NULL;
+    seg->len = 0;
+    return rc;
+}
+
+int shm_posix_unlink(key_t key) {
+    char dir[96], name[32], path[160];
+    size_t page;
+    int rc = 0;
+    seg_name(key, name, sizeof(name));
+    if (hugetlbfs_mount(dir, sizeof(dir), &page) == 0) {
+        snprintf(path, sizeof(path), "%s/%s", dir, name);
+        if (unlink(path) == -1 && errno != ENOENT) rc = -1;
+    }
+    snprintf(path, sizeof(path), "/%s", name);
+    if (shm_unlink(path) == -1 && errno != ENOENT) rc = -1;
+    return rc;
+}
+
+const char *shm_pages_name(shm_pages_t pages) {
+    switch (pages) {
+        case SHM_PAGES_THP:     return "thp";
+        case SHM_PAGES_HUGETLB: return "hugetlb";
+        default:                return "4k";
+    }
+}
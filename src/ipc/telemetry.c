@@ -0,0 +1,61 @@
+#define _GNU_SOURCE
+#include "ipc/telemetry.h"
+
+#include <errno.h>
+#include <sched.h>
+
+/* a record is 64 bytes: a torn copy only happens if the unit writes right then */
+#define TELEMETRY_READ_RETRIES 8
+
+static void telemetry_store(unit_telemetry_t *t, const unit_telemetry_t *rec, uint32_t seq) {
+    __atomic_store_n(&t->seq, seq | 1u, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    t->tick = rec->tick;
+    t->hp = rec->hp;
+    t->hp_max = rec->hp_max;
+    t->sh = rec->sh;
+    t->sh_max = rec->sh_max;
+    t->last_fired_tick = rec->last_fired_tick;
+    t->target = rec->target;
+    t->order = rec->order;
+
+    __atomic_store_n(&t->seq, (seq | 1u) + 1, __ATOMIC_RELEASE);
+}
+
+void telemetry_write(shm_state_t *S, unit_id_t unit_id, const unit_telemetry_t *rec) {
+    if (unit_id <= 0 || unit_id > MAX_UNITS) return;
+    unit_telemetry_t *t = &S->telemetry[unit_id];
+    telemetry_store(t, rec, __atomic_load_n(&t->seq, __ATOMIC_RELAXED));
+}
+
+int telemetry_read(const shm_state_t *S, unit_id_t unit_id, unit_telemetry_t *out) {
+    if (unit_id <= 0 || unit_id > MAX_UNITS) {
+        errno = EINVAL;
+        return -1;
+    }
+    const unit_telemetry_t *t = &S->telemetry[unit_id];
+    for (int i = 0; i < TELEMETRY_READ_RETRIES; i++) {
+        uint32_t s1 = __atomic_load_n(&t->seq, __ATOMIC_ACQUIRE);
+        if (s1 & 1u) {
+            sched_yield();
+            continue;
+        }
+        *out = *t;
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        uint32_t s2 = __atomic_load_n(&t->seq, __ATOMIC_RELAXED);
+        if (s1 == s2) {
+            out->seq = s1;
+            return 0;
+        }
+    }
+    errno = EAGAIN;
+    return -1;
+}
+
+void telemetry_reset(shm_state_t *S, unit_id_t unit_id) {
+    if (unit_id <= 0 || unit_id > MAX_UNITS) return;
+    unit_telemetry_t *t = &S->telemetry[unit_id];
+    const unit_telemetry_t zero = {0};
+    telemetry_store(t, &zero, __atomic_load_n(&t->seq, __ATOMIC_RELAXED));
+}
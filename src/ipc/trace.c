@@ -0,0 +1,108 @@
+#define _GNU_SOURCE
+#include "ipc/trace.h"
+#include "ipc/phase_prof.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+/* producer side: this process' ring (NULL == not tracing) */
+static trace_ring_t *g_ring = NULL;
+static int32_t g_pid = 0;
+
+/* CC side: output file and per-slot pid the lane metadata was written for */
+static FILE *g_out = NULL;
+static char g_out_buf[1 << 20];
+static uint64_t g_base_ns = 0;
+static uint64_t g_written = 0;
+static int32_t g_lane_pid[MAX_UNITS + 1];
+
+void trace_bind(shm_state_t *S, unit_id_t slot, const char *role) {
+    if (!S || !S->trace.enabled || slot < 0 || slot > MAX_UNITS) return;
+    trace_ring_t *r = &S->trace.ring[slot];
+    memset(r->role, 0, sizeof(r->role));
+    strncpy(r->role, role, sizeof(r->role) - 1);
+    g_pid = (int32_t)getpid();
+    g_ring = r;
+}
+
+void trace_span(int ph, uint64_t t0, uint64_t t1) {
+    trace_ring_t *r = g_ring;
+    if (!r) return;
+    uint32_t head = r->head;
+    if (head - __atomic_load_n(&r->tail, __ATOMIC_ACQUIRE) >= TRACE_RING_CAP) {
+        r->dropped++;
+        return;
+    }
+    trace_event_t *e = &r->ev[head % TRACE_RING_CAP];
+    e->ts_ns = t0;
+    e->dur_ns = t1 - t0 > UINT32_MAX ? UINT32_MAX : (uint32_t)(t1 - t0);
+    e->pid = g_pid;
+    e->phase = (uint8_t)ph;
+    __atomic_store_n(&r->head, head + 1, __ATOMIC_RELEASE);
+}
+
+int trace_export_open(const char *path) {
+    g_out = fopen(path, "w");
+    if (!g_out) return -1;
+    setvbuf(g_out, g_out_buf, _IOFBF, sizeof(g_out_buf));
+    g_base_ns = prof_now();
+    g_written = 0;
+    memset(g_lane_pid, 0, sizeof(g_lane_pid));
+    fputs("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n", g_out);
+    return 0;
+}
+
+/* process name + lane order of a pid, written the first time a slot shows it */
+static void write_lane(const trace_ring_t *r, int slot, int32_t pid) {
+    char role[sizeof(r->role) + 1];
+    memcpy(role, r->role, sizeof(r->role));
+    role[sizeof(r->role)] = '\0';
+    if (slot == 0) {
+        fprintf(g_out, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%d,\"args\":{\"name\":\"%s\"}},\n",
+                pid, role);
+    } else {
+        fprintf(g_out, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%d,\"args\":{\"name\":\"%s u%d\"}},\n",
+                pid, role, slot);
+    }
+    fprintf(g_out, "{\"name\":\"process_sort_index\",\"ph\":\"M\",\"pid\":%d,\"args\":{\"sort_index\":%d}},\n",
+            pid, slot);
+}
+
+void trace_export_tick(shm_state_t *S, uint32_t tick) {
+    if (!g_out) return;
+    for (int slot = 0; slot <= MAX_UNITS; slot++) {
+        trace_ring_t *r = &S->trace.ring[slot];
+        uint32_t tail = r->tail;
+        uint32_t head = __atomic_load_n(&r->head, __ATOMIC_ACQUIRE);
+        for (; tail != head; tail++) {
+            const trace_event_t *e = &r->ev[tail % TRACE_RING_CAP];
+            if (e->pid != g_lane_pid[slot]) {
+                write_lane(r, slot, e->pid);
+                g_lane_pid[slot] = e->pid;
+            }
+            int64_t ts = (int64_t)(e->ts_ns - g_base_ns);
+            fprintf(g_out,
+                    "{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"pid\":%d,\"tid\":%d,"
+                    "\"ts\":%.3f,\"dur\":%.3f,\"args\":{\"tick\":%u}},\n",
+                    prof_phase_name((prof_phase_t)e->phase), slot ? "unit" : "cc", e->pid, slot,
+                    (double)ts / 1e3, (double)e->dur_ns / 1e3, tick);
+            g_written++;
+        }
+        __atomic_store_n(&r->tail, tail, __ATOMIC_RELEASE);
+    }
+}
+
+void trace_export_close(shm_state_t *S, uint32_t tick, uint64_t *written, uint64_t *dropped) {
+    if (!g_out) return;
+    trace_export_tick(S, tick);
+    uint64_t lost = 0;
+    for (int slot = 0; slot <= MAX_UNITS; slot++) lost += S->trace.ring[slot].dropped;
+    /* trailing metadata record keeps the array valid after the last ",\n" */
+    fprintf(g_out, "{\"name\":\"trace_stats\",\"ph\":\"M\",\"pid\":0,\"args\":{\"spans\":%llu,\"dropped\":%llu}}\n]}\n",
+            (unsigned long long)g_written, (unsigned long long)lost);
+    fclose(g_out);
+    g_out = NULL;
+    if (written) *written = g_written;
+    if (dropped) *dropped = lost;
+}
@@ -0,0 +1,193 @@
+#define _GNU_SOURCE
+#include "ipc/ui_frame.h"
+
+#include <errno.h>
+#include <limits.h>
+#include <sched.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+
+/* readers give up after this many torn copies (CC writes ~12 KB per tick) */
+#define UI_FRAME_READ_RETRIES 64
+
+static long futex(uint32_t *uaddr, int op, uint32_t val, const struct timespec *ts) {
+    /* shm is mapped in several processes: no FUTEX_PRIVATE_FLAG */
+    return syscall(SYS_futex, uaddr, op, val, ts, NULL, 0);
+}
+
+/* mipmap class of a grid cell: 1 + ui_mip_class_t, 0 if empty/unclassified */
+static uint8_t cell_class(const shm_state_t *S, unit_id_t id) {
+    if (id == 0) return 0;
+    if (id < 0) return 1 + UI_MIP_OBSTACLE;
+    if (id > MAX_UNITS) return 0;
+    const unit_entity_t *u = &S->units[id];
+    int craft = (u->type >= TYPE_FIGHTER && u->type <= TYPE_ELITE);
+    if (u->faction == FACTION_REPUBLIC) return 1 + (craft ? UI_MIP_REP_CRAFT : UI_MIP_REP_CAPITAL);
+    if (u->faction == FACTION_CIS) return 1 + (craft ? UI_MIP_CIS_CRAFT : UI_MIP_CIS_CAPITAL);
+    return 0;
+}
+
+/* move cell (x, y) to class c in every mipmap level */
+static void mip_set_class(ui_frame_t *f, int x, int y, uint8_t c) {
+    uint8_t old = f->cell_class[x][y];
+    if (old == c) return;
+    for (int l = 1; l <= UI_MIP_LEVELS; l++) {
+        ui_mip_tile_t *t = &f->mip[ui_mip_index(l, x >> l, y >> l)];
+        if (old) t->n[old - 1]--;
+        if (c) t->n[c - 1]++;
+    }
+    f->cell_class[x][y] = c;
+}
+
+/* copy changed tiles of the grid into the frame, stamp them with epoch and
+ * update the mipmap counts of the changed cells */
+static void publish_grid_tiles(ui_frame_t *f, const shm_state_t *S, uint32_t epoch, int full) {
+    for (int tx = 0; tx < UI_TILES_X; tx++) {
+        int x0 = tx * UI_TILE;
+        int x1 = x0 + UI_TILE < M ? x0 + UI_TILE : M;
+
+        if (!full) {
+            int dirty = 0;
+            for (int x = x0; x < x1; x++) dirty |= S->grid_dirty[x];
+            if (!dirty) continue;
+        }
+
+        for (int ty = 0; ty < UI_TILES_Y; ty++) {
+            int y0 = ty * UI_TILE;
+            int y1 = y0 + UI_TILE < N ? y0 + UI_TILE : N;
+            size_t len = (size_t)(y1 - y0) * sizeof(unit_id_t);
+            int changed = 0;
+            for (int x = x0; x < x1; x++) {
+                if (!full && memcmp(&f->grid[x][y0], &S->grid[x][y0], len) == 0) continue;
+                for (int y = y0; y < y1; y++) {
+                    unit_id_t id = S->grid[x][y];
+                    f->grid[x][y] = id;
+                    mip_set_class(f, x, y, cell_class(S, id));
+                }
+                changed = 1;
+            }
+            if (changed || full) f->tile_epoch[tx][ty] = epoch;
+        }
+    }
+}
+
+void ui_frame_publish(shm_state_t *S) {
+    ui_frame_t *f = &S->frame;
+    uint32_t seq = __atomic_load_n(&f->seq, __ATOMIC_RELAXED);
+
+    __atomic_store_n(&f->seq, seq + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    uint32_t epoch = __atomic_load_n(&S->tick_epoch, __ATOMIC_RELAXED) + 1;
+    int full = (seq == 0);
+
+    f->epoch = epoch;
+    f->tick = S->ticks;
+    f->unit_count = S->unit_count;
+    publish_grid_tiles(f, S, epoch, full);
+    for (int id = 0; id <= MAX_UNITS; id++) {
+        const unit_entity_t *u = &S->units[id];
+        f->units[id] = (ui_unit_summary_t){
+            .pid = u->pid,
+            .hp = u->hp,
+            .position = u->position,
+            .alive = u->alive,
+            .faction = u->faction,
+            .type = u->type
+        };
+    }
+
+    __atomic_store_n(&f->seq, seq + 2, __ATOMIC_RELEASE);
+
+    __atomic_add_fetch(&S->tick_epoch, 1, __ATOMIC_RELEASE);
+    (void)futex(&S->tick_epoch, FUTEX_WAKE, INT_MAX, NULL);
+}
+
+int ui_frame_read(const shm_state_t *S, ui_frame_t *out) {
+    const ui_frame_t *f = &S->frame;
+    for (int i = 0; i < UI_FRAME_READ_RETRIES; i++) {
+        uint32_t s1 = __atomic_load_n(&f->seq, __ATOMIC_ACQUIRE);
+        if (s1 & 1u) {
+            sched_yield();
+            continue;
+        }
+        memcpy(out, f, sizeof(*out));
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        uint32_t s2 = __atomic_load_n(&f->seq, __ATOMIC_RELAXED);
+        if (s1 == s2) {
+            out->seq = s1;
+            return 0;
+        }
+    }
+    errno = EAGAIN;
+    return -1;
+}
+
+int ui_frame_read_region(const shm_state_t *S, ui_frame_t *out, int level, int x0, int y0, int w, int h) {
+    const ui_frame_t *f = &S->frame;
+    int lw = level ? UI_MIP_W(level) : M;
+    int lh = level ? UI_MIP_H(level) : N;
+    if (level < 0 || level > UI_MIP_LEVELS) {
+        errno = EINVAL;
+        return -1;
+    }
+    if (x0 < 0) x0 = 0;
+    if (y0 < 0) y0 = 0;
+    if (x0 + w > lw) w = lw - x0;
+    if (y0 + h > lh) h = lh - y0;
+
+    for (int i = 0; i < UI_FRAME_READ_RETRIES; i++) {
+        uint32_t s1 = __atomic_load_n(&f->seq, __ATOMIC_ACQUIRE);
+        if (s1 & 1u) {
+            sched_yield();
+            continue;
+        }
+        out->epoch = f->epoch;
+        out->tick = f->tick;
+        out->unit_count = f->unit_count;
+        memcpy(out->units, f->units, sizeof(out->units));
+        if (w > 0 && h > 0) {
+            if (level == 0) {
+                memcpy(out->tile_epoch, f->tile_epoch, sizeof(out->tile_epoch));
+                for (int x = x0; x < x0 + w; x++)
+                    memcpy(&out->grid[x][y0], &f->grid[x][y0], (size_t)h * sizeof(unit_id_t));
+            } else {
+                for (int x = x0; x < x0 + w; x++)
+                    memcpy(&out->mip[ui_mip_index(level, x, y0)], &f->mip[ui_mip_index(level, x, y0)],
+                           (size_t)h * sizeof(ui_mip_tile_t));
+            }
+        }
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        uint32_t s2 = __atomic_load_n(&f->seq, __ATOMIC_RELAXED);
+        if (s1 == s2) {
+            out->seq = s1;
+            return 0;
+        }
+    }
+    errno = EAGAIN;
+    return -1;
+}
+
+uint32_t tick_epoch_load(const shm_state_t *S) {
+    return __atomic_load_n(&S->tick_epoch, __ATOMIC_ACQUIRE);
+}
+
+int tick_epoch_wait(shm_state_t *S, uint32_t seen, int timeout_ms) {
+    struct timespec ts, *pts = NULL;
+    if (timeout_ms >= 0) {
+        ts.tv_sec = timeout_ms / 1000;
+        ts.tv_nsec = (long)(timeout_ms % 1000) * 1000000L;
+        pts = &ts;
+    }
+    while (tick_epoch_load(S) == seen) {
+        if (futex(&S->tick_epoch, FUTEX_WAIT, seen, pts) == -1) {
+            if (errno == EAGAIN) break;              /* epoch changed before we slept */
+            if (errno == ETIMEDOUT || errno == EINTR) return 0;
+            return -1;
+        }
+    }
+    return 1;
+}
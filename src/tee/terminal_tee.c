@@ -11,13 +11,18 @@
 #include <string.h>
 #include <unistd.h>
 #include <sys/stat.h>
+#include <sys/uio.h>
 #include <sys/wait.h>
 
 #ifdef __linux__
 #include <sys/prctl.h>
 #endif
 
-#define BUFFER_SIZE 4096
+/* readv/writev path: up to BATCH_IOV * BATCH_BUF bytes (one full pipe) per call */
+#define BATCH_IOV 16
+#define BATCH_BUF 4096
+/* tee(2)/splice(2) path: most bytes duplicated per call */
+#define SPLICE_MAX (1 << 20)
 
 static void ignore_sig(int sig) {
     struct sigaction sa;
@@ -28,6 +33,184 @@ static void ignore_sig(int sig) {
     (void)sigaction(sig, &sa, NULL);
 }
 
+typedef struct {
+    int log_fd;
+    int term_fd;
+    int ui_fd;              // -1 while the UI is not connected
+    int screen_is_pipe;     // current screen fd (UI FIFO or terminal) is a pipe
+    int splice_ok;          // cleared by TEE_RW_ONLY or the first EINVAL/ENOSYS
+    const char *ui_pipe_path;
+} tee_out_t;
+
+static int fd_is_pipe(int fd) {
+    struct stat st;
+    return fd != -1 && fstat(fd, &st) == 0 && S_ISFIFO(st.st_mode);
+}
+
+static int screen_fd(const tee_out_t *o) {
+    return o->ui_fd != -1 ? o->ui_fd : o->term_fd;
+}
+
+static void ui_connect(tee_out_t *o) {
+    if (!o->ui_pipe_path || access(o->ui_pipe_path, F_OK) != 0) return;
+    // non-blocking open fails (ENXIO) instead of hanging when nobody reads it
+    int fd = open(o->ui_pipe_path, O_WRONLY | O_NONBLOCK);
+    if (fd == -1) return;
+    // Make it blocking after successful connection
+    int flags = fcntl(fd, F_GETFL);
+    fcntl(fd, F_SETFL, flags & ~O_NONBLOCK);
+    o->ui_fd = fd;
+    o->screen_is_pipe = 1;
+}
+
+static void ui_disconnect(tee_out_t *o) {
+    if (o->ui_fd != -1) close(o->ui_fd);
+    o->ui_fd = -1;
+    o->screen_is_pipe = fd_is_pipe(o->term_fd);
+}
+
+/* Check if UI pipe appeared or disappeared */
+static void ui_check(tee_out_t *o) {
+    if (o->ui_fd == -1) ui_connect(o);
+    else if (access(o->ui_pipe_path, F_OK) != 0) ui_disconnect(o);
+}
+
+static int write_all(int fd, const char *buf, size_t len) {
+    while (len > 0) {
+        ssize_t w = write(fd, buf, len);
+        if (w < 0 && errno == EINTR) continue;
+        if (w <= 0) return -1;
+        buf += w;
+        len -= (size_t)w;
+    }
+    return 0;
+}
+
+/* writev until all of iov[0..cnt) is out; iov is consumed */
+static int writev_all(int fd, struct iovec *iov, int cnt) {
+    while (cnt > 0) {
+        ssize_t w = writev(fd, iov, cnt);
+        if (w < 0 && errno == EINTR) continue;
+        if (w <= 0) return -1;
+        while (cnt > 0 && (size_t)w >= iov->iov_len) {
+            w -= (ssize_t)iov->iov_len;
+            iov++;
+            cnt--;
+        }
+        if (cnt > 0) {
+            iov->iov_base = (char *)iov->iov_base + w;
+            iov->iov_len -= (size_t)w;
+        }
+    }
+    return 0;
+}
+
+/* Batched copy through user space: one readv of up to a full pipe, then one
+ * writev to the log and one to the screen. Returns bytes moved, 0 on EOF. */
+static ssize_t pump_rw(int in_fd, tee_out_t *o) {
+    static char buf[BATCH_IOV][BATCH_BUF];
+    struct iovec in[BATCH_IOV], out[BATCH_IOV];
+    for (int i = 0; i < BATCH_IOV; i++) {
+        in[i].iov_base = buf[i];
+        in[i].iov_len = BATCH_BUF;
+    }
+
+    ssize_t n;
+    do {
+        n = readv(in_fd, in, BATCH_IOV);
+    } while (n < 0 && errno == EINTR);
+    if (n <= 0) return 0;
+
+    int cnt = (int)((n + BATCH_BUF - 1) / BATCH_BUF);
+    size_t last = (size_t)n - (size_t)(cnt - 1) * BATCH_BUF;
+    memcpy(out, in, sizeof(out[0]) * (size_t)cnt);
+    out[cnt - 1].iov_len = last;
+    (void)writev_all(o->log_fd, out, cnt);
+
+    memcpy(out, in, sizeof(out[0]) * (size_t)cnt);
+    out[cnt - 1].iov_len = last;
+    if (o->ui_fd != -1 && writev_all(o->ui_fd, out, cnt) == 0) return n;
+    if (o->ui_fd != -1) {
+        // UI pipe closed (EPIPE) or broken - fall back to terminal; the UI
+        // may have taken part of this batch, the terminal gets all of it
+        ui_disconnect(o);
+        memcpy(out, in, sizeof(out[0]) * (size_t)cnt);
+        out[cnt - 1].iov_len = last;
+    }
+    if (o->term_fd != -1) (void)writev_all(o->term_fd, out, cnt);
+    return n;
+}
+
+#ifdef __linux__
+/* Zero-copy path (screen fd is a pipe): tee(2) duplicates what is queued in
+ * in_fd into the screen pipe without consuming it, then splice(2) moves the
+ * same bytes into the log file. Returns bytes moved, 0 on EOF, -1 if nothing
+ * was consumed and the caller should use pump_rw() for this round. */
+static ssize_t pump_splice(int in_fd, tee_out_t *o) {
+    int screen = screen_fd(o);
+    ssize_t n;
+    do {
+        n = tee(in_fd, screen, SPLICE_MAX, 0);
+    } while (n < 0 && errno == EINTR);
+    if (n == 0) return 0;
+    if (n < 0) {
+        if (errno == EINVAL || errno == ENOSYS) o->splice_ok = 0;
+        else if (o->ui_fd != -1) ui_disconnect(o);   // EPIPE: UI went away
+        else o->screen_is_pipe = 0;                  // terminal pipe broke: log only
+        return -1;
+    }
+
+    size_t left = (size_t)n;
+    while (left > 0) {
+        ssize_t s = splice(in_fd, NULL, o->log_fd, NULL, left, SPLICE_F_MOVE);
+        if (s < 0 && errno == EINTR) continue;
+        if (s <= 0) break;
+        left -= (size_t)s;
+    }
+    if (left > 0) {
+        // log refused splice: the screen already has these bytes, so only
+        // consume them here, through user space
+        o->splice_ok = 0;
+        char buf[BATCH_BUF];
+        while (left > 0) {
+            ssize_t r = read(in_fd, buf, left < sizeof(buf) ? left : sizeof(buf));
+            if (r < 0 && errno == EINTR) continue;
+            if (r <= 0) break;
+            (void)write_all(o->log_fd, buf, (size_t)r);
+            left -= (size_t)r;
+        }
+    }
+    return n;
+}
+#endif
+
+uint64_t tee_pump(int in_fd, int log_fd, int term_fd, const char *ui_pipe_path, int flags) {
+    tee_out_t o = {
+        .log_fd = log_fd,
+        .term_fd = term_fd,
+        .ui_fd = -1,
+        .screen_is_pipe = fd_is_pipe(term_fd),
+        .splice_ok = !(flags & TEE_RW_ONLY),
+        .ui_pipe_path = ui_pipe_path,
+    };
+    uint64_t total = 0;
+
+    ui_connect(&o);
+    for (;;) {
+        ssize_t n = -1;
+#ifdef __linux__
+        if (o.splice_ok && o.screen_is_pipe) n = pump_splice(in_fd, &o);
+#endif
+        if (n < 0) n = pump_rw(in_fd, &o);
+        if (n == 0) break;
+        total += (uint64_t)n;
+        ui_check(&o);
+    }
+
+    ui_disconnect(&o);
+    return total;
+}
+
 /* Worker process that reads from pipe and writes to log + terminal/UI */
 static void tee_worker(int pipe_fd, const char *log_path, const char *ui_pipe_path) {
 #ifdef __linux__
@@ -38,130 +221,30 @@ static void tee_worker(int pipe_fd, const char *log_path, const char *ui_pipe_pa
     ignore_sig(SIGINT);
     ignore_sig(SIGTERM);
     ignore_sig(SIGHUP);
+    // a UI that quits mid-write must surface as EPIPE, not kill the tee
+    ignore_sig(SIGPIPE);
 
-    // Open log file for appending
-    int log_fd = open(log_path, O_WRONLY | O_CREAT | O_APPEND, 0644);
+    // Open log file. No O_APPEND: splice(2) refuses such files. The tee is
+    // the only writer, so positioning at the end once is enough.
+    int log_fd = open(log_path, O_WRONLY | O_CREAT, 0644);
     if (log_fd == -1) {
         perror("tee: open log file");
         _exit(1);
     }
+    lseek(log_fd, 0, SEEK_END);
 
-    // Check if UI pipe exists and is writable
-    int ui_fd = -1;
-    int use_ui = 0;
-    
-    if (access(ui_pipe_path, F_OK) == 0) {
-        // UI pipe exists - try to open (non-blocking to avoid hanging)
-        ui_fd = open(ui_pipe_path, O_WRONLY | O_NONBLOCK);
-        if (ui_fd != -1) {
-            use_ui = 1;
-            // Make it blocking after successful connection
-            int flags = fcntl(ui_fd, F_GETFL);
-            fcntl(ui_fd, F_SETFL, flags & ~O_NONBLOCK);
-        }
-    }
-
-    // Open terminal output
-    int term_fd = -1;
-    if (!use_ui) {
-        // No UI - write to terminal
-        term_fd = open("/dev/tty", O_WRONLY);
-        if (term_fd == -1) {
-            // Fallback to stdout (probably won't work since CC redirected it)
-            term_fd = STDOUT_FILENO;
-        }
+    // Terminal output, used whenever the UI is not connected
+    int term_fd = open("/dev/tty", O_WRONLY);
+    if (term_fd == -1) {
+        // Fallback to stdout (probably won't work since CC redirected it)
+        term_fd = STDOUT_FILENO;
     }
 
-    // Main loop - read from pipe, write to log and terminal/UI
-    char buffer[BUFFER_SIZE];
-    ssize_t bytes;
-    int read_count = 0;
-
-    while ((bytes = read(pipe_fd, buffer, sizeof(buffer))) > 0) {
-        read_count++;
-        
-        // Write to log file
-        ssize_t written = 0;
-        while (written < bytes) {
-            ssize_t w = write(log_fd, buffer + written, bytes - written);
-            if (w <= 0) break;
-            written += w;
-        }
-
-        // Write to terminal or UI
-        if (use_ui && ui_fd != -1) {
-            // Send to UI [STD] thread via pipe
-            written = 0;
-            while (written < bytes) {
-                ssize_t w = write(ui_fd, buffer + written, bytes - written);
-                if (w <= 0) {
-                    // UI pipe closed (EPIPE) or broken - fall back to terminal immediately
-                    use_ui = 0;
-                    close(ui_fd);
-                    ui_fd = -1;
-                    
-                    // Open terminal for output
-                    term_fd = open("/dev/tty", O_WRONLY);
-                    if (term_fd == -1) {
-                        term_fd = STDOUT_FILENO;
-                    }
-                    
-                    // Write remaining data to terminal
-                    ssize_t term_written = 0;
-                    while (term_written < bytes) {
-                        ssize_t tw = write(term_fd, buffer + term_written, bytes - term_written);
-                        if (tw <= 0) break;
-                        term_written += tw;
-                    }
-                    break;
-                }
-                written += w;
-            }
-        } else if (term_fd != -1) {
-            // Send to terminal
-            written = 0;
-            while (written < bytes) {
-                ssize_t w = write(term_fd, buffer + written, bytes - written);
-                if (w <= 0) break;
-                written += w;
-            }
-        }
-
-        // Every 10 reads, check if UI pipe appeared or disappeared
-        if (read_count % 1 == 0) {
-            if (!use_ui && access(ui_pipe_path, F_OK) == 0) {
-                // UI pipe appeared - try to connect
-                ui_fd = open(ui_pipe_path, O_WRONLY | O_NONBLOCK);
-                if (ui_fd != -1) {
-                    use_ui = 1;
-                    int flags = fcntl(ui_fd, F_GETFL);
-                    fcntl(ui_fd, F_SETFL, flags & ~O_NONBLOCK);
-                    
-                    // Close terminal fd
-                    if (term_fd != -1 && term_fd != STDOUT_FILENO) {
-                        close(term_fd);
-                    }
-                    term_fd = -1;
-                }
-            } else if (use_ui && access(ui_pipe_path, F_OK) != 0) {
-                // UI pipe disappeared - UI was closed
-                use_ui = 0;
-                if (ui_fd != -1) {
-                    close(ui_fd);
-                    ui_fd = -1;
-                }
-                term_fd = open("/dev/tty", O_WRONLY);
-                if (term_fd == -1) {
-                    term_fd = STDOUT_FILENO;
-                }
-            }
-        }
-    }
+    // Main loop - until EOF on the pipe
+    tee_pump(pipe_fd, log_fd, term_fd, ui_pipe_path, 0);
 
-    // EOF or error - cleanup and exit
     close(log_fd);
-    if (ui_fd != -1) close(ui_fd);
-    if (term_fd != -1 && term_fd != STDOUT_FILENO) close(term_fd);
+    if (term_fd != STDOUT_FILENO) close(term_fd);
     
     _exit(0);
 }
@@ -177,7 +260,7 @@ int start_terminal_tee(const char *run_dir) {
     char log_path[600];
     char ui_pipe_path[600];
     snprintf(log_path, sizeof(log_path), "%s/ALL.term.log", run_dir);
-    snprintf(ui_pipe_path, sizeof(ui_pipe_path), "/tmp/skirmish_std.fifo");
+    snprintf(ui_pipe_path, sizeof(ui_pipe_path), "%s", TEE_UI_FIFO);
 
     // Double fork to detach tee worker completely
     pid_t first = fork();
@@ -0,0 +1,75 @@
+/* skirmish-hashdiff - compares two per-tick world hash logs (state_hash.bin)
+ *
+ * usage: skirmish-hashdiff <a/state_hash.bin> <b/state_hash.bin>
+ * exit:  0 identical (over common ticks, same length)
+ *        1 divergent or different length
+ *        2 usage / IO error
+ */
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+#include "CC/world_hash.h"
+
+static FILE *open_log(const char *path, hash_log_header_t *hh) {
+    FILE *f = fopen(path, "rb");
+    if (!f) {
+        fprintf(stderr, "[hashdiff] %s: %s\n", path, strerror(errno));
+        return NULL;
+    }
+    if (fread(hh, sizeof(*hh), 1, f) != 1 || memcmp(hh->magic, HASH_LOG_MAGIC, sizeof(hh->magic)) != 0) {
+        fprintf(stderr, "[hashdiff] %s: not a state hash log\n", path);
+        fclose(f);
+        return NULL;
+    }
+    return f;
+}
+
+int main(int argc, char **argv) {
+    if (argc != 3) {
+        fprintf(stderr, "usage: %s <state_hash.bin> <state_hash.bin>\n", argv[0]);
+        return 2;
+    }
+
+    hash_log_header_t ha, hb;
+    FILE *fa = open_log(argv[1], &ha);
+    if (!fa) return 2;
+    FILE *fb = open_log(argv[2], &hb);
+    if (!fb) { fclose(fa); return 2; }
+
+    if (ha.seed != hb.seed) {
+        printf("warning: seeds differ (a=%llu b=%llu)\n",
+               (unsigned long long)ha.seed, (unsigned long long)hb.seed);
+    }
+
+    hash_log_rec_t ra, rb;
+    unsigned long n = 0;
+    int rc = 0;
+    for (;;) {
+        int ga = fread(&ra, sizeof(ra), 1, fa) == 1;
+        int gb = fread(&rb, sizeof(rb), 1, fb) == 1;
+        if (!ga || !gb) {
+            if (ga != gb) {
+                printf("identical for %lu ticks; %s ends first (other continues at tick %u)\n",
+                       n, ga ? "b" : "a", ga ? ra.tick : rb.tick);
+                rc = 1;
+            } else {
+                printf("identical: %lu ticks\n", n);
+            }
+            break;
+        }
+        if (ra.tick != rb.tick || ra.hash != rb.hash) {
+            printf("first divergence at record %lu: a tick=%u hash=%016llx, b tick=%u hash=%016llx\n",
+                   n, ra.tick, (unsigned long long)ra.hash, rb.tick, (unsigned long long)rb.hash);
+            rc = 1;
+            break;
+        }
+        n++;
+    }
+
+    fclose(fa);
+    fclose(fb);
+    return rc;
+}
@@ -0,0 +1,242 @@
+/* skirmish-lockstat - lock contention report (command_center --lockstat)
+ *
+ * usage: skirmish-lockstat [-n N] [--ftok path] [run_dir | lockstat.bin]
+ *        Reads <run_dir>/lockstat.bin written by CC at shutdown, or the
+ *        segment of a running simulation when no path is given. Prints who
+ *        holds SEM_GLOBAL_LOCK longest, who waits for it most (top N, default
+ *        10), the tick barrier waits and the merged log-scale histograms.
+ * exit:  0 ok, 2 usage / IO error
+ */
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <sys/stat.h>
+#include <sys/ipc.h>
+#include <sys/shm.h>
+
+#include "ipc/shared.h"
+#include "ipc/lockstat.h"
+#include "ipc/shm_backend.h"
+
+#define NSLOTS (MAX_UNITS + 1)
+
+static lockstat_slot_t g_slots[NSLOTS];
+static uint32_t g_ticks = 0;
+
+typedef struct {
+    int slot;
+    const lockstat_hist_t *h;
+} row_t;
+
+static void fmt_ns(char *buf, size_t n, uint64_t ns) {
+    if (ns < 10000ull) snprintf(buf, n, "%lluns", (unsigned long long)ns);
+    else if (ns < 10000000ull) snprintf(buf, n, "%.1fus", (double)ns / 1e3);
+    else if (ns < 10000000000ull) snprintf(buf, n, "%.1fms", (double)ns / 1e6);
+    else snprintf(buf, n, "%.2fs", (double)ns / 1e9);
+}
+
+static int load_dump(const char *path) {
+    char file[600];
+    struct stat st;
+    if (stat(path, &st) == -1) {
+        fprintf(stderr, "[lockstat] %s: %s\n", path, strerror(errno));
+        return -1;
+    }
+    if (S_ISDIR(st.st_mode)) snprintf(file, sizeof(file), "%s/lockstat.bin", path);
+    else snprintf(file, sizeof(file), "%s", path);
+
+    FILE *f = fopen(file, "rb");
+    if (!f) {
+        fprintf(stderr, "[lockstat] %s: %s\n", file, strerror(errno));
+        return -1;
+    }
+    lockstat_dump_header_t h;
+    int ok = fread(&h, sizeof(h), 1, f) == 1 &&
+             memcmp(h.magic, LOCKSTAT_DUMP_MAGIC, sizeof(h.magic)) == 0;
+    if (!ok) {
+        fprintf(stderr, "[lockstat] %s: not a lock profile\n", file);
+    } else if (h.slots != NSLOTS || h.buckets != LOCKSTAT_BUCKETS || h.locks != LOCKSTAT_LOCKS) {
+        fprintf(stderr, "[lockstat] %s: written by a build with a different layout\n", file);
+        ok = 0;
+    } else if (fread(g_slots, sizeof(g_slots), 1, f) != 1) {
+        fprintf(stderr, "[lockstat] %s: short read\n", file);
+        ok = 0;
+    }
+    fclose(f);
+    g_ticks = h.ticks;
+    return ok ? 0 : -1;
+}
+
+static int load_live(const char *ftok_path) {
+    key_t key = ftok(ftok_path, 'S');
+    /* POSIX world segment (--shm posix) first, then SysV */
+    shm_posix_t seg;
+    const shm_state_t *S = NULL;
+    if (key != -1 && shm_posix_open(&seg, key, sizeof(shm_state_t), 1) == 0) {
+        S = seg.addr;
+    } else {
+        int shm_id = key == -1 ? -1 : shmget(key, 0, 0600);
+        if (shm_id == -1) {
+            fprintf(stderr, "[lockstat] no running simulation (%s): %s\n", ftok_path, strerror(errno));
+            return -1;
+        }
+        S = shmat(shm_id, NULL, SHM_RDONLY);
+        if (S == (void *)-1) {
+            fprintf(stderr, "[lockstat] shmat: %s\n", strerror(errno));
+            return -1;
+        }
+        seg.addr = NULL;
+    }
+    int rc = 0;
+    if (S->magic != SHM_MAGIC) {
+        fprintf(stderr, "[lockstat] segment not initialized\n");
+        rc = -1;
+    } else if (!S->lockstat.enabled) {
+        fprintf(stderr, "[lockstat] profiler is off (start command_center with --lockstat)\n");
+        rc = -1;
+    } else {
+        memcpy(g_slots, S->lockstat.slot, sizeof(g_slots));
+        g_ticks = S->ticks;
+    }
+    if (seg.addr) shm_posix_close(&seg);
+    else shmdt(S);
+    return rc;
+}
+
+static void hist_merge(lockstat_hist_t *dst, const lockstat_hist_t *src) {
+    dst->count += src->count;
+    dst->total_ns += src->total_ns;
+    if (src->max_ns > dst->max_ns) dst->max_ns = src->max_ns;
+    for (int b = 0; b < LOCKSTAT_BUCKETS; b++) dst->hist[b] += src->hist[b];
+}
+
+static void print_stats(const lockstat_hist_t *h) {
+    char total[16], avg[16], p50[16], p99[16], max[16];
+    fmt_ns(total, sizeof(total), h->total_ns);
+    fmt_ns(avg, sizeof(avg), h->count ? h->total_ns / h->count : 0);
+    fmt_ns(p50, sizeof(p50), lockstat_quantile(h, 0.50));
+    fmt_ns(p99, sizeof(p99), lockstat_quantile(h, 0.99));
+    fmt_ns(max, sizeof(max), h->max_ns);
+    printf("%9llu %9s %8s %8s %8s %8s", (unsigned long long)h->count, total, avg, p50, p99, max);
+}
+
+static int cmp_total_desc(const void *a, const void *b) {
+    const row_t *x = a, *y = b;
+    if (x->h->total_ns != y->h->total_ns) return x->h->total_ns < y->h->total_ns ? 1 : -1;
+    return x->slot - y->slot;
+}
+
+/* Top processes by total time of one histogram kind (lock < 0: hold) */
+static void print_top(const char *title, int lock, int top) {
+    row_t rows[NSLOTS];
+    int n = 0;
+    uint64_t all = 0;
+    for (int s = 0; s < NSLOTS; s++) {
+        if (!g_slots[s].role[0]) continue;
+        const lockstat_hist_t *h = lock < 0 ? &g_slots[s].hold : &g_slots[s].wait[lock];
+        if (!h->count) continue;
+        rows[n++] = (row_t){ .slot = s, .h = h };
+        all += h->total_ns;
+    }
+    printf("\n%s\n", title);
+    if (n == 0) {
+        printf("  (no samples)\n");
+        return;
+    }
+    qsort(rows, (size_t)n, sizeof(rows[0]), cmp_total_desc);
+    printf("  role   id     pid     count     total      avg     ~p50     ~p99      max  share\n");
+    for (int i = 0; i < n && i < top; i++) {
+        const lockstat_slot_t *ls = &g_slots[rows[i].slot];
+        printf("  %-4s %4d %7d ", ls->role, rows[i].slot, ls->pid);
+        print_stats(rows[i].h);
+        printf(" %5.1f%%\n", all ? 100.0 * (double)rows[i].h->total_ns / (double)all : 0.0);
+    }
+    if (n > top) printf("  ... %d more\n", n - top);
+}
+
+/* Per role totals of every lock kind */
+static void print_roles(void) {
+    const char *roles[NSLOTS];
+    int nroles = 0;
+    for (int s = 0; s < NSLOTS; s++) {
+        if (!g_slots[s].role[0]) continue;
+        int k = 0;
+        while (k < nroles && strncmp(roles[k], g_slots[s].role, sizeof(g_slots[s].role)) != 0) k++;
+        if (k == nroles) roles[nroles++] = g_slots[s].role;
+    }
+    printf("\nBy role\n");
+    printf("  role   kind             count     total      avg     ~p50     ~p99      max\n");
+    for (int k = 0; k < nroles; k++) {
+        for (int kind = -1; kind < LOCKSTAT_LOCKS; kind++) {
+            lockstat_hist_t sum;
+            memset(&sum, 0, sizeof(sum));
+            for (int s = 0; s < NSLOTS; s++) {
+                if (strncmp(roles[k], g_slots[s].role, sizeof(g_slots[s].role)) != 0) continue;
+                hist_merge(&sum, kind < 0 ? &g_slots[s].hold : &g_slots[s].wait[kind]);
+            }
+            if (!sum.count) continue;
+            char name[24];
+            if (kind < 0) snprintf(name, sizeof(name), "global hold");
+            else snprintf(name, sizeof(name), "%s wait", lockstat_lock_name(kind));
+            printf("  %-4s   %-15s", roles[k], name);
+            print_stats(&sum);
+            putchar('\n');
+        }
+    }
+}
+
+/* Merged histogram of all processes, one bar per non-empty bucket */
+static void print_histogram(const char *title, int lock) {
+    lockstat_hist_t sum;
+    memset(&sum, 0, sizeof(sum));
+    for (int s = 0; s < NSLOTS; s++)
+        hist_merge(&sum, lock < 0 ? &g_slots[s].hold : &g_slots[s].wait[lock]);
+    if (!sum.count) return;
+    uint32_t peak = 0;
+    for (int b = 0; b < LOCKSTAT_BUCKETS; b++)
+        if (sum.hist[b] > peak) peak = sum.hist[b];
+    printf("\n%s (all processes)\n", title);
+    for (int b = 0; b < LOCKSTAT_BUCKETS; b++) {
+        if (!sum.hist[b]) continue;
+        char lo[16], hi[16];
+        fmt_ns(lo, sizeof(lo), b ? 1ull << b : 0);
+        fmt_ns(hi, sizeof(hi), 2ull << b);
+        int bar = (int)((uint64_t)sum.hist[b] * 50 / peak);
+        printf("  %8s .. %-8s %9u |%.*s\n", lo, hi, sum.hist[b], bar ? bar : 1,
+               "##################################################");
+    }
+}
+
+int main(int argc, char **argv) {
+    const char *ftok_path = "./ipc.key";
+    const char *path = NULL;
+    int top = 10;
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "-n") && i + 1 < argc) top = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--ftok") && i + 1 < argc) ftok_path = argv[++i];
+        else if (argv[i][0] == '-' || path) {
+            fprintf(stderr, "usage: %s [-n N] [--ftok path] [run_dir | lockstat.bin]\n", argv[0]);
+            return 2;
+        } else {
+            path = argv[i];
+        }
+    }
+    if (top < 1) top = 1;
+    if ((path ? load_dump(path) : load_live(ftok_path)) != 0) return 2;
+
+    int procs = 0;
+    for (int s = 0; s < NSLOTS; s++) procs += g_slots[s].role[0] != 0;
+    printf("Lock contention: %s, %u ticks, %d processes (~p50/~p99: histogram bucket bound)\n",
+           path ? path : "live", g_ticks, procs);
+
+    print_top("Longest holders of SEM_GLOBAL_LOCK (hold time, by total)", -1, top);
+    print_top("Most waiting for SEM_GLOBAL_LOCK (wait time, by total)", LOCKSTAT_GLOBAL, top);
+    print_top("Tick start wait (units: start permit / turn)", LOCKSTAT_TICK_START, top);
+    print_top("Tick barrier wait (CC: SEM_TICK_DONE)", LOCKSTAT_TICK_DONE, top);
+    print_roles();
+    print_histogram("SEM_GLOBAL_LOCK hold", -1);
+    print_histogram("SEM_GLOBAL_LOCK wait", LOCKSTAT_GLOBAL);
+    return 0;
+}
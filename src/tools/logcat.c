@@ -0,0 +1,262 @@
+/* skirmish-logcat - expands binary logs (SKIRMISH_LOG_FORMAT=binary) to text
+ *
+ * usage: skirmish-logcat <run_dir | file.blog>...
+ *        A run directory stands for all *.blog files in it. Records of all
+ *        files are merged by timestamp and printed in the text log format:
+ *        YYYY-MM-DD HH:MM:SS.mmm [LEVEL] ROLE u=UNIT pid=PID: message
+ * exit:  0 ok, 2 usage / IO error
+ */
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <dirent.h>
+#include <sys/stat.h>
+
+#include "log_bin.h"
+
+#define MAX_FMTS 65536
+
+typedef struct {
+    char path[600];
+    char *data;
+    size_t size;
+    log_bin_header_t hdr;
+    const log_bin_fmt_t *fmts[MAX_FMTS];   // definitions by fmt_id
+} blog_file_t;
+
+typedef struct {
+    uint64_t mono_ns;
+    uint32_t file;
+    size_t off;             // record offset in file data
+} rec_ref_t;
+
+static blog_file_t **g_files = NULL;
+static int g_nfiles = 0;
+static rec_ref_t *g_recs = NULL;
+static size_t g_nrecs = 0, g_cap = 0;
+
+static const char *lvl_name(int lvl) {
+    switch (lvl) {
+        case 0:  return "DEBUG";
+        case 1:  return "INFO ";
+        case 2:  return "WARN ";
+        case 3:  return "ERROR";
+        default: return "UNK";
+    }
+}
+
+static int load_file(const char *path) {
+    FILE *f = fopen(path, "rb");
+    if (!f) {
+        fprintf(stderr, "[logcat] %s: %s\n", path, strerror(errno));
+        return -1;
+    }
+    blog_file_t *bf = calloc(1, sizeof(*bf));
+    struct stat st;
+    if (!bf || fstat(fileno(f), &st) == -1) {
+        fclose(f);
+        free(bf);
+        return -1;
+    }
+    bf->size = (size_t)st.st_size;
+    bf->data = malloc(bf->size ? bf->size : 1);
+    if (!bf->data || fread(bf->data, 1, bf->size, f) != bf->size || bf->size < sizeof(bf->hdr)) {
+        fprintf(stderr, "[logcat] %s: short read\n", path);
+        fclose(f);
+        free(bf->data);
+        free(bf);
+        return -1;
+    }
+    fclose(f);
+    memcpy(&bf->hdr, bf->data, sizeof(bf->hdr));
+    if (memcmp(bf->hdr.magic, LOG_BIN_MAGIC, sizeof(bf->hdr.magic)) != 0) {
+        fprintf(stderr, "[logcat] %s: not a binary log\n", path);
+        free(bf->data);
+        free(bf);
+        return -1;
+    }
+    snprintf(bf->path, sizeof(bf->path), "%s", path);
+
+    /* one pass: definitions by id, message offsets for the merge */
+    size_t off = sizeof(bf->hdr);
+    while (off < bf->size) {
+        uint8_t kind = (uint8_t)bf->data[off];
+        if (kind == LOG_BIN_FMT && off + sizeof(log_bin_fmt_t) <= bf->size) {
+            const log_bin_fmt_t *d = (const log_bin_fmt_t *)(bf->data + off);
+            size_t len = sizeof(*d) + d->nargs + d->len;
+            if (off + len > bf->size) break;
+            bf->fmts[d->fmt_id] = d;
+            off += len;
+        } else if (kind == LOG_BIN_MSG && off + sizeof(log_bin_msg_t) <= bf->size) {
+            const log_bin_msg_t *m = (const log_bin_msg_t *)(bf->data + off);
+            size_t len = sizeof(*m) + m->payload_len;
+            if (off + len > bf->size) break;
+            if (g_nrecs == g_cap) {
+                g_cap = g_cap ? g_cap * 2 : 4096;
+                g_recs = realloc(g_recs, g_cap * sizeof(*g_recs));
+                if (!g_recs) return -1;
+            }
+            g_recs[g_nrecs++] = (rec_ref_t){ .mono_ns = m->mono_ns, .file = (uint32_t)g_nfiles, .off = off };
+            off += len;
+        } else {
+            fprintf(stderr, "[logcat] %s: bad record at offset %zu, rest skipped\n", path, off);
+            break;
+        }
+    }
+
+    g_files = realloc(g_files, (size_t)(g_nfiles + 1) * sizeof(*g_files));
+    if (!g_files) return -1;
+    g_files[g_nfiles++] = bf;
+    return 0;
+}
+
+static int load_dir(const char *dir) {
+    DIR *d = opendir(dir);
+    if (!d) {
+        fprintf(stderr, "[logcat] %s: %s\n", dir, strerror(errno));
+        return -1;
+    }
+    struct dirent *de;
+    int n = 0;
+    while ((de = readdir(d)) != NULL) {
+        size_t len = strlen(de->d_name);
+        if (len < 6 || strcmp(de->d_name + len - 5, ".blog") != 0) continue;
+        char path[1024];
+        snprintf(path, sizeof(path), "%s/%s", dir, de->d_name);
+        if (load_file(path) == 0) n++;
+    }
+    closedir(d);
+    if (n == 0) fprintf(stderr, "[logcat] %s: no .blog files\n", dir);
+    return n ? 0 : -1;
+}
+
+static int cmp_rec(const void *a, const void *b) {
+    const rec_ref_t *x = a, *y = b;
+    if (x->mono_ns != y->mono_ns) return x->mono_ns < y->mono_ns ? -1 : 1;
+    if (x->file != y->file) return x->file < y->file ? -1 : 1;
+    return (x->off > y->off) - (x->off < y->off);
+}
+
+/* Expand fmt with the raw arguments in payload, one conversion at a time */
+static void render(FILE *out, const log_bin_fmt_t *d, const char *payload, size_t plen) {
+    const uint8_t *types = (const uint8_t *)(d + 1);
+    const char *fmt = (const char *)(types + d->nargs);
+    const char *end = fmt + d->len;
+    size_t pos = 0;
+    int arg = 0;
+    char buf[1100];
+
+#define TAKE(T, v) do { if (pos + sizeof(T) > plen) goto short_payload; memcpy(&(v), payload + pos, sizeof(T)); pos += sizeof(T); arg++; } while (0)
+
+    for (const char *p = fmt; p < end; p++) {
+        if (*p != '%') { fputc(*p, out); continue; }
+        if (p + 1 < end && p[1] == '%') { fputc('%', out); p++; continue; }
+
+        /* copy one conversion spec, substituting '*' with its int argument */
+        char spec[64];
+        size_t sl = 0;
+        spec[sl++] = *p++;
+        while (p < end && sl < sizeof(spec) - 16) {
+            char c = *p;
+            if (c == '*') {
+                int32_t v;
+                TAKE(int32_t, v);
+                sl += (size_t)snprintf(spec + sl, sizeof(spec) - sl, "%d", v);
+                p++;
+                continue;
+            }
+            spec[sl++] = c;
+            if (strchr("diuxXocfFeEgGaAsp", c)) break;
+            p++;
+        }
+        spec[sl] = '\0';
+        if (arg >= d->nargs) { fputs(spec, out); continue; }
+
+        switch (types[arg]) {
+            case LOG_ARG_I32: { int32_t v; TAKE(int32_t, v); snprintf(buf, sizeof(buf), spec, v); break; }
+            case LOG_ARG_I64: { int64_t v; TAKE(int64_t, v); snprintf(buf, sizeof(buf), spec, (long long)v); break; }
+            case LOG_ARG_F64: { double v; TAKE(double, v); snprintf(buf, sizeof(buf), spec, v); break; }
+            case LOG_ARG_PTR: { uint64_t v; TAKE(uint64_t, v); snprintf(buf, sizeof(buf), spec, (void *)(uintptr_t)v); break; }
+            case LOG_ARG_STR: {
+                uint16_t l;
+                if (pos + 2 > plen) goto short_payload;
+                memcpy(&l, payload + pos, 2);
+                if (pos + 2 + l > plen) goto short_payload;
+                char s[1024];
+                size_t n = l < sizeof(s) - 1 ? l : sizeof(s) - 1;
+                memcpy(s, payload + pos + 2, n);
+                s[n] = '\0';
+                pos += 2 + (size_t)l;
+                arg++;
+                snprintf(buf, sizeof(buf), spec, s);
+                break;
+            }
+            default:
+                goto short_payload;
+        }
+        fputs(buf, out);
+        if (p >= end) break;
+    }
+    return;
+
+short_payload:
+    fputs("<truncated>", out);
+#undef TAKE
+}
+
+int main(int argc, char **argv) {
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s <run_dir | file.blog>...\n", argv[0]);
+        return 2;
+    }
+    for (int i = 1; i < argc; i++) {
+        struct stat st;
+        if (stat(argv[i], &st) == -1) {
+            fprintf(stderr, "[logcat] %s: %s\n", argv[i], strerror(errno));
+            return 2;
+        }
+        if ((S_ISDIR(st.st_mode) ? load_dir(argv[i]) : load_file(argv[i])) != 0) return 2;
+    }
+
+    qsort(g_recs, g_nrecs, sizeof(*g_recs), cmp_rec);
+
+    unsigned long unknown = 0;
+    for (size_t i = 0; i < g_nrecs; i++) {
+        const blog_file_t *bf = g_files[g_recs[i].file];
+        const log_bin_msg_t *m = (const log_bin_msg_t *)(bf->data + g_recs[i].off);
+        const log_bin_fmt_t *d = bf->fmts[m->fmt_id];
+
+        /* monotonic -> wall clock through the pair recorded at log_init */
+        uint64_t real_ns = bf->hdr.real_ns + (m->mono_ns - bf->hdr.mono_ns);
+        time_t sec = (time_t)(real_ns / 1000000000ull);
+        struct tm tm;
+        localtime_r(&sec, &tm);
+        char role[9];
+        memcpy(role, bf->hdr.role, 8);
+        role[8] = '\0';
+        printf("%04d-%02d-%02d %02d:%02d:%02d.%03llu [%s] %s u=%d pid=%d: ",
+               tm.tm_year + 1900, tm.tm_mon + 1, tm.tm_mday, tm.tm_hour, tm.tm_min, tm.tm_sec,
+               (unsigned long long)(real_ns % 1000000000ull / 1000000ull),
+               lvl_name(m->level), role, bf->hdr.unit_id, bf->hdr.pid);
+        if (d) {
+            render(stdout, d, (const char *)(m + 1), m->payload_len);
+        } else {
+            printf("<unknown format %u>", m->fmt_id);
+            unknown++;
+        }
+        putchar('\n');
+    }
+
+    if (unknown) fprintf(stderr, "[logcat] %lu records with unknown format id\n", unknown);
+    fprintf(stderr, "[logcat] %zu records from %d files\n", g_nrecs, g_nfiles);
+    for (int i = 0; i < g_nfiles; i++) {
+        free(g_files[i]->data);
+        free(g_files[i]);
+    }
+    free(g_files);
+    free(g_recs);
+    return 0;
+}
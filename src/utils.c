@@ -1,5 +1,6 @@
 #define _GNU_SOURCE
 #include "log.h"
+#include "log_bin.h"
 #include "error_handler.h"
 
 #include <stdio.h>
@@ -7,29 +8,96 @@
 #include <stdarg.h>
 #include <stdint.h>
 #include <string.h>
+#include <strings.h>
 #include <errno.h>
+#include <limits.h>
+#include <sched.h>
 #include <time.h>
 #include <unistd.h>
 #include <fcntl.h>
+#include <pthread.h>
 #include <sys/stat.h>
+#include <sys/uio.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
 
 /* Simple logging backend used by the project.
  *
- * - Each process has a per-process FILE* log (g_logf) for its own messages.
+ * - Each process has a per-process log file (g_log_fd) for its own messages.
  * - All processes append lines to a single combined file ALL.log (g_all_fd)
  *   opened with O_APPEND so writes are atomic per line.
  * - The run directory is taken from SKIRMISH_RUN_DIR or defaults to "logs".
- * - log_msg formats a timestamped line and writes it to both destinations.
+ * - log_msg formats a timestamped line straight into a slot of a lock-free
+ *   ring (multi-producer: any thread). A writer thread drains the ring and
+ *   writes each batch with one writev per file. When the ring is full the
+ *   line is dropped and counted; the writer reports drops in the log.
+ * - Before the writer runs (and in a forked child) lines are written directly.
+ * - Binary mode (SKIRMISH_LOG_FORMAT=binary, see log_bin.h): instead of text,
+ *   a record with format id, monotonic timestamp and raw arguments is put in
+ *   the ring; format strings are written once per process. Only the
+ *   per-process .blog file is written (no ALL.log); skirmish-logcat merges
+ *   and expands them.
  */
 
-/* per-process log (FILE*) */
-static FILE *g_logf = NULL;
+/* ring slots (power of 2) and max line length (longer lines are truncated) */
+#define LOG_RING_SLOTS 256
+#define LOG_LINE_MAX 1024
+/* lines per writev (well below IOV_MAX) */
+#define LOG_BATCH 64
+/* writer flushes at least this often while lines are pending */
+#define LOG_FLUSH_MS 10
+
+typedef struct {
+    uint32_t seq;               // == pos: free for producer, == pos + 1: ready for writer
+    uint32_t len;
+    char line[LOG_LINE_MAX];
+} log_slot_t;
+
+static log_slot_t g_ring[LOG_RING_SLOTS];
+static uint32_t g_ring_head = 0;        // next slot the writer takes (writer only)
+static uint32_t g_ring_tail = 0;        // next slot a producer claims
+static uint32_t g_kick = 0;             // futex word: bumped to wake the writer early
+static uint64_t g_lines = 0;            // lines written
+static uint64_t g_dropped = 0;          // lines dropped (ring full)
+static uint64_t g_writevs = 0;          // writev calls (per file)
+
+static pthread_t g_writer;
+static int g_async = 0;                 // writer thread running
+static volatile int g_writer_stop = 0;
+
+/* per-process log (fd opened with O_APPEND) */
+static int g_log_fd = -1;
 /* global combined log (fd opened with O_APPEND for atomic line appends) */
 static int g_all_fd = -1;
 
-static log_level_t g_min_lvl = LOG_LVL_DEBUG;
+/* binary mode: format registry, keyed by format string address */
+#define LOG_FMT_TABLE 1024
+typedef struct {
+    const char *fmt;
+    uint32_t state;             // 0 empty, 1 being filled, 2 ready
+    uint16_t id;
+    int8_t nargs;               // -1: not loggable as binary, logged as "%s" text
+    uint8_t defined;            // definition record written
+    uint8_t types[LOG_BIN_MAX_ARGS];
+} log_fmt_entry_t;
+
+static int g_binary = 0;
+static log_fmt_entry_t g_fmts[LOG_FMT_TABLE];
+static uint32_t g_next_fmt_id = 0;
+static const char k_text_fmt[] = "%s";
+
+/* runtime levels: process-local until log_bind_levels points them into shm */
+static uint8_t g_local_levels[LOG_MOD_COUNT];
+static log_module_t g_self_mod = LOG_MOD_CC;
+volatile uint8_t *g_log_levels = g_local_levels;
+volatile uint8_t *g_log_self_level = &g_local_levels[LOG_MOD_CC];
+
+static const char *const k_mod_names[LOG_MOD_COUNT] = { "CC", "BS", "SQ", "UI", "CM", "IPC" };
+static const char *const k_lvl_names[] = { "debug", "info", "warn", "error" };
+
 static char g_role[8] = "??";
 static uint16_t g_unit_id = 0;
+static int g_pid = 0;
 
 /* directory for this run (default "logs", overridden by env) */
 static char g_run_dir[512] = "logs";
@@ -78,6 +146,287 @@ static void open_global_log(void) {
     }
 }
 
+static long futex(uint32_t *uaddr, int op, uint32_t val, const struct timespec *ts) {
+    return syscall(SYS_futex, uaddr, op, val, ts, NULL, 0);
+}
+
+/* Write iov[0..n) to fd with one writev, finishing short writes */
+static void write_all_iov(int fd, struct iovec *iov, int n) {
+    while (n > 0) {
+        ssize_t w = writev(fd, iov, n);
+        if (w == -1) {
+            if (errno == EINTR) continue;
+            perror("[LOG] writev");
+            return;
+        }
+        g_writevs++;
+        while (n > 0 && (size_t)w >= iov->iov_len) {
+            w -= (ssize_t)iov->iov_len;
+            iov++;
+            n--;
+        }
+        if (n > 0) {
+            iov->iov_base = (char *)iov->iov_base + w;
+            iov->iov_len -= (size_t)w;
+        }
+    }
+}
+
+static void write_both(struct iovec *iov, int n) {
+    struct iovec copy[LOG_BATCH];
+    if (g_log_fd != -1) {
+        memcpy(copy, iov, (size_t)n * sizeof(*iov));
+        write_all_iov(g_log_fd, copy, n);
+    }
+    if (g_all_fd != -1) write_all_iov(g_all_fd, iov, n);
+}
+
+/* Write up to LOG_BATCH ready lines; returns number of lines written */
+static int ring_flush_batch(void) {
+    struct iovec iov[LOG_BATCH];
+    uint32_t pos = g_ring_head;
+    int n = 0;
+    while (n < LOG_BATCH) {
+        log_slot_t *slot = &g_ring[pos & (LOG_RING_SLOTS - 1)];
+        if (__atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE) != pos + 1) break;
+        iov[n].iov_base = slot->line;
+        iov[n].iov_len = slot->len;
+        n++;
+        pos++;
+    }
+    if (n == 0) return 0;
+
+    write_both(iov, n);
+
+    /* hand the slots back to producers */
+    for (uint32_t p = g_ring_head; p != pos; p++)
+        __atomic_store_n(&g_ring[p & (LOG_RING_SLOTS - 1)].seq, p + LOG_RING_SLOTS, __ATOMIC_RELEASE);
+    __atomic_store_n(&g_ring_head, pos, __ATOMIC_RELAXED);
+    g_lines += (uint64_t)n;
+    return n;
+}
+
+/* Format "YYYY-mm-dd HH:MM:SS.mmm [LVL] ROLE u=N pid=P: " into buf.
+ * localtime_r runs once per second per thread, not once per line. */
+static int format_prefix(char *buf, size_t size, log_level_t lvl) {
+    static __thread time_t cached_sec = (time_t)-1;
+    static __thread char cached_date[80];
+
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    if (ts.tv_sec != cached_sec) {
+        struct tm tm;
+        localtime_r(&ts.tv_sec, &tm);
+        snprintf(cached_date, sizeof(cached_date), "%04d-%02d-%02d %02d:%02d:%02d",
+                 tm.tm_year + 1900, tm.tm_mon + 1, tm.tm_mday,
+                 tm.tm_hour, tm.tm_min, tm.tm_sec);
+        cached_sec = ts.tv_sec;
+    }
+    return snprintf(buf, size, "%s.%03ld [%s] %s u=%u pid=%d: ",
+                    cached_date, ts.tv_nsec / 1000000,
+                    lvl_name(lvl), g_role, (unsigned)g_unit_id, g_pid);
+}
+
+/* Format prefix + message + '\n' into buf (truncated to size); returns length */
+static int format_line(char *buf, size_t size, log_level_t lvl, const char *fmt, va_list ap) {
+    int len = format_prefix(buf, size, lvl);
+    if (len < 0) len = 0;
+    if ((size_t)len < size) {
+        int m = vsnprintf(buf + len, size - (size_t)len, fmt, ap);
+        if (m > 0) len += m;
+    }
+    if (len > (int)size - 2) len = (int)size - 2;
+    buf[len++] = '\n';
+    buf[len] = '\0';
+    return len;
+}
+
+/* Registry entry of fmt (registered on first use); NULL if the table is full */
+static log_fmt_entry_t *fmt_entry(const char *fmt) {
+    uint32_t h = (uint32_t)(((uintptr_t)fmt >> 3) * 2654435761u);
+    for (uint32_t i = 0; i < LOG_FMT_TABLE; i++) {
+        log_fmt_entry_t *e = &g_fmts[(h + i) & (LOG_FMT_TABLE - 1)];
+        uint32_t st = __atomic_load_n(&e->state, __ATOMIC_ACQUIRE);
+        if (st == 0) {
+            uint32_t zero = 0;
+            if (__atomic_compare_exchange_n(&e->state, &zero, 1, 0, __ATOMIC_ACQUIRE, __ATOMIC_ACQUIRE)) {
+                e->fmt = fmt;
+                e->nargs = (int8_t)log_bin_parse_format(fmt, e->types, LOG_BIN_MAX_ARGS);
+                e->id = (uint16_t)__atomic_fetch_add(&g_next_fmt_id, 1, __ATOMIC_RELAXED);
+                __atomic_store_n(&e->state, 2, __ATOMIC_RELEASE);
+                return e;
+            }
+            st = zero;
+        }
+        while (st == 1) {
+            sched_yield();
+            st = __atomic_load_n(&e->state, __ATOMIC_ACQUIRE);
+        }
+        if (e->fmt == fmt) return e;
+    }
+    return NULL;
+}
+
+/* Encode the definition record of e into buf; returns length */
+static int encode_fmt_def(char *buf, size_t size, const log_fmt_entry_t *e) {
+    int nargs = e->nargs < 0 ? 0 : e->nargs;
+    size_t len = strlen(e->fmt);
+    size_t room = size - sizeof(log_bin_fmt_t) - (size_t)nargs;
+    if (len > room) len = room;
+    log_bin_fmt_t h = { .kind = LOG_BIN_FMT, .nargs = (uint8_t)nargs, .fmt_id = e->id, .len = (uint16_t)len };
+    memcpy(buf, &h, sizeof(h));
+    memcpy(buf + sizeof(h), e->types, (size_t)nargs);
+    memcpy(buf + sizeof(h) + (size_t)nargs, e->fmt, len);
+    return (int)(sizeof(h) + (size_t)nargs + len);
+}
+
+/* Encode one call of e as a message record into buf; returns length */
+static int encode_msg(char *buf, size_t size, log_level_t lvl, const log_fmt_entry_t *e, va_list ap) {
+    char *p = buf + sizeof(log_bin_msg_t);
+    char *end = buf + size;
+    for (int i = 0; i < e->nargs; i++) {
+        switch (e->types[i]) {
+            case LOG_ARG_I32: {
+                int32_t v = (int32_t)va_arg(ap, int);
+                if (end - p < (long)sizeof(v)) goto full;
+                memcpy(p, &v, sizeof(v)); p += sizeof(v);
+                break;
+            }
+            case LOG_ARG_I64: {
+                int64_t v = (int64_t)va_arg(ap, long long);
+                if (end - p < (long)sizeof(v)) goto full;
+                memcpy(p, &v, sizeof(v)); p += sizeof(v);
+                break;
+            }
+            case LOG_ARG_F64: {
+                double v = va_arg(ap, double);
+                if (end - p < (long)sizeof(v)) goto full;
+                memcpy(p, &v, sizeof(v)); p += sizeof(v);
+                break;
+            }
+            case LOG_ARG_PTR: {
+                uint64_t v = (uint64_t)(uintptr_t)va_arg(ap, void *);
+                if (end - p < (long)sizeof(v)) goto full;
+                memcpy(p, &v, sizeof(v)); p += sizeof(v);
+                break;
+            }
+            case LOG_ARG_STR: {
+                const char *str = va_arg(ap, const char *);
+                if (!str) str = "(null)";
+                if (end - p < 2) goto full;
+                size_t len = strlen(str);
+                if (len > (size_t)(end - p - 2)) len = (size_t)(end - p - 2);
+                uint16_t l16 = (uint16_t)len;
+                memcpy(p, &l16, 2);
+                memcpy(p + 2, str, len);
+                p += 2 + len;
+                break;
+            }
+        }
+    }
+full:;
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    log_bin_msg_t h = {
+        .kind = LOG_BIN_MSG, .level = (uint8_t)lvl, .fmt_id = e->id,
+        .payload_len = (uint16_t)(p - buf - (long)sizeof(log_bin_msg_t)),
+        .mono_ns = (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec
+    };
+    memcpy(buf, &h, sizeof(h));
+    return (int)(p - buf);
+}
+
+static int encode_msg_v(char *buf, size_t size, log_level_t lvl, const log_fmt_entry_t *e, ...) {
+    va_list ap;
+    va_start(ap, e);
+    int len = encode_msg(buf, size, lvl, e, ap);
+    va_end(ap);
+    return len;
+}
+
+/* Encode one call as a message record; formats that cannot be encoded are
+ * formatted here and logged as "%s". *def is the entry the record refers to
+ * (its definition must be written once). Returns length, 0 if not encodable. */
+static int encode_call(char *buf, size_t size, log_level_t lvl, const char *fmt, va_list ap,
+                       log_fmt_entry_t **def) {
+    log_fmt_entry_t *e = fmt_entry(fmt);
+    if (e && e->nargs >= 0) {
+        *def = e;
+        return encode_msg(buf, size, lvl, e, ap);
+    }
+    char text[LOG_LINE_MAX - 64];
+    vsnprintf(text, sizeof(text), fmt, ap);
+    e = fmt_entry(k_text_fmt);
+    if (!e) return 0;
+    *def = e;
+    return encode_msg_v(buf, size, lvl, e, text);
+}
+
+/* Text line or binary record(s) for one call, written directly (no ring) */
+static void log_direct(log_level_t lvl, const char *fmt, va_list ap) {
+    char rec[LOG_LINE_MAX];
+    struct iovec iov = { .iov_base = rec };
+    if (!g_binary) {
+        iov.iov_len = (size_t)format_line(rec, sizeof(rec), lvl, fmt, ap);
+        write_both(&iov, 1);
+        return;
+    }
+    log_fmt_entry_t *def = NULL;
+    char msg[LOG_LINE_MAX];
+    int len = encode_call(msg, sizeof(msg), lvl, fmt, ap, &def);
+    if (len <= 0) return;
+    if (!def->defined) {
+        iov.iov_len = (size_t)encode_fmt_def(rec, sizeof(rec), def);
+        write_both(&iov, 1);
+        def->defined = 1;
+    }
+    iov.iov_base = msg;
+    iov.iov_len = (size_t)len;
+    write_both(&iov, 1);
+}
+
+static void log_direct_f(log_level_t lvl, const char *fmt, ...) {
+    va_list ap;
+    va_start(ap, fmt);
+    log_direct(lvl, fmt, ap);
+    va_end(ap);
+}
+
+static void *log_writer_main(void *arg) {
+    (void)arg;
+    uint64_t reported = 0;
+    for (;;) {
+        uint32_t kick = __atomic_load_n(&g_kick, __ATOMIC_ACQUIRE);
+        int stop = g_writer_stop;
+        while (ring_flush_batch() == LOG_BATCH) {
+        }
+
+        /* report new drops once per flush, not once per dropped line */
+        uint64_t dropped = __atomic_load_n(&g_dropped, __ATOMIC_RELAXED);
+        if (dropped != reported) {
+            log_direct_f(LOG_LVL_WARN, "[LOG] ring full, %llu lines dropped (%llu total)",
+                         (unsigned long long)(dropped - reported), (unsigned long long)dropped);
+            reported = dropped;
+        }
+
+        if (stop) break;
+        struct timespec ts = { .tv_sec = 0, .tv_nsec = LOG_FLUSH_MS * 1000000L };
+        (void)futex(&g_kick, FUTEX_WAIT_PRIVATE, kick, &ts);
+    }
+    return NULL;
+}
+
+static void log_wake_writer(void) {
+    __atomic_add_fetch(&g_kick, 1, __ATOMIC_RELEASE);
+    (void)futex(&g_kick, FUTEX_WAKE_PRIVATE, 1, NULL);
+}
+
+/* forked child: the writer thread does not exist there, write directly */
+static void log_atfork_child(void) {
+    g_async = 0;
+    g_pid = (int)getpid();
+}
+
 /* Initialize logging for this process.
  * - role: short identifier string ("CC","BS",...)
  * - unit_id: 0 for CC, otherwise the unit id.
@@ -114,32 +463,66 @@ int log_init(const char *role, int16_t unit_id) {
     ensure_dir_exists("logs");     /* base */
     ensure_dir_exists(g_run_dir);  /* run dir (may be "logs" too) */
 
+    const char *lf = getenv("SKIRMISH_LOG_FORMAT");
+    g_binary = (lf && !strcmp(lf, "binary"));
+
     g_unit_id = unit_id;
     strncpy(g_role, role ? role : "??", sizeof(g_role) - 1);
     g_role[sizeof(g_role) - 1] = '\0';
+    int mod = log_module_from_name(g_role);
+    g_self_mod = mod >= 0 ? (log_module_t)mod : LOG_MOD_CC;
+    g_log_self_level = &g_log_levels[g_self_mod];
 
     char path[600];
     pid_t pid = getpid();
 
+    const char *ext = g_binary ? "blog" : "log";
     if (unit_id == 0) {
-        snprintf(path, sizeof(path), "%s/%s_pid_%d.log", g_run_dir, g_role, (int)pid);
+        snprintf(path, sizeof(path), "%s/%s_pid_%d.%s", g_run_dir, g_role, (int)pid, ext);
     } else {
-        snprintf(path, sizeof(path), "%s/%s_u%u_pid_%d.log",
-                 g_run_dir, g_role, (unsigned)unit_id, (int)pid);
+        snprintf(path, sizeof(path), "%s/%s_u%u_pid_%d.%s",
+                 g_run_dir, g_role, (unsigned)unit_id, (int)pid, ext);
     }
 
-    g_logf = fopen(path, "a");  /* append */
-    if (!g_logf) {
-        perror("[LOG] fopen per-process log");
+    g_pid = (int)pid;
+    g_log_fd = open(path, O_WRONLY | O_CREAT | O_APPEND, 0644);
+    if (g_log_fd == -1) {
+        perror("[LOG] open per-process log");
         fprintf(stderr, "[LOG] Failed to open log file '%s': %s (errno=%d)\n", 
                 path, strerror(errno), errno);
         return -1;
     }
 
-    /* Make per-process log line-buffered for timely flushing. */
-    setvbuf(g_logf, NULL, _IOLBF, 0);
+    if (g_binary) {
+        /* binary: self-describing per-process file only, merged by skirmish-logcat */
+        struct timespec mono, real;
+        clock_gettime(CLOCK_MONOTONIC, &mono);
+        clock_gettime(CLOCK_REALTIME, &real);
+        log_bin_header_t hdr = { .pid = (int32_t)pid, .unit_id = unit_id };
+        memcpy(hdr.magic, LOG_BIN_MAGIC, sizeof(hdr.magic));
+        memcpy(hdr.role, g_role, sizeof(hdr.role));
+        hdr.mono_ns = (uint64_t)mono.tv_sec * 1000000000ull + (uint64_t)mono.tv_nsec;
+        hdr.real_ns = (uint64_t)real.tv_sec * 1000000000ull + (uint64_t)real.tv_nsec;
+        if (write(g_log_fd, &hdr, sizeof(hdr)) != (ssize_t)sizeof(hdr)) perror("[LOG] write header");
+    } else {
+        open_global_log();
+    }
 
-    open_global_log();
+    /* Start the writer; on failure log_msg keeps writing synchronously. */
+    static int atfork_registered = 0;
+    if (!atfork_registered) {
+        pthread_atfork(NULL, NULL, log_atfork_child);
+        atfork_registered = 1;
+    }
+    g_ring_head = g_ring_tail = 0;
+    for (uint32_t i = 0; i < LOG_RING_SLOTS; i++) g_ring[i].seq = i;
+    g_writer_stop = 0;
+    int err = pthread_create(&g_writer, NULL, log_writer_main, NULL);
+    if (err != 0) {
+        fprintf(stderr, "[LOG] writer thread not started (%s), logging synchronously\n", strerror(err));
+    } else {
+        g_async = 1;
+    }
 
     /* Emit startup header to both logs. */
     log_msg(LOG_LVL_INFO, "logger started (role=%s unit=%u pid=%d run_dir=%s)",
@@ -148,16 +531,26 @@ int log_init(const char *role, int16_t unit_id) {
     return 0;
 }
 
-/* Close logs (idempotent). */
+/* Close logs (idempotent): drain the ring, stop the writer, close files. */
 void log_close(void) {
-    if (g_logf) {
-        log_msg(LOG_LVL_INFO, "logger closing");
-        if (fclose(g_logf) != 0) {
-            perror("[LOG] fclose per-process log");
+    if (g_log_fd != -1) {
+        log_msg(LOG_LVL_INFO, "logger closing (%llu lines written, %llu dropped, %llu writev)",
+                (unsigned long long)g_lines, (unsigned long long)g_dropped,
+                (unsigned long long)g_writevs);
+    }
+    if (g_async) {
+        g_writer_stop = 1;
+        log_wake_writer();
+        pthread_join(g_writer, NULL);
+        g_async = 0;
+    }
+    if (g_log_fd != -1) {
+        if (close(g_log_fd) == -1) {
+            perror("[LOG] close per-process log");
             fprintf(stderr, "[LOG] Error closing per-process log: %s (errno=%d)\n", 
                     strerror(errno), errno);
         }
-        g_logf = NULL;
+        g_log_fd = -1;
     }
     if (g_all_fd != -1) {
         if (close(g_all_fd) == -1) {
@@ -169,65 +562,127 @@ void log_close(void) {
     }
 }
 
-/* Adjust minimum log level; messages below this are dropped. */
+uint64_t log_dropped(void) {
+    return __atomic_load_n(&g_dropped, __ATOMIC_RELAXED);
+}
+
+/* Adjust minimum log level of all modules; messages below this are dropped. */
 void log_set_level(log_level_t lvl) {
-    g_min_lvl = lvl;
+    for (int m = 0; m < LOG_MOD_COUNT; m++) log_set_module_level((log_module_t)m, lvl);
 }
 
-/* Format a timestamped log line and write to per-process log and ALL.log.
- * - Lines are terminated with '\n'. The combined log uses write(2) to ensure
- *   O_APPEND append atomicy across processes.
- */
-void log_msg(log_level_t lvl, const char *fmt, ...) {
-    if (lvl < g_min_lvl) return;
+void log_set_module_level(log_module_t mod, log_level_t lvl) {
+    if ((unsigned)mod >= LOG_MOD_COUNT) return;
+    __atomic_store_n(&g_log_levels[mod], (uint8_t)lvl, __ATOMIC_RELAXED);
+}
 
-    char line[1024];
+log_level_t log_get_module_level(log_module_t mod) {
+    if ((unsigned)mod >= LOG_MOD_COUNT) return LOG_LVL_DEBUG;
+    return (log_level_t)__atomic_load_n(&g_log_levels[mod], __ATOMIC_RELAXED);
+}
 
-    struct timespec ts;
-    clock_gettime(CLOCK_REALTIME, &ts);
-    struct tm tm;
-    localtime_r(&ts.tv_sec, &tm);
+/* Switch the level table (shm or back to the local copy). Levels are not
+ * copied: the shared table is authoritative for every attached process. */
+void log_bind_levels(uint8_t *levels, int n) {
+    volatile uint8_t *t = (levels && n >= LOG_MOD_COUNT) ? levels : g_local_levels;
+    g_log_levels = t;
+    g_log_self_level = &t[g_self_mod];
+}
 
-    int len = snprintf(
-        line, sizeof(line),
-        "%04d-%02d-%02d %02d:%02d:%02d.%03ld [%s] %s u=%u pid=%d: ",
-        tm.tm_year + 1900, tm.tm_mon + 1, tm.tm_mday,
-        tm.tm_hour, tm.tm_min, tm.tm_sec, ts.tv_nsec / 1000000,
-        lvl_name(lvl), g_role, (unsigned)g_unit_id, (int)getpid()
-    );
+const char *log_module_name(log_module_t mod) {
+    return (unsigned)mod < LOG_MOD_COUNT ? k_mod_names[mod] : "??";
+}
+
+const char *log_level_name(log_level_t lvl) {
+    return (unsigned)lvl <= LOG_LVL_ERROR ? k_lvl_names[lvl] : "??";
+}
+
+int log_module_from_name(const char *name) {
+    for (int m = 0; m < LOG_MOD_COUNT; m++)
+        if (name && strcasecmp(name, k_mod_names[m]) == 0) return m;
+    return -1;
+}
+
+int log_level_from_name(const char *name) {
+    for (int l = 0; l <= LOG_LVL_ERROR; l++)
+        if (name && strcasecmp(name, k_lvl_names[l]) == 0) return l;
+    if (name && name[0] >= '0' && name[0] <= '3' && name[1] == '\0') return name[0] - '0';
+    return -1;
+}
+
+/* Claim a free ring slot (multi-producer); NULL if the ring is full (counted as drop) */
+static log_slot_t *ring_claim(uint32_t *out_pos) {
+    uint32_t pos = __atomic_load_n(&g_ring_tail, __ATOMIC_RELAXED);
+    for (;;) {
+        log_slot_t *slot = &g_ring[pos & (LOG_RING_SLOTS - 1)];
+        int32_t diff = (int32_t)(__atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE) - pos);
+        if (diff == 0) {
+            if (__atomic_compare_exchange_n(&g_ring_tail, &pos, pos + 1, 1,
+                                            __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+                *out_pos = pos;
+                return slot;
+            }
+        } else if (diff < 0) {
+            __atomic_add_fetch(&g_dropped, 1, __ATOMIC_RELAXED);
+            log_wake_writer();
+            return NULL;
+        } else {
+            pos = __atomic_load_n(&g_ring_tail, __ATOMIC_RELAXED);
+        }
+    }
+}
+
+/* Hand a filled slot to the writer; wake it early when half full or on warnings/errors */
+static void ring_publish(log_slot_t *slot, uint32_t pos, log_level_t lvl) {
+    __atomic_store_n(&slot->seq, pos + 1, __ATOMIC_RELEASE);
+    uint32_t used = pos + 1 - __atomic_load_n(&g_ring_head, __ATOMIC_RELAXED);
+    if (lvl >= LOG_LVL_WARN || used == LOG_RING_SLOTS / 2) log_wake_writer();
+}
+
+/* Format a timestamped log line into the ring (or write it directly if no writer).
+ * - Lines are terminated with '\n'. Each batch is one writev per file; the
+ *   combined log is O_APPEND, so batches from different processes do not mix.
+ * - Ring full: the line is dropped and counted (never blocks the caller).
+ * - Binary mode: the slot gets a message record instead of text (log_bin.h).
+ */
+void log_msg(log_level_t lvl, const char *fmt, ...) {
+    if (g_log_fd == -1 && g_all_fd == -1) return;
 
     va_list ap;
     va_start(ap, fmt);
-    len += vsnprintf(line + len, sizeof(line) - (size_t)len, fmt, ap);
-    va_end(ap);
 
-    if (len < (int)sizeof(line) - 1) {
-        line[len++] = '\n';
-        line[len] = '\0';
-    } else {
-        line[sizeof(line) - 2] = '\n';
-        line[sizeof(line) - 1] = '\0';
-        len = (int)sizeof(line) - 1;
+    if (!g_async) {
+        log_direct(lvl, fmt, ap);
+        va_end(ap);
+        return;
     }
 
-    /* Write to per-process log file if available. */
-    if (g_logf) {
-        if (fwrite(line, 1, (size_t)len, g_logf) != (size_t)len) {
-            perror("[LOG] fwrite to per-process log");
-        }
-        if (fflush(g_logf) != 0) {
-            perror("[LOG] fflush");
-        }
+    uint32_t pos;
+    log_slot_t *slot = ring_claim(&pos);
+    if (!slot) {
+        va_end(ap);
+        return;
     }
 
-    /* Append atomically to combined ALL.log if available. */
-    if (g_all_fd != -1) {
-        ssize_t written = write(g_all_fd, line, (size_t)len);
-        if (written == -1) {
-            perror("[LOG] write to ALL.log");
-        } else if (written != len) {
-            fprintf(stderr, "[LOG] Partial write to ALL.log: %zd/%d bytes\n", 
-                    written, len);
-        }
+    if (!g_binary) {
+        slot->len = (uint32_t)format_line(slot->line, sizeof(slot->line), lvl, fmt, ap);
+        va_end(ap);
+        ring_publish(slot, pos, lvl);
+        return;
+    }
+
+    log_fmt_entry_t *def = NULL;
+    slot->len = (uint32_t)encode_call(slot->line, sizeof(slot->line), lvl, fmt, ap, &def);
+    va_end(ap);
+    ring_publish(slot, pos, lvl);
+
+    /* first use of this format in the process: its definition goes in too
+     * (the decoder does not need it before the first record using it) */
+    if (def && !__atomic_load_n(&def->defined, __ATOMIC_RELAXED)) {
+        log_slot_t *ds = ring_claim(&pos);
+        if (!ds) return;        // retried on next use
+        ds->len = (uint32_t)encode_fmt_def(ds->line, sizeof(ds->line), def);
+        __atomic_store_n(&def->defined, 1, __ATOMIC_RELAXED);
+        ring_publish(ds, pos, LOG_LVL_DEBUG);
     }
 }
@@ -0,0 +1,60 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "log.h"
+
+/* Measures the caller-side cost of LOGD: average and p99 latency per call
+ * over bursts shaped like a unit tick (a few dozen lines back to back), and
+ * lines dropped by the ring. Run dir is a fresh directory under /tmp. */
+
+#define BURST 40
+#define BURSTS 2000
+
+static double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+static int cmp_double(const void *a, const void *b) {
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+int main(void) {
+    char dir[] = "/tmp/skirmish_bench_logXXXXXX";
+    if (!mkdtemp(dir)) return 2;
+    setenv("SKIRMISH_RUN_DIR", dir, 1);
+    if (log_init("BS", 1) != 0) return 2;
+
+    static double lat[BURST * BURSTS];
+    int n = 0;
+    double t_all = now_ns();
+    for (int b = 0; b < BURSTS; b++) {
+        for (int i = 0; i < BURST; i++) {
+            double t0 = now_ns();
+            LOGD("[BS %u] tick=%u pos=(%d,%d) target=(%d,%d) dt2=%d  hp=%d, sp=%d, fa=%d",
+                 1, b, i, i + 1, 10, 20, i * i, 100 - i, 3, 1);
+            lat[n++] = now_ns() - t0;
+        }
+        usleep(1000);   // tick gap: the writer catches up here
+    }
+    t_all = now_ns() - t_all;
+
+    qsort(lat, (size_t)n, sizeof(lat[0]), cmp_double);
+    double sum = 0;
+    for (int i = 0; i < n; i++) sum += lat[i];
+    printf("%d lines: avg %.0f ns/call, p50 %.0f ns, p99 %.0f ns, max %.0f ns, dropped %llu, wall %.1f ms\n",
+           n, sum / n, lat[n / 2], lat[n * 99 / 100], lat[n - 1],
+           (unsigned long long)log_dropped(), t_all / 1e6);
+
+    log_close();
+    char cmd[128];
+    snprintf(cmd, sizeof(cmd), "rm -rf %s", dir);
+    if (system(cmd) != 0) return 2;
+    return 0;
+}
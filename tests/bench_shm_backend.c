@@ -0,0 +1,135 @@
+#define _GNU_SOURCE
+#include <errno.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/resource.h>
+#include <sys/shm.h>
+#include <sys/syscall.h>
+
+#include "ipc/shm_backend.h"
+
+/* Page faults and TLB misses of the world segment backends on a large map:
+ * SysV shmget (4 KiB pages, and SHM_HUGETLB), and the POSIX segment of
+ * ipc/shm_backend.h without and with huge pages. For each one: first touch
+ * of every page (minor faults, time), then random 8-byte reads over the
+ * whole map (dTLB load misses via perf_event_open, ns per read). Variants
+ * the system cannot provide are skipped; counters the kernel does not
+ * expose (perf_event_paranoid, no PMU in a VM) print as "-".
+ *
+ * usage: bench_shm_backend [MiB, default 512]
+ * gcc -O2 -std=c11 -Iinclude -o /tmp/bench_shm_backend tests/bench_shm_backend.c \
+ *     src/ipc/shm_backend.c */
+
+#define READS (16u << 20)
+
+static volatile uint64_t g_sink;
+
+static double now_s(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+static long minflt(void) {
+    struct rusage ru;
+    getrusage(RUSAGE_SELF, &ru);
+    return ru.ru_minflt;
+}
+
+static int dtlb_open(void) {
+    struct perf_event_attr a;
+    memset(&a, 0, sizeof(a));
+    a.size = sizeof(a);
+    a.type = PERF_TYPE_HW_CACHE;
+    a.config = PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+               (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+    a.disabled = 1;
+    a.exclude_kernel = 1;
+    a.exclude_hv = 1;
+    return (int)syscall(SYS_perf_event_open, &a, 0, -1, -1, 0);
+}
+
+static void run(const char *name, const char *pages, volatile uint8_t *p, size_t len, int dtlb) {
+    long pg = sysconf(_SC_PAGESIZE);
+    long f0 = minflt();
+    double t0 = now_s();
+    for (size_t off = 0; off < len; off += (size_t)pg) p[off] = 1;
+    double touch_ms = (now_s() - t0) * 1e3;
+    long faults = minflt() - f0;
+
+    uint64_t x = 88172645463325252ull, sum = 0, misses = 0;
+    if (dtlb != -1) {
+        ioctl(dtlb, PERF_EVENT_IOC_RESET, 0);
+        ioctl(dtlb, PERF_EVENT_IOC_ENABLE, 0);
+    }
+    t0 = now_s();
+    for (uint32_t i = 0; i < READS; i++) {
+        x ^= x << 13;
+        x ^= x >> 7;
+        x ^= x << 17;
+        sum += p[(x % (len / 8)) * 8];
+    }
+    double read_ns = (now_s() - t0) * 1e9 / READS;
+    int have_misses = 0;
+    if (dtlb != -1) {
+        ioctl(dtlb, PERF_EVENT_IOC_DISABLE, 0);
+        have_misses = read(dtlb, &misses, sizeof(misses)) == sizeof(misses);
+    }
+
+    char miss_s[32] = "-";
+    if (have_misses) snprintf(miss_s, sizeof(miss_s), "%.3f", (double)misses / READS);
+    g_sink = sum;
+    printf("%-12s %-8s %8zu MiB %10ld %10.1f %12s %8.1f\n", name, pages, len >> 20, faults, touch_ms,
+           miss_s, read_ns);
+}
+
+int main(int argc, char **argv) {
+    size_t mib = argc > 1 ? strtoul(argv[1], NULL, 0) : 512;
+    size_t len = mib << 20;
+    key_t key = (key_t)(0x5b000000 | (getpid() & 0xffffff));
+    int dtlb = dtlb_open();
+    if (dtlb == -1) fprintf(stderr, "dTLB counter unavailable: %s\n", strerror(errno));
+
+    printf("%-12s %-8s %12s %10s %10s %12s %8s\n", "backend", "pages", "size", "faults", "touch ms",
+           "dTLB miss/rd", "ns/rd");
+
+    /* SysV, base pages and SHM_HUGETLB */
+    int shm_flags[2] = { 0, SHM_HUGETLB };
+    const char *shm_pages[2] = { "4k", "hugetlb" };
+    for (int k = 0; k < 2; k++) {
+        int id = shmget(IPC_PRIVATE, len, IPC_CREAT | 0600 | shm_flags[k]);
+        if (id == -1) {
+            printf("%-12s %-8s skipped (%s)\n", "sysv", shm_pages[k], strerror(errno));
+            continue;
+        }
+        void *p = shmat(id, NULL, 0);
+        shmctl(id, IPC_RMID, NULL);
+        if (p == (void *)-1) {
+            printf("%-12s %-8s skipped (%s)\n", "sysv", shm_pages[k], strerror(errno));
+            continue;
+        }
+        run("sysv", shm_pages[k], p, len, dtlb);
+        shmdt(p);
+    }
+
+    /* POSIX segment, as ipc_create makes it */
+    for (int huge = 0; huge <= 1; huge++) {
+        shm_posix_t seg;
+        if (shm_posix_create(&seg, key, len, huge) == -1) {
+            printf("%-12s %-8s skipped (%s)\n", huge ? "posix huge" : "posix", "", strerror(errno));
+            continue;
+        }
+        run(huge ? "posix huge" : "posix", shm_pages_name(seg.pages), seg.addr, seg.len, dtlb);
+        shm_posix_close(&seg);
+        shm_posix_unlink(key);
+    }
+
+    if (dtlb != -1) close(dtlb);
+    return 0;
+}
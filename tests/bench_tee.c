@@ -0,0 +1,193 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+
+#include "ipc/shared.h"
+#include "tee/terminal_tee.h"
+
+/* Throughput of the terminal tee (tee_pump) under print_grid output: a
+ * writer process pushes full colored grid frames into the tee pipe, one write per
+ * line or in 64 KB batches, the tee copies them to a log file and to a FIFO drained by a reader
+ * process (the UI) or to /dev/null (the terminal). Reports MB/s for the
+ * splice path, the readv/writev path, and the old 4 KB read/write loop. */
+
+#define TOTAL_MB 256
+#define UNITS 48
+#define OBSTACLES 200
+
+static char g_frame[1 << 16];
+static size_t g_frame_len;
+
+static double now_s(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+/* one full grid frame as CC prints it (grid_render_key, --grid-keyframe 1) */
+static void build_frame(void) {
+    static int16_t grid[M][N];
+    unsigned seed = 7;
+    for (int k = 0; k < OBSTACLES; k++) grid[rand_r(&seed) % M][rand_r(&seed) % N] = OBSTACLE_MARKER;
+    for (int u = 1; u <= UNITS; u++) grid[rand_r(&seed) % M][rand_r(&seed) % N] = (int16_t)u;
+
+    char *p = g_frame;
+    p += sprintf(p, "\n\t");
+    for (int i = 0; i < M; i++) p += sprintf(p, "%d", i % 10);
+    p += sprintf(p, "\n");
+    for (int i = 0; i < N; i++) {
+        p += sprintf(p, "%d\t", i);
+        for (int j = 0; j < M; j++) {
+            int16_t t = grid[j][i];
+            if (t == OBSTACLE_MARKER) p += sprintf(p, "\x1b[90m#\x1b[0m");
+            else if (t > 0) p += sprintf(p, "%s%d\x1b[0m", (t & 1) ? "\x1b[34m" : "\x1b[31m", t);
+            else *p++ = '.';
+        }
+        *p++ = '\n';
+    }
+    g_frame_len = (size_t)(p - g_frame);
+}
+
+/* writer: batch == 0 -> one write per line (line-buffered stdout,
+ * --console-direct); else batch-sized writes (the console forwarder) */
+static void writer(int fd, size_t total, size_t batch) {
+    static char buf[1 << 16];
+    size_t sent = 0, blen = 0;
+    while (sent < total) {
+        const char *line = g_frame;
+        const char *end = g_frame + g_frame_len;
+        while (line < end) {
+            const char *nl = memchr(line, '\n', (size_t)(end - line));
+            size_t len = (size_t)(nl - line) + 1;
+            if (!batch) {
+                if (write(fd, line, len) != (ssize_t)len) _exit(1);
+            } else {
+                if (blen + len > batch) {
+                    if (write(fd, buf, blen) != (ssize_t)blen) _exit(1);
+                    blen = 0;
+                }
+                memcpy(buf + blen, line, len);
+                blen += len;
+            }
+            line += len;
+        }
+        sent += g_frame_len;
+    }
+    if (blen && write(fd, buf, blen) != (ssize_t)blen) _exit(1);
+    _exit(0);
+}
+
+/* the loop tee_worker ran before tee_pump: 4 KB read, one write per output */
+static uint64_t old_pump(int in_fd, int log_fd, int out_fd) {
+    char buf[4096];
+    uint64_t total = 0;
+    ssize_t n;
+    while ((n = read(in_fd, buf, sizeof(buf))) > 0) {
+        for (ssize_t w = 0, r; w < n; w += r)
+            if ((r = write(log_fd, buf + w, (size_t)(n - w))) <= 0) break;
+        for (ssize_t w = 0, r; w < n; w += r)
+            if ((r = write(out_fd, buf + w, (size_t)(n - w))) <= 0) break;
+        total += (uint64_t)n;
+    }
+    return total;
+}
+
+enum { RUN_SPLICE, RUN_RW, RUN_OLD };
+
+static int run(const char *name, const char *dir, size_t batch, int to_fifo, int how) {
+    char log_path[256], fifo_path[256];
+    snprintf(log_path, sizeof(log_path), "%s/ALL.term.log", dir);
+    snprintf(fifo_path, sizeof(fifo_path), "%s/std.fifo", dir);
+    size_t total = (size_t)TOTAL_MB << 20;
+
+    int log_fd = open(log_path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    int pfd[2];
+    if (log_fd == -1 || pipe(pfd) == -1) return -1;
+
+    /* the screen: a FIFO with a reader process, or /dev/null */
+    pid_t reader = -1;
+    int term_fd = -1, old_out = -1;
+    if (to_fifo) {
+        unlink(fifo_path);
+        if (mkfifo(fifo_path, 0600) == -1) return -1;
+        int rfd = open(fifo_path, O_RDONLY | O_NONBLOCK);   // reader exists before the tee connects
+        reader = fork();
+        if (reader == 0) {
+            close(pfd[0]);
+            close(pfd[1]);
+            fcntl(rfd, F_SETFL, fcntl(rfd, F_GETFL) & ~O_NONBLOCK);
+            static char buf[1 << 16];
+            for (;;) {
+                ssize_t r = read(rfd, buf, sizeof(buf));
+                if (r == 0) break;
+                if (r < 0) usleep(100);     // EAGAIN only races with the first open
+            }
+            _exit(0);
+        }
+        close(rfd);
+        if (how == RUN_OLD) old_out = open(fifo_path, O_WRONLY);
+    } else {
+        term_fd = open("/dev/null", O_WRONLY);
+        old_out = term_fd;
+    }
+
+    pid_t w = fork();
+    if (w == 0) {
+        close(pfd[0]);
+        writer(pfd[1], total, batch);
+    }
+    close(pfd[1]);
+
+    double t0 = now_s();
+    uint64_t moved;
+    if (how == RUN_OLD) moved = old_pump(pfd[0], log_fd, old_out);
+    else moved = tee_pump(pfd[0], log_fd, term_fd, to_fifo ? fifo_path : NULL,
+                          how == RUN_RW ? TEE_RW_ONLY : 0);
+    double dt = now_s() - t0;
+
+    if (how == RUN_OLD && old_out != -1 && old_out != term_fd) close(old_out);
+    close(pfd[0]);
+    waitpid(w, NULL, 0);
+    if (reader > 0) waitpid(reader, NULL, 0);
+
+    struct stat st;
+    fstat(log_fd, &st);
+    close(log_fd);
+    if (term_fd != -1) close(term_fd);
+    unlink(log_path);
+    unlink(fifo_path);
+
+    double mb = (double)moved / (1 << 20);
+    int ok = moved >= total && (uint64_t)st.st_size == moved;
+    printf("%-38s %8.1f MB in %6.3f s  %8.1f MB/s  log %s\n", name, mb, dt, mb / dt, ok ? "ok" : "SHORT");
+    return ok ? 0 : 1;
+}
+
+int main(void) {
+    char dir[] = "/tmp/skirmish_bench_teeXXXXXX";
+    if (!mkdtemp(dir)) return 2;
+    signal(SIGPIPE, SIG_IGN);
+    build_frame();
+    printf("print_grid frame: %zu bytes, %d lines, %d MB per run\n\n", g_frame_len, N + 2, TOTAL_MB);
+
+    int fail = 0;
+    for (int b = 0; b < 2; b++) {
+        size_t batch = b ? (size_t)1 << 16 : 0;
+        printf(b ? "writer: 64 KB batches (console forwarder)\n" : "writer: one write per line (--console-direct)\n");
+        fail |= run("  UI FIFO, tee+splice", dir, batch, 1, RUN_SPLICE);
+        fail |= run("  UI FIFO, readv/writev", dir, batch, 1, RUN_RW);
+        fail |= run("  UI FIFO, 4 KB read/write (old)", dir, batch, 1, RUN_OLD);
+        fail |= run("  terminal (/dev/null), readv/writev", dir, batch, 0, RUN_RW);
+        fail |= run("  terminal (/dev/null), 4 KB (old)", dir, batch, 0, RUN_OLD);
+        printf("\n");
+    }
+    rmdir(dir);
+    return fail;
+}
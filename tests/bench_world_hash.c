@@ -0,0 +1,84 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "CC/world_hash.h"
+
+/* Checks that the incremental world hash equals the full recompute after
+ * random moves, and compares their cost per tick.
+ *
+ * gcc -O2 -std=c11 -Iinclude -o /tmp/bench_world_hash tests/bench_world_hash.c \
+ *     src/CC/world_hash.c */
+
+#define TICKS 20000
+#define MOVES_PER_TICK 16
+
+static double now_s(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+static void random_move(shm_state_t *S, unsigned *seed) {
+    int id = 1 + rand_r(seed) % MAX_UNITS;
+    unit_entity_t *u = &S->units[id];
+    if (u->position.x >= 0) {
+        S->grid[u->position.x][u->position.y] = 0;
+        S->grid_dirty[u->position.x] = 1;
+    }
+    u->position.x = (int16_t)(rand_r(seed) % M);
+    u->position.y = (int16_t)(rand_r(seed) % N);
+    u->hp -= rand_r(seed) % 3;
+    S->grid[u->position.x][u->position.y] = (unit_id_t)id;
+    S->grid_dirty[u->position.x] = 1;
+}
+
+int main(void) {
+    shm_state_t *S = calloc(1, sizeof(*S));
+    static world_hash_t wh;
+    if (!S) return 2;
+
+    unsigned seed = 1;
+    for (int id = 1; id <= MAX_UNITS; id++) {
+        S->units[id].alive = 1;
+        S->units[id].type = (uint8_t)(1 + id % 6);
+        S->units[id].hp = 1000;
+        S->units[id].position = (point_t){ -1, -1 };
+    }
+    world_hash_init(&wh, S);
+
+    int failures = 0;
+    double t_inc = 0, t_full = 0;
+    for (int t = 0; t < TICKS; t++) {
+        S->ticks++;
+        for (int k = 0; k < MOVES_PER_TICK; k++) random_move(S, &seed);
+
+        double t0 = now_s();
+        uint64_t hi = world_hash_update(&wh, S);
+        double t1 = now_s();
+        uint64_t hf = world_hash_full(S);
+        double t2 = now_s();
+        t_inc += t1 - t0;
+        t_full += t2 - t1;
+
+        if (hi != hf) {
+            printf("FAIL tick %d: incremental %016llx != full %016llx\n", t,
+                   (unsigned long long)hi, (unsigned long long)hf);
+            failures++;
+            break;
+        }
+    }
+
+    printf("grid %dx%d, %d moves/tick\n", M, N, MOVES_PER_TICK);
+    printf("incremental: %.2f us/tick\n", t_inc / TICKS * 1e6);
+    printf("full:        %.2f us/tick\n", t_full / TICKS * 1e6);
+
+    free(S);
+    if (failures == 0) {
+        printf("All world hash tests passed.\n");
+        return 0;
+    }
+    return 2;
+}
@@ -0,0 +1,78 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include "unit_logic.h"
+#include "weapon_stats.h"
+#include "unit_stats.h"
+#include "ipc/shared.h"
+
+static int float_eq(float a, float b) {
+    return fabsf(a - b) < 1e-6f;
+}
+
+int main(void) {
+    int failures = 0;
+
+    /* batch lookups must match scalar lookups, including unknown target types */
+    unit_entity_t units[MAX_UNITS + 1] = {0};
+    unit_id_t ids[UNIT_TYPE_COUNT + 2];
+    int count = 0;
+    for (int t = 0; t < UNIT_TYPE_COUNT + 2; t++) {
+        units[t + 1].type = (uint8_t)t;     // last two are out of range
+        ids[count++] = (unit_id_t)(t + 1);
+    }
+
+    uint8_t t_types[UNIT_TYPE_COUNT + 2];
+    float out[UNIT_TYPE_COUNT + 2];
+    unit_gather_types(units, ids, count, t_types);
+
+    for (int u = 0; u < UNIT_TYPE_COUNT; u++) {
+        damage_multiplier_batch((unit_type_t)u, t_types, count, out);
+        for (int i = 0; i < count; i++) {
+            float exp = damage_multiplier((unit_type_t)u, (unit_type_t)units[ids[i]].type);
+            if (!float_eq(out[i], exp)) {
+                printf("FAIL dmg unit=%d target=%d got=%.2f exp=%.2f\n", u, units[ids[i]].type, out[i], exp);
+                failures++;
+            }
+        }
+    }
+
+    for (int w = 0; w < WEAPON_TYPE_COUNT; w++) {
+        accuracy_multiplier_batch((weapon_type_t)w, t_types, count, out);
+        for (int i = 0; i < count; i++) {
+            float exp = accuracy_multiplier((weapon_type_t)w, (unit_type_t)units[ids[i]].type);
+            if (!float_eq(out[i], exp)) {
+                printf("FAIL acc weapon=%d target=%d got=%.2f exp=%.2f\n", w, units[ids[i]].type, out[i], exp);
+                failures++;
+            }
+        }
+    }
+
+    /* spot checks against the original switch semantics */
+    if (!float_eq(damage_multiplier(TYPE_BOMBER, TYPE_CARRIER), 3.0f)) { printf("FAIL bomber->carrier\n"); failures++; }
+    if (!float_eq(damage_multiplier(TYPE_FIGHTER, TYPE_ELITE), 1.0f)) { printf("FAIL fighter->elite\n"); failures++; }
+    if (!float_eq(accuracy_multiplier(LR_CANNON, TYPE_FIGHTER), 0.25f)) { printf("FAIL lr_cannon->fighter\n"); failures++; }
+    if (!float_eq(accuracy_multiplier(SR_GUN, TYPE_DESTROYER), 0.0f)) { printf("FAIL sr_gun->destroyer\n"); failures++; }
+
+    /* precomputed approach table must match direct computation */
+    for (int u = 1; u < UNIT_TYPE_COUNT; u++) {
+        unit_stats_t st = unit_stats_for_type((unit_type_t)u);
+        int16_t table[UNIT_TYPE_COUNT];
+        unit_build_aproach_table(st.ba, table);
+        for (int t = 0; t < UNIT_TYPE_COUNT; t++) {
+            int16_t exp = unit_calculate_aproach(st.ba, (unit_type_t)t);
+            if (table[t] != exp) {
+                printf("FAIL aproach unit=%d target=%d got=%d exp=%d\n", u, t, table[t], exp);
+                failures++;
+            }
+        }
+    }
+
+    if (failures == 0) {
+        printf("All combat table tests passed.\n");
+        return 0;
+    }
+    printf("%d combat table test(s) failed.\n", failures);
+    return 2;
+}
@@ -0,0 +1,96 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+#include "ipc/shared.h"
+#include "ipc/console_ring.h"
+
+/* Writes numbered lines through the console ring while nobody reads the
+ * forwarder's pipe, so the pipe fills and the ring has to drop the oldest
+ * lines. Checks that printing never blocked, that the lines that arrive are
+ * whole and in order, and that received + dropped == written.
+ *
+ * gcc -O2 -std=c11 -Iinclude -o /tmp/test_console_ring tests/test_console_ring.c \
+ *     src/ipc/console_ring.c src/ipc/metrics.c src/utils.c -lpthread */
+
+#define LINES 20000
+
+static double now_s(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+int main(void) {
+    shm_state_t *S = mmap(NULL, sizeof(*S), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (S == MAP_FAILED) { perror("mmap"); return 1; }
+    memset(S, 0, sizeof(*S));
+
+    int p[2];
+    if (pipe(p) == -1) { perror("pipe"); return 1; }
+    if (console_forwarder_start(S, p[1]) == -1) { perror("forwarder"); return 1; }
+    close(p[1]);
+    if (console_ring_redirect(S) == -1) { fprintf(stderr, "redirect failed\n"); return 1; }
+
+    /* nobody reads p[0] yet: the forwarder blocks in write, the ring laps */
+    double t0 = now_s();
+    for (int i = 0; i < LINES; i++) printf("line %06d of the console ring test\n", i);
+    fflush(stdout);
+    double dt = now_s() - t0;
+    console_ring_restore();
+
+    /* now drain the pipe until the forwarder is done */
+    __atomic_store_n(&S->console.closing, 1, __ATOMIC_RELEASE);
+    fcntl(p[0], F_SETFL, O_NONBLOCK);
+    static char buf[1 << 22];
+    size_t len = 0;
+    for (;;) {
+        ssize_t r = read(p[0], buf + len, sizeof(buf) - 1 - len);
+        if (r > 0) { len += (size_t)r; continue; }
+        if (r == 0) break;
+        if (errno != EAGAIN) { perror("read"); return 1; }
+        if (__atomic_load_n(&S->console.done, __ATOMIC_ACQUIRE)) {
+            r = read(p[0], buf + len, sizeof(buf) - 1 - len);
+            if (r > 0) { len += (size_t)r; continue; }
+            break;
+        }
+        usleep(1000);
+    }
+    buf[len] = '\0';
+
+    int fail = 0, received = 0, prev = -1;
+    for (char *line = strtok(buf, "\n"); line; line = strtok(NULL, "\n")) {
+        int n;
+        char tail[64];
+        if (sscanf(line, "line %d of the %63[a-z ]", &n, tail) != 2 || strcmp(tail, "console ring test") != 0) {
+            fprintf(stderr, "FAIL: torn line '%s'\n", line);
+            fail = 1;
+            break;
+        }
+        if (n <= prev) {
+            fprintf(stderr, "FAIL: line %d after %d\n", n, prev);
+            fail = 1;
+            break;
+        }
+        prev = n;
+        received++;
+    }
+    unsigned long long dropped = S->console.dropped;
+    printf("wrote %d lines in %.1f ms, received %d, dropped %llu\n", LINES, dt * 1e3, received, dropped);
+    if ((unsigned long long)received + dropped != LINES) {
+        fprintf(stderr, "FAIL: received + dropped != %d\n", LINES);
+        fail = 1;
+    }
+    if (dropped == 0) {
+        fprintf(stderr, "FAIL: expected drops with a stalled reader\n");
+        fail = 1;
+    }
+    printf(fail ? "FAIL\n" : "OK\n");
+    return fail;
+}
@@ -0,0 +1,164 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "CC/grid_render.h"
+
+/* Plays a keyframe and then only deltas into a small terminal emulator while
+ * units move, spawn and die (including 2-digit ids, which shift the rest of
+ * their row), and checks after every frame that the screen equals a fresh
+ * keyframe of the same grid. Also reports the bytes per frame.
+ * The emulator knows what the renderer emits: CUP, ED, EL, ICH, DCH,
+ * DECSTBM (cursor home only), DECSC/DECRC and SGR. */
+
+#define FRAMES 2000
+#define VT_ROWS (GRID_ROW0 + N + 2)
+#define VT_COLS 320
+
+typedef struct {
+    char ch[VT_ROWS + 1][VT_COLS + 1];
+    int attr[VT_ROWS + 1][VT_COLS + 1];
+    int row, col, cur_attr, saved_row, saved_col;
+} vt_t;
+
+static void vt_clear(vt_t *v) {
+    memset(v->ch, ' ', sizeof(v->ch));
+    memset(v->attr, 0, sizeof(v->attr));
+}
+
+static void vt_init(vt_t *v) {
+    vt_clear(v);
+    v->row = v->col = 1;
+    v->cur_attr = 0;
+    v->saved_row = v->saved_col = 1;
+}
+
+/* the subset of VT100 the renderer uses */
+static void vt_feed(vt_t *v, const char *s, size_t len) {
+    for (size_t i = 0; i < len; i++) {
+        char c = s[i];
+        if (c == '\x1b') {
+            char k = s[++i];
+            if (k == '7') { v->saved_row = v->row; v->saved_col = v->col; continue; }
+            if (k == '8') { v->row = v->saved_row; v->col = v->saved_col; continue; }
+            /* CSI: params then final byte */
+            int p[2] = { 0, 0 }, np = 0, have = 0;
+            for (i++; i < len && ((s[i] >= '0' && s[i] <= '9') || s[i] == ';'); i++) {
+                if (s[i] == ';') { np++; continue; }
+                if (np < 2) p[np] = p[np] * 10 + (s[i] - '0');
+                have = 1;
+            }
+            switch (s[i]) {
+            case 'H': v->row = p[0] ? p[0] : 1; v->col = p[1] ? p[1] : 1; break;
+            case 'J': vt_clear(v); break;
+            case 'K': for (int x = v->col; x <= VT_COLS; x++) { v->ch[v->row][x] = ' '; v->attr[v->row][x] = 0; } break;
+            case '@': {
+                int n = p[0] ? p[0] : 1;
+                memmove(&v->ch[v->row][v->col + n], &v->ch[v->row][v->col], (size_t)(VT_COLS + 1 - v->col - n));
+                memmove(&v->attr[v->row][v->col + n], &v->attr[v->row][v->col], sizeof(int) * (size_t)(VT_COLS + 1 - v->col - n));
+                for (int x = v->col; x < v->col + n; x++) { v->ch[v->row][x] = ' '; v->attr[v->row][x] = 0; }
+                break;
+            }
+            case 'P': {
+                int n = p[0] ? p[0] : 1;
+                memmove(&v->ch[v->row][v->col], &v->ch[v->row][v->col + n], (size_t)(VT_COLS + 1 - v->col - n));
+                memmove(&v->attr[v->row][v->col], &v->attr[v->row][v->col + n], sizeof(int) * (size_t)(VT_COLS + 1 - v->col - n));
+                for (int x = VT_COLS + 1 - n; x <= VT_COLS; x++) { v->ch[v->row][x] = ' '; v->attr[v->row][x] = 0; }
+                break;
+            }
+            case 'r': v->row = v->col = 1; break;
+            case 'm': v->cur_attr = have ? p[0] : 0; break;
+            }
+            continue;
+        }
+        if (c == '\n') { v->row++; v->col = 1; continue; }
+        if (c == '\t') { v->col = ((v->col - 1) / 8 + 1) * 8 + 1; continue; }
+        if (v->row <= VT_ROWS && v->col <= VT_COLS) {
+            v->ch[v->row][v->col] = c;
+            v->attr[v->row][v->col] = v->cur_attr;
+        }
+        v->col++;
+    }
+}
+
+static void put_unit(shm_state_t *S, int id, int x, int y, unsigned *seed) {
+    S->grid[x][y] = (unit_id_t)id;
+    S->units[id].faction = (uint8_t)(1 + rand_r(seed) % 2);
+    S->units[id].position.x = (int16_t)x;
+    S->units[id].position.y = (int16_t)y;
+    S->units[id].alive = 1;
+}
+
+static void step(shm_state_t *S, unsigned *seed) {
+    for (int id = 1; id < MAX_UNITS; id++) {
+        if (!S->units[id].alive) {
+            if (rand_r(seed) % 50 == 0) {
+                int x = rand_r(seed) % M, y = rand_r(seed) % N;
+                if (S->grid[x][y] == 0) put_unit(S, id, x, y, seed);
+            }
+            continue;
+        }
+        int x = S->units[id].position.x, y = S->units[id].position.y;
+        if (rand_r(seed) % 200 == 0) {          // dies
+            S->grid[x][y] = 0;
+            S->units[id].alive = 0;
+            continue;
+        }
+        int nx = x + rand_r(seed) % 3 - 1, ny = y + rand_r(seed) % 3 - 1;
+        if (nx < 0 || nx >= M || ny < 0 || ny >= N || S->grid[nx][ny] != 0) continue;
+        S->grid[x][y] = 0;
+        S->grid[nx][ny] = (unit_id_t)id;
+        S->units[id].position.x = (int16_t)nx;
+        S->units[id].position.y = (int16_t)ny;
+    }
+}
+
+int main(void) {
+    static shm_state_t S;
+    static grid_snap_t prev, cur;
+    static vt_t live, ref;
+    static char buf[GRID_FRAME_MAX];
+    unsigned seed = 42;
+
+    for (int k = 0; k < 150; k++) S.grid[rand_r(&seed) % M][rand_r(&seed) % N] = OBSTACLE_MARKER;
+    for (int id = 1; id < 40; id++) {
+        int x = rand_r(&seed) % M, y = rand_r(&seed) % N;
+        if (S.grid[x][y] == 0) put_unit(&S, id, x, y, &seed);
+    }
+
+    vt_init(&live);
+    grid_snap_take(&prev, &S);
+    size_t key_len = grid_render_key(&prev, 1, buf, sizeof(buf));
+    vt_feed(&live, buf, key_len);
+
+    size_t delta_bytes = 0;
+    for (int f = 1; f <= FRAMES; f++) {
+        step(&S, &seed);
+        grid_snap_take(&cur, &S);
+        size_t len = grid_render_delta(&prev, &cur, buf, sizeof(buf));
+        delta_bytes += len;
+        vt_feed(&live, buf, len);
+
+        vt_init(&ref);
+        vt_feed(&ref, buf, grid_render_key(&cur, 1, buf, sizeof(buf)));
+        for (int r = 1; r < GRID_ROW0 + N; r++) {
+            if (memcmp(live.ch[r], ref.ch[r], sizeof(live.ch[r])) != 0 ||
+                memcmp(live.attr[r], ref.attr[r], sizeof(live.attr[r])) != 0) {
+                fprintf(stderr, "FAIL: frame %d, screen row %d differs\n  live: %.140s\n  key:  %.140s\n",
+                        f, r, live.ch[r] + 1, ref.ch[r] + 1);
+                return 1;
+            }
+        }
+        if (live.row != ref.row || live.col != ref.col) {
+            fprintf(stderr, "FAIL: frame %d, cursor not restored\n", f);
+            return 1;
+        }
+        prev = cur;
+    }
+
+    printf("keyframe %zu bytes, delta %.0f bytes/frame on average (%d frames)\n",
+           key_len, (double)delta_bytes / FRAMES, FRAMES);
+    printf("OK\n");
+    return 0;
+}
@@ -0,0 +1,104 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+#include "log.h"
+#include "log_bin.h"
+
+/* Logs the same calls in text mode (child 1) and binary mode (child 2),
+ * expands the binary log with ./skirmish-logcat and checks both give the
+ * same messages. Run from the repo root after `make`. */
+
+static void log_calls(void) {
+    long big = 1L << 40;
+    LOGD("[BS %u] tick=%u pos=(%d,%d) order=%d", 3u, 17u, -4, 12, 2);
+    LOGI("hash %016llx cols=%u", 0x1234abcdULL, 7u);
+    LOGW("ratio %.3f%% of %s, big=%ld, ch=%c", 12.5, "tick work", big, 'x');
+    LOGE("width %*d|%-6s|%5.1f|", 6, 42, "ab", 3.14159);
+    LOGI("null %s ptr-free %x %X %o", (char *)NULL, 255u, 255u, 8u);
+    LOGI("%s", "text only");
+    LOGD("size_t %zu ssize_t %zd", (size_t)123456789, (ssize_t)-5);
+}
+
+static int run_child(const char *dir, int binary) {
+    pid_t pid = fork();
+    if (pid == 0) {
+        setenv("SKIRMISH_RUN_DIR", dir, 1);
+        if (binary) setenv("SKIRMISH_LOG_FORMAT", "binary", 1);
+        else unsetenv("SKIRMISH_LOG_FORMAT");
+        if (log_init("BS", 3) != 0) _exit(2);
+        log_calls();
+        log_close();
+        _exit(0);
+    }
+    int st;
+    waitpid(pid, &st, 0);
+    return WIFEXITED(st) && WEXITSTATUS(st) == 0 ? 0 : -1;
+}
+
+/* message part of each line (after "pid=N: "), skipping logger start/close lines */
+static int read_messages(const char *cmd, char msgs[][512], int max) {
+    FILE *p = popen(cmd, "r");
+    if (!p) return -1;
+    char line[1024];
+    int n = 0;
+    while (fgets(line, sizeof(line), p) && n < max) {
+        char *m = strstr(line, ": ");
+        if (!m || strstr(line, "logger started") || strstr(line, "logger closing")) continue;
+        snprintf(msgs[n++], 512, "%s", m + 2);
+    }
+    pclose(p);
+    return n;
+}
+
+int main(void) {
+    int failures = 0;
+    uint8_t types[LOG_BIN_MAX_ARGS];
+    if (log_bin_parse_format("a %d %*.*f %lld %s %p %%", types, LOG_BIN_MAX_ARGS) != 7 ||
+        types[0] != LOG_ARG_I32 || types[1] != LOG_ARG_I32 || types[2] != LOG_ARG_I32 ||
+        types[3] != LOG_ARG_F64 || types[4] != LOG_ARG_I64 || types[5] != LOG_ARG_STR ||
+        types[6] != LOG_ARG_PTR) {
+        printf("FAIL: format parse\n");
+        failures++;
+    }
+    if (log_bin_parse_format("%n", types, LOG_BIN_MAX_ARGS) != -1) {
+        printf("FAIL: %%n must not be encodable\n");
+        failures++;
+    }
+
+    char text_dir[] = "/tmp/skirmish_test_logtXXXXXX";
+    char bin_dir[] = "/tmp/skirmish_test_logbXXXXXX";
+    if (!mkdtemp(text_dir) || !mkdtemp(bin_dir)) return 2;
+    if (run_child(text_dir, 0) != 0 || run_child(bin_dir, 1) != 0) {
+        printf("FAIL: logging child\n");
+        return 2;
+    }
+
+    static char text[32][512], bin[32][512];
+    char cmd[256];
+    snprintf(cmd, sizeof(cmd), "cat %s/BS_u3_pid_*.log", text_dir);
+    int nt = read_messages(cmd, text, 32);
+    snprintf(cmd, sizeof(cmd), "./skirmish-logcat %s 2>/dev/null", bin_dir);
+    int nb = read_messages(cmd, bin, 32);
+    if (nt != 7 || nb != nt) {
+        printf("FAIL: %d text lines, %d binary lines\n", nt, nb);
+        failures++;
+    }
+    for (int i = 0; i < nt && i < nb; i++) {
+        if (strcmp(text[i], bin[i]) != 0) {
+            printf("FAIL: line %d\n  text:   %s  binary: %s", i, text[i], bin[i]);
+            failures++;
+        }
+    }
+
+    snprintf(cmd, sizeof(cmd), "rm -rf %s %s", text_dir, bin_dir);
+    if (system(cmd) != 0) failures++;
+    if (failures == 0) {
+        printf("All binary log tests passed.\n");
+        return 0;
+    }
+    return 2;
+}
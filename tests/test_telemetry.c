@@ -0,0 +1,100 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <pthread.h>
+
+#include "ipc/telemetry.h"
+
+/* One writer thread per unit publishes records whose fields all equal the
+ * tick; a reader checks every copy it gets is consistent (no torn record).
+ * Also checks layout (one cache line per record) and recovery of a record
+ * left mid-write by a killed unit. */
+
+#define UNITS 4
+#define TICKS 200000
+
+static shm_state_t *S;
+static volatile int writers_done = 0;
+
+static void *writer(void *arg) {
+    unit_id_t id = (unit_id_t)(intptr_t)arg;
+    for (uint32_t t = 1; t <= TICKS; t++) {
+        unit_telemetry_t rec = {
+            .tick = t, .hp = (st_points_t)t, .hp_max = (st_points_t)t,
+            .sh = (st_points_t)t, .sh_max = (st_points_t)t,
+            .last_fired_tick = t, .target = (unit_id_t)(t & 0x7fff), .order = (uint8_t)t
+        };
+        telemetry_write(S, id, &rec);
+    }
+    return NULL;
+}
+
+static int check(const unit_telemetry_t *r) {
+    uint32_t t = r->tick;
+    return (r->hp == (st_points_t)t && r->hp_max == (st_points_t)t && r->sh == (st_points_t)t &&
+            r->sh_max == (st_points_t)t && r->last_fired_tick == t &&
+            r->target == (unit_id_t)(t & 0x7fff) && r->order == (uint8_t)t) ? 0 : -1;
+}
+
+int main(void) {
+    int failures = 0;
+    if (sizeof(unit_telemetry_t) != 64 || offsetof(shm_state_t, telemetry) % 64 != 0) {
+        printf("FAIL: telemetry record is %zu bytes at offset %zu\n",
+               sizeof(unit_telemetry_t), offsetof(shm_state_t, telemetry));
+        failures++;
+    }
+
+    if (posix_memalign((void **)&S, 64, sizeof(*S)) != 0) return 2;
+    *S = (shm_state_t){0};
+
+    pthread_t th[UNITS];
+    for (int i = 0; i < UNITS; i++)
+        pthread_create(&th[i], NULL, writer, (void *)(intptr_t)(i + 1));
+
+    long reads = 0, skipped = 0;
+    uint32_t last[UNITS + 1] = {0};
+    while (!writers_done && failures == 0) {
+        int finished = 1;
+        for (unit_id_t id = 1; id <= UNITS; id++) {
+            unit_telemetry_t r;
+            if (telemetry_read(S, id, &r) != 0) { skipped++; finished = 0; continue; }
+            reads++;
+            if (check(&r) != 0) {
+                printf("FAIL: torn record of unit %d at tick %u\n", id, r.tick);
+                failures++;
+                break;
+            }
+            if (r.tick < last[id]) {
+                printf("FAIL: unit %d tick went backwards %u -> %u\n", id, last[id], r.tick);
+                failures++;
+                break;
+            }
+            last[id] = r.tick;
+            if (r.tick != TICKS) finished = 0;
+        }
+        writers_done = finished;
+    }
+    for (int i = 0; i < UNITS; i++) pthread_join(th[i], NULL);
+
+    /* writer killed mid-write: record stays odd until CC resets the slot */
+    unit_telemetry_t r;
+    S->telemetry[1].seq |= 1u;
+    if (telemetry_read(S, 1, &r) == 0) {
+        printf("FAIL: read of a record left mid-write succeeded\n");
+        failures++;
+    }
+    telemetry_reset(S, 1);
+    if (telemetry_read(S, 1, &r) != 0 || r.tick != 0 || r.hp != 0) {
+        printf("FAIL: reset record not readable/zeroed\n");
+        failures++;
+    }
+
+    printf("%ld records read, %ld skipped\n", reads, skipped);
+    free(S);
+    if (failures == 0) {
+        printf("All telemetry tests passed.\n");
+        return 0;
+    }
+    return 2;
+}
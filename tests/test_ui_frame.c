@@ -0,0 +1,167 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+#include "ipc/ui_frame.h"
+
+/* A writer thread publishes frames whose grid cells and unit hp all equal
+ * the tick; a reader waits on the tick epoch and checks every copy it gets
+ * is consistent (no torn frame). */
+
+#define TICKS 20000
+
+static shm_state_t *S;
+static volatile int writer_done = 0;
+
+static void *writer(void *arg) {
+    (void)arg;
+    for (uint32_t t = 1; t <= TICKS; t++) {
+        S->ticks = t;
+        for (int x = 0; x < M; x++) {
+            for (int y = 0; y < N; y++)
+                S->grid[x][y] = (unit_id_t)(t & 0x7fff);
+            S->grid_dirty[x] = 1;
+        }
+        for (int id = 1; id <= MAX_UNITS; id++) S->units[id].hp = (st_points_t)t;
+        ui_frame_publish(S);
+    }
+    writer_done = 1;
+    ui_frame_publish(S);
+    return NULL;
+}
+
+static int check_frame(const ui_frame_t *f) {
+    unit_id_t v = (unit_id_t)(f->tick & 0x7fff);
+    for (int x = 0; x < M; x++)
+        for (int y = 0; y < N; y++)
+            if (f->grid[x][y] != v) return -1;
+    for (int id = 1; id <= MAX_UNITS; id++)
+        if (f->units[id].hp != (st_points_t)f->tick) return -1;
+    for (int tx = 0; tx < UI_TILES_X; tx++)
+        for (int ty = 0; ty < UI_TILES_Y; ty++)
+            if (f->tile_epoch[tx][ty] == 0 || (int32_t)(f->tile_epoch[tx][ty] - f->epoch) > 0) return -1;
+    return 0;
+}
+
+int main(void) {
+    S = calloc(1, sizeof(*S));
+    static ui_frame_t frame;
+    if (!S) return 2;
+
+    pthread_t th;
+    uint32_t seen = tick_epoch_load(S);
+    pthread_create(&th, NULL, writer, NULL);
+
+    int failures = 0, reads = 0, skipped = 0;
+    uint32_t last_tick = 0;
+    while (!writer_done) {
+        if (tick_epoch_wait(S, seen, 1000) != 1) continue;
+        seen = tick_epoch_load(S);
+        if (ui_frame_read(S, &frame) != 0) { skipped++; continue; }
+        reads++;
+        if (check_frame(&frame) != 0) {
+            printf("FAIL: torn frame at tick %u\n", frame.tick);
+            failures++;
+            break;
+        }
+        if (frame.tick < last_tick) {
+            printf("FAIL: tick went backwards %u -> %u\n", last_tick, frame.tick);
+            failures++;
+            break;
+        }
+        last_tick = frame.tick;
+    }
+    pthread_join(th, NULL);
+
+    if (ui_frame_read(S, &frame) != 0 || frame.tick != TICKS || check_frame(&frame) != 0) {
+        printf("FAIL: final frame tick %u\n", frame.tick);
+        failures++;
+    }
+
+    /* one cell changes: only its tile gets the new epoch */
+    memset(S->grid_dirty, 0, sizeof(S->grid_dirty));
+    S->grid[M - 1][N - 1] = 1;
+    S->grid_dirty[M - 1] = 1;
+    ui_frame_publish(S);
+    if (ui_frame_read(S, &frame) != 0 || frame.grid[M - 1][N - 1] != 1) {
+        printf("FAIL: single cell change not published\n");
+        failures++;
+    }
+    int stamped = 0;
+    for (int tx = 0; tx < UI_TILES_X; tx++)
+        for (int ty = 0; ty < UI_TILES_Y; ty++)
+            if (frame.tile_epoch[tx][ty] == frame.epoch) stamped++;
+    if (stamped != 1 || frame.tile_epoch[UI_TILES_X - 1][UI_TILES_Y - 1] != frame.epoch) {
+        printf("FAIL: %d tiles stamped for a single cell change\n", stamped);
+        failures++;
+    }
+
+    /* random moves: incremental mipmap counts match a full recount */
+    for (int id = 1; id <= MAX_UNITS; id++) {
+        S->units[id].faction = (uint8_t)(1 + id % 2);
+        S->units[id].type = (uint8_t)(1 + id % 6);
+    }
+    memset(S->grid, 0, sizeof(S->grid));
+    memset(S->grid_dirty, 1, sizeof(S->grid_dirty));
+    ui_frame_publish(S);
+    srand(7);
+    for (int round = 0; round < 200; round++) {
+        memset(S->grid_dirty, 0, sizeof(S->grid_dirty));
+        for (int k = 0; k < 40; k++) {
+            int x = rand() % M, y = rand() % N;
+            int r = rand() % 8;
+            S->grid[x][y] = r == 0 ? OBSTACLE_MARKER : r < 3 ? 0 : (unit_id_t)(1 + rand() % MAX_UNITS);
+            S->grid_dirty[x] = 1;
+        }
+        ui_frame_publish(S);
+    }
+    ui_frame_t *f = &S->frame;
+    for (int l = 1; l <= UI_MIP_LEVELS && failures == 0; l++) {
+        for (int tx = 0; tx < UI_MIP_W(l); tx++) {
+            for (int ty = 0; ty < UI_MIP_H(l); ty++) {
+                int want[UI_MIP_CLASSES] = {0};
+                for (int x = tx << l; x < ((tx + 1) << l) && x < M; x++) {
+                    for (int y = ty << l; y < ((ty + 1) << l) && y < N; y++) {
+                        unit_id_t id = S->grid[x][y];
+                        if (id < 0) want[UI_MIP_OBSTACLE]++;
+                        else if (id > 0) {
+                            int craft = S->units[id].type >= TYPE_FIGHTER;
+                            int rep = S->units[id].faction == FACTION_REPUBLIC;
+                            want[rep ? (craft ? UI_MIP_REP_CRAFT : UI_MIP_REP_CAPITAL)
+                                     : (craft ? UI_MIP_CIS_CRAFT : UI_MIP_CIS_CAPITAL)]++;
+                        }
+                    }
+                }
+                for (int c = 0; c < UI_MIP_CLASSES; c++) {
+                    if (f->mip[ui_mip_index(l, tx, ty)].n[c] != want[c]) {
+                        printf("FAIL: mip level %d tile (%d,%d) class %d: %u != %d\n",
+                               l, tx, ty, c, f->mip[ui_mip_index(l, tx, ty)].n[c], want[c]);
+                        failures++;
+                        tx = UI_MIP_W(l);
+                        ty = UI_MIP_H(l);
+                        break;
+                    }
+                }
+            }
+        }
+    }
+
+    /* region read copies only the requested window */
+    memset(&frame, 0xff, sizeof(frame));
+    if (ui_frame_read_region(S, &frame, 2, 3, 2, 4, 3) != 0 ||
+        memcmp(&frame.mip[ui_mip_index(2, 3, 2)], &f->mip[ui_mip_index(2, 3, 2)], 3 * sizeof(ui_mip_tile_t)) != 0 ||
+        frame.grid[0][0] != (unit_id_t)-1 || frame.tick != f->tick) {
+        printf("FAIL: region read\n");
+        failures++;
+    }
+
+    printf("%d frames read, %d skipped, %d published\n", reads, skipped, TICKS);
+    free(S);
+    if (failures == 0) {
+        printf("All UI frame tests passed.\n");
+        return 0;
+    }
+    return 2;
+}
@@ -1,4 +1,7 @@
 // test_unit_logic.c
+// gcc -O2 -std=c11 -Iinclude -Iinclude/CC -o /tmp/test_unit_logic tests/test_unit_logic.c \
+//     src/CC/unit_logic.c src/CC/unit_size.c src/CC/unit_stats.c src/CC/weapon_stats.c \
+//     src/ipc/*.c src/utils.c src/error_handler.c -lm -lpthread
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -15,7 +18,7 @@
 static void die_usage(const char *argv0) {
     fprintf(stderr,
         "Usage: %s [seed]\n"
-        "  seed: optional integer seed for rand()\n", argv0);
+        "  seed: optional integer seed for the RNG stream\n", argv0);
     exit(2);
 }
 
@@ -23,12 +26,6 @@ static int in_bounds_i(int x, int y, int w, int h) {
     return (x >= 0 && x < w && y >= 0 && y < h);
 }
 
-static int in_disk_i(int x, int y, int cx, int cy, int r) {
-    int dx = x - cx;
-    int dy = y - cy;
-    return dx*dx + dy*dy <= r*r;
-}
-
 // 4-neighbor border definition (matches build_circle_border_offsets in unit_logic.c)
 static int on_circle_border_4n_i(int x, int y, int cx, int cy, int r) {
     if (!in_disk_i(x, y, cx, cy, r)) return 0;
@@ -116,6 +113,8 @@ static void demo_circle_mask(int w, int h, int cx, int cy, int r) {
     free(buf);
 }
 
+static rng_t g_rng;
+
 // Demo 2: sample random points + show hit heatmaps
 static void demo_radar_heat(int w, int h, int cx, int cy, int r, int samples) {
     int *hits_in = (int*)calloc((size_t)w*h, sizeof(int));
@@ -125,13 +124,13 @@ static void demo_radar_heat(int w, int h, int cx, int cy, int r, int samples) {
     for (int i = 0; i < samples; i++) {
         point_t p;
 
-        if (radar_pick_random_point_in_circle((int16_t)cx, (int16_t)cy, (int16_t)r, w, h, &p)) {
+        if (radar_pick_random_point_in_circle((int16_t)cx, (int16_t)cy, (int16_t)r, w, h, &g_rng, &p)) {
             int x = p.x, y = p.y;
             if (in_bounds_i(x, y, w, h)) hits_in[y*w + x]++;
         }
 
         // Test without size validation (NULL ctx, size=1 works without ctx)
-        if (radar_pick_random_point_on_circle_border((point_t){(int16_t)cx, (int16_t)cy}, (int16_t)r, w, h, 1, 0, NULL, &p)) {
+        if (radar_pick_random_point_on_circle_border((point_t){(int16_t)cx, (int16_t)cy}, (int16_t)r, w, h, 1, 0, NULL, &g_rng, &p)) {
             int x = p.x, y = p.y;
             if (in_bounds_i(x, y, w, h)) hits_bd[y*w + x]++;
         }
@@ -171,7 +170,7 @@ static void demo_movement(int w, int h, point_t from, point_t *next_step) {
     
     // Goal chosen from DR, next step chosen from SP toward that goal
     (void)unit_compute_goal_for_tick_dr(from, target, dr, w, h, &goal);
-    (void)unit_next_step_towards_dr(from, goal, sp, dr, approach, w, h, grid, &next);
+    (void)unit_next_step_towards_dr(from, goal, sp, dr, approach, w, h, grid, 0, 1, NULL, &next);
 
 
     char *buf = (char*)malloc((size_t)w*h);
@@ -243,7 +242,7 @@ int main(int argc, char **argv) {
     if (argc == 2) seed = (unsigned)strtoul(argv[1], NULL, 10);
     else seed = (unsigned)time(NULL);
 
-    srand(seed);
+    rng_seed(&g_rng, seed, RNG_DOMAIN_UNIT, 0, 0);
     printf("seed=%u\n", seed);
 
     // tweak these freely